@@ -0,0 +1,89 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+namespace {
+	atomic<size_t> sNumAllocations(0);
+	atomic<size_t> sNumAllocatedBytes(0);
+}
+
+void * operator new(size_t size) {
+	sNumAllocations.fetch_add(1, memory_order_relaxed);
+	sNumAllocatedBytes.fetch_add(size, memory_order_relaxed);
+	if (void * ptr = malloc(size > 0 ? size : 1)) {
+		return ptr;
+	}
+	throw bad_alloc();
+}
+
+void * operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void * ptr, size_t) noexcept {
+	free(ptr);
+}
+
+namespace bluecadet {
+namespace analytics {
+namespace benchmarks {
+
+size_t getNumAllocations() {
+	return sNumAllocations.load(memory_order_relaxed);
+}
+
+size_t getNumAllocatedBytes() {
+	return sNumAllocatedBytes.load(memory_order_relaxed);
+}
+
+} // benchmarks namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,549 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+// Headless microbenchmarks for the tracking, serialization and batching hot paths.
+// Run with --csv for machine-readable output, --runs <n> to change the number of measured runs (default 7)
+// and --verbose to keep log output (e.g. hit buffer overflow warnings under contention).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(BLUECADET_ANALYTICS_STANDALONE)
+#include "cinder/Url.h"
+#endif
+
+#include "AllocationCounter.h"
+
+#include "bluecadet/analytics/AnalyticsClient.h"
+#include "bluecadet/analytics/utils/PercentEncoding.hpp"
+#include "bluecadet/analytics/utils/Log.h"
+#include "bluecadet/analytics/utils/StringDictionary.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+//==================================================
+// Helpers
+// 
+
+volatile size_t sSink = 0; // keeps results alive so loops aren't optimized away
+
+//! Percent-encoder without UTF-8 validation that hits were serialized with before utils::percentEncode.
+//! Serves as the baseline in builds without Cinder, where ci::Url::encode isn't available to compare against.
+string scalarPercentEncode(const string & value) {
+	static const char hexDigits[] = "0123456789ABCDEF";
+
+	string result;
+	result.reserve(utils::getPercentEncodedSize(value));
+
+	for (const char c : value) {
+		const unsigned char uc = (unsigned char)c;
+		if (utils::isUnreservedUrlChar(uc)) {
+			result += c;
+		} else {
+			result += '%';
+			result += hexDigits[uc >> 4];
+			result += hexDigits[uc & 0xF];
+		}
+	}
+
+	return result;
+}
+
+//! Accumulates time and allocations between start() and stop() over multiple intervals.
+class Stopwatch {
+public:
+	typedef chrono::steady_clock Clock;
+
+	void start() {
+		mStartAllocations = benchmarks::getNumAllocations();
+		mStartBytes = benchmarks::getNumAllocatedBytes();
+		mStartTime = Clock::now();
+	}
+
+	void stop() {
+		const Clock::time_point endTime = Clock::now();
+		mElapsedNs += (double)chrono::duration_cast<chrono::nanoseconds>(endTime - mStartTime).count();
+		mAllocations += benchmarks::getNumAllocations() - mStartAllocations;
+		mBytes += benchmarks::getNumAllocatedBytes() - mStartBytes;
+	}
+
+	double getElapsedNs() const { return mElapsedNs; }
+	size_t getAllocations() const { return mAllocations; }
+	size_t getBytes() const { return mBytes; }
+
+protected:
+	Clock::time_point mStartTime;
+	size_t mStartAllocations = 0;
+	size_t mStartBytes = 0;
+	double mElapsedNs = 0.0;
+	size_t mAllocations = 0;
+	size_t mBytes = 0;
+};
+
+struct Result {
+	string name;
+	double medianNsPerOp = 0.0;
+	double minNsPerOp = 0.0;
+	double allocationsPerOp = 0.0;
+	double bytesPerOp = 0.0;
+	double payloadBytesPerOp = 0.0; // for throughput in MB/s; 0 if not applicable
+};
+
+struct Settings {
+	int numRuns = 7;
+	bool csv = false;
+	bool verbose = false;
+};
+
+//! Runs benchmark once to warm up and then numRuns times. Reports the median and min time per op.
+template <class BenchmarkFn>
+Result measure(const Settings & settings, const string & name, const size_t numOps, BenchmarkFn benchmark, const double payloadBytesPerOp = 0.0) {
+	{
+		Stopwatch warmup;
+		benchmark(warmup);
+	}
+
+	vector<double> nsPerOp;
+	Result result;
+	result.name = name;
+	result.payloadBytesPerOp = payloadBytesPerOp;
+
+	for (int run = 0; run < settings.numRuns; ++run) {
+		Stopwatch stopwatch;
+		benchmark(stopwatch);
+		nsPerOp.push_back(stopwatch.getElapsedNs() / (double)numOps);
+
+		// allocations are deterministic for single-threaded benchmarks, so the last run is representative
+		result.allocationsPerOp = (double)stopwatch.getAllocations() / (double)numOps;
+		result.bytesPerOp = (double)stopwatch.getBytes() / (double)numOps;
+	}
+
+	sort(nsPerOp.begin(), nsPerOp.end());
+	result.medianNsPerOp = nsPerOp[nsPerOp.size() / 2];
+	result.minNsPerOp = nsPerOp.front();
+
+	return result;
+}
+
+void printHeader(const Settings & settings) {
+	if (settings.csv) {
+		printf("benchmark,median_ns_per_op,min_ns_per_op,ops_per_sec,allocs_per_op,bytes_per_op,mb_per_sec\n");
+	} else {
+		printf("%-44s %12s %12s %14s %10s %10s %10s\n", "Benchmark", "Median ns", "Min ns", "Ops/s", "Allocs", "Bytes", "MB/s");
+		printf("%s\n", string(118, '-').c_str());
+	}
+}
+
+void printResult(const Settings & settings, const Result & result) {
+	const double opsPerSecond = result.medianNsPerOp > 0.0 ? 1e9 / result.medianNsPerOp : 0.0;
+	const double mbPerSecond = result.payloadBytesPerOp * opsPerSecond / (1024.0 * 1024.0);
+
+	if (settings.csv) {
+		printf("\"%s\",%.2f,%.2f,%.0f,%.2f,%.1f,%.1f\n", result.name.c_str(), result.medianNsPerOp, result.minNsPerOp,
+			opsPerSecond, result.allocationsPerOp, result.bytesPerOp, mbPerSecond);
+	} else {
+		printf("%-44s %12.1f %12.1f %14.0f %10.2f %10.1f %10.1f\n", result.name.c_str(), result.medianNsPerOp, result.minNsPerOp,
+			opsPerSecond, result.allocationsPerOp, result.bytesPerOp, mbPerSecond);
+	}
+	fflush(stdout);
+}
+
+//==================================================
+// Client access
+// 
+
+//! Exposes batch assembly so it can be driven without setting up workers or sending anything.
+class BenchmarkClient : public AnalyticsClient {
+public:
+	BenchmarkClient() {
+		setAppName("Benchmark App");
+		setGaId("UA-00000000-1");
+		setClientId("01234567-89ab-cdef-0123-456789abcdef");
+		setAppVersion("1.0.0");
+	}
+
+	//! Moves all tracked hits into batches and discards the queued batches. Returns the number of discarded hits.
+	size_t assembleAndDiscard(const bool includeCurrentBatch) {
+		lock_guard<mutex> lock(mBatchMutex);
+
+		assembleBatches();
+
+		if (includeCurrentBatch && mCurrentBatch && !mCurrentBatch->isEmpty()) {
+			queueCurrentBatch();
+		}
+
+		size_t numHits = 0;
+		for (const auto & batch : mBatchQueue) {
+			numHits += batch->numHits();
+		}
+		clearBatchQueue();
+
+		return numHits;
+	}
+
+	//! Moves all tracked hits into queued batches and keeps them queued, as if the network was down.
+	void assembleOffline() {
+		lock_guard<mutex> lock(mBatchMutex);
+
+		assembleBatches();
+
+		if (mCurrentBatch && !mCurrentBatch->isEmpty()) {
+			queueCurrentBatch();
+		}
+	}
+
+	//! Opens a spill queue without calling setup() (which would start sending).
+	bool enableSpilling(const fs::path & directory) {
+		mSpillQueue = make_shared<utils::SpillQueue>();
+		return mSpillQueue->open(directory);
+	}
+};
+
+const size_t NUM_HITS_PER_RUN = 100000;
+const size_t NUM_HITS_PER_CHUNK = 2048; // stays below the incoming hit buffer capacity so tracking never overflows
+
+//! Measures the caller-thread cost of trackFn. Hits are assembled between chunks outside of the measured time.
+template <class TrackFn>
+Result measureTracking(const Settings & settings, const string & name, TrackFn trackFn) {
+	return measure(settings, name, NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		BenchmarkClient client;
+
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; i += NUM_HITS_PER_CHUNK) {
+			const size_t chunkEnd = min(i + NUM_HITS_PER_CHUNK, NUM_HITS_PER_RUN);
+
+			stopwatch.start();
+			for (size_t j = i; j < chunkEnd; ++j) {
+				trackFn(client, (int)j);
+			}
+			stopwatch.stop();
+
+			sSink += client.assembleAndDiscard(true);
+		}
+	});
+}
+
+//! Measures end-to-end throughput of tracking on numProducers threads while one consumer assembles batches.
+Result measureAssembly(const Settings & settings, const int numProducers) {
+	const string name = "batch assembly, " + to_string(numProducers) + " producer" + (numProducers > 1 ? "s" : "");
+
+	return measure(settings, name, NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		BenchmarkClient client;
+		atomic<int> numProducersRunning(numProducers);
+		vector<thread> producers;
+		const size_t numHitsPerProducer = NUM_HITS_PER_RUN / numProducers;
+
+		stopwatch.start();
+
+		for (int p = 0; p < numProducers; ++p) {
+			producers.emplace_back([&] {
+				for (size_t i = 0; i < numHitsPerProducer; ++i) {
+					client.trackEvent("Benchmark Category", "Tap", "Producer", (int)i);
+				}
+				numProducersRunning--;
+			});
+		}
+
+		size_t numHitsAssembled = 0;
+		while (numProducersRunning > 0) {
+			numHitsAssembled += client.assembleAndDiscard(false);
+		}
+
+		for (auto & producer : producers) {
+			producer.join();
+		}
+
+		numHitsAssembled += client.assembleAndDiscard(true);
+
+		stopwatch.stop();
+
+		if (numHitsAssembled != numHitsPerProducer * numProducers) {
+			fprintf(stderr, "Error: assembled %zu of %zu hits\n", numHitsAssembled, numHitsPerProducer * numProducers);
+		}
+	});
+}
+
+const size_t NUM_OUTAGE_HITS = 72 * 5000;	// 3 days offline at 5,000 hits per hour
+const size_t OUTAGE_QUEUE_BUDGET = 20000;	// hits
+
+//! Measures the cost of tracking and batching while offline with a bounded queue and verifies that every hit is accounted for.
+Result measureOutage(const Settings & settings, const string & name, const AnalyticsClient::OverflowPolicy policy) {
+	return measure(settings, "3-day outage, " + name, NUM_OUTAGE_HITS, [&](Stopwatch & stopwatch) {
+		BenchmarkClient client;
+		client.setMaxQueuedHits(OUTAGE_QUEUE_BUDGET);
+		client.setOverflowPolicy(policy);
+
+		if (policy == AnalyticsClient::SPILL_TO_DISK && !client.enableSpilling(fs::temp_directory_path() / "analytics-benchmark-spill")) {
+			fprintf(stderr, "Error: could not open spill directory\n");
+		}
+
+		stopwatch.start();
+		for (size_t i = 0; i < NUM_OUTAGE_HITS; i += NUM_HITS_PER_CHUNK) {
+			const size_t chunkEnd = min(i + NUM_HITS_PER_CHUNK, NUM_OUTAGE_HITS);
+			for (size_t j = i; j < chunkEnd; ++j) {
+				client.trackEvent("Benchmark Category", "Tap", "Video 3", (int)j);
+			}
+			client.assembleOffline();
+		}
+		stopwatch.stop();
+
+		const AnalyticsClient::Stats stats = client.getStats();
+		const uint64_t numAccountedHits = stats.numQueuedHits + stats.numSpilledHits + stats.numHitsDropped;
+
+		if (numAccountedHits != stats.numHitsTracked || stats.numQueuedHits > OUTAGE_QUEUE_BUDGET) {
+			fprintf(stderr, "Error: %zu hits queued, %zu spilled and %llu dropped of %llu tracked (budget %zu)\n", stats.numQueuedHits,
+				stats.numSpilledHits, (unsigned long long)stats.numHitsDropped, (unsigned long long)stats.numHitsTracked, OUTAGE_QUEUE_BUDGET);
+		}
+	});
+}
+
+} // anonymous namespace
+
+//==================================================
+// Main
+// 
+
+int main(int argc, char * argv[]) {
+	Settings settings;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--csv") == 0) {
+			settings.csv = true;
+		} else if (strcmp(argv[i], "--verbose") == 0) {
+			settings.verbose = true;
+		} else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+			settings.numRuns = max(1, atoi(argv[++i]));
+		} else {
+			fprintf(stderr, "Usage: %s [--csv] [--verbose] [--runs <n>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (!settings.verbose) {
+#if defined(BLUECADET_ANALYTICS_STANDALONE)
+		utils::setMinLogLevel(utils::LOG_NONE);
+#else
+		ci::log::manager()->clearLoggers();
+#endif
+	}
+
+	printHeader(settings);
+
+	// Caller-thread cost of tracking
+	printResult(settings, measureTracking(settings, "trackEvent", [](AnalyticsClient & client, int i) {
+		client.trackEvent("Benchmark Category", "Tap", "Video 3", i);
+	}));
+
+	printResult(settings, measureTracking(settings, "trackScreenView", [](AnalyticsClient & client, int) {
+		client.trackScreenView("Benchmark Screen");
+	}));
+
+	const utils::InternedString internedCategory = utils::StringDictionary::get().intern("Benchmark Category");
+	const utils::InternedString internedAction = utils::StringDictionary::get().intern("Tap");
+	const utils::InternedString internedLabel = utils::StringDictionary::get().intern("Video 3");
+
+	printResult(settings, measureTracking(settings, "trackEvent (interned)", [&](AnalyticsClient & client, int i) {
+		client.trackEvent(internedCategory, internedAction, internedLabel, i);
+	}));
+
+	printResult(settings, measureTracking(settings, "trackUserTiming", [](AnalyticsClient & client, int i) {
+		client.trackUserTiming("Benchmark Category", "Load", i, "Video 3");
+	}));
+
+	// Many visitors sharing one client
+	const size_t numVisitors = 100;
+	printResult(settings, measure(settings, "AnalyticsVisitor::trackEvent, " + to_string(numVisitors) + " visitors", NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		auto client = make_shared<BenchmarkClient>();
+		vector<AnalyticsVisitorRef> visitors;
+
+		for (size_t v = 0; v < numVisitors; ++v) {
+			char clientId[40];
+			snprintf(clientId, sizeof(clientId), "01234567-89ab-cdef-0123-%012zu", v);
+			visitors.push_back(client->createVisitor(clientId));
+		}
+
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; i += NUM_HITS_PER_CHUNK) {
+			const size_t chunkEnd = min(i + NUM_HITS_PER_CHUNK, NUM_HITS_PER_RUN);
+
+			stopwatch.start();
+			for (size_t j = i; j < chunkEnd; ++j) {
+				visitors[j % numVisitors]->trackEvent("Benchmark Category", "Tap", "Video 3", (int)j);
+			}
+			stopwatch.stop();
+
+			sSink += client->assembleAndDiscard(true);
+		}
+	}));
+
+	// Percent-encoding of typical labels, screen names and app names
+	const vector<string> labels = {
+		"Video 3",
+		"Gallery/Room 2 \xE2\x80\x93 Interactive Map",
+		"Caf\xC3\xA9 de l'Artiste",
+		"\xC3\x96lgem\xC3\xA4lde: Blick auf Hamburg (1890)",
+		"Kid's Zone > Dinosaur Dig!",
+		"exhibit_hall_a.touchscreen-04",
+		"\xE5\xB1\x95\xE7\xA4\xBA 3 \xE2\x80\x93 \xE6\x9D\xB1\xE4\xBA\xAC",
+		"Bluecadet Interactive Timeline v2.4.1 (Windows 10)"
+	};
+	double labelSize = 0.0;
+	for (const auto & label : labels) {
+		labelSize += (double)label.size() / (double)labels.size();
+	}
+
+	printResult(settings, measure(settings, "utils::percentEncode (labels)", NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		stopwatch.start();
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; ++i) {
+			sSink += utils::percentEncode(labels[i % labels.size()]).size();
+		}
+		stopwatch.stop();
+	}, labelSize));
+
+	printResult(settings, measure(settings, "scalar percent-encoding (labels)", NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		stopwatch.start();
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; ++i) {
+			sSink += scalarPercentEncode(labels[i % labels.size()]).size();
+		}
+		stopwatch.stop();
+	}, labelSize));
+
+#if !defined(BLUECADET_ANALYTICS_STANDALONE)
+	printResult(settings, measure(settings, "ci::Url::encode (labels)", NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		stopwatch.start();
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; ++i) {
+			sSink += ci::Url::encode(labels[i % labels.size()]).size();
+		}
+		stopwatch.stop();
+	}, labelSize));
+#endif
+
+	// Serialization
+	const GAEvent event("Benchmark App", "UA-00000000-1", "01234567-89ab-cdef-0123-456789abcdef", "1", "Benchmark Category", "Tap", "Video 3", 42);
+	const double eventPayloadSize = (double)event.getPayloadString().size();
+
+	printResult(settings, measure(settings, "GAHit::getPayloadString", NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		stopwatch.start();
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; ++i) {
+			sSink += event.getPayloadString().size();
+		}
+		stopwatch.stop();
+	}, eventPayloadSize));
+
+	printResult(settings, measure(settings, "GABatch::encodeHit", NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		stopwatch.start();
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; ++i) {
+			sSink += GABatch::encodeHit(event).parameters.size();
+		}
+		stopwatch.stop();
+	}, eventPayloadSize));
+
+	const GAEvent internedEvent("Benchmark App", "UA-00000000-1", "01234567-89ab-cdef-0123-456789abcdef", "1", internedCategory, internedAction, internedLabel, 42);
+
+	printResult(settings, measure(settings, "GABatch::encodeHit (interned)", NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		stopwatch.start();
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; ++i) {
+			sSink += GABatch::encodeHit(internedEvent).parameters.size();
+		}
+		stopwatch.stop();
+	}, eventPayloadSize));
+
+	GABatch batch;
+	const GAEncodedHit encodedEvent = GABatch::encodeHit(event);
+	while (batch.canAddHit(encodedEvent)) {
+		batch.addHit(encodedEvent);
+	}
+	const size_t numBatchUpdates = NUM_HITS_PER_RUN / 10;
+
+	printResult(settings, measure(settings, "GABatch::updatePayload (" + to_string(batch.numHits()) + " hits)", numBatchUpdates, [&](Stopwatch & stopwatch) {
+		stopwatch.start();
+		for (size_t i = 0; i < numBatchUpdates; ++i) {
+			sSink += batch.updatePayload().size();
+		}
+		stopwatch.stop();
+	}, (double)batch.getPayloadSize()));
+
+	// What a worker does to turn a queued batch into a request before writing it to the socket
+	const GABatchRef sharedBatch = make_shared<GABatch>(batch);
+	const string host = "www.google-analytics.com";
+	const string batchUri = "/batch";
+	utils::UrlRequest::Options headerOptions;
+	headerOptions.method = utils::UrlRequest::Method::POST;
+	const utils::HttpRequestHeaderRef batchHeader = utils::UrlRequest::createRequestHeader(host, batchUri, headerOptions, true);
+
+	printResult(settings, measure(settings, "UrlRequest::createRequestData (batch POST)", numBatchUpdates, [&](Stopwatch & stopwatch) {
+		stopwatch.start();
+		for (size_t i = 0; i < numBatchUpdates; ++i) {
+			utils::UrlRequest::Options options;
+			options.method = utils::UrlRequest::Method::POST;
+			options.sharedBody = shared_ptr<const string>(sharedBatch, &sharedBatch->updatePayload());
+			options.header = batchHeader;
+			sSink += utils::UrlRequest::createRequestData(host, batchUri, std::move(options), true).headerEndSize;
+		}
+		stopwatch.stop();
+	}, (double)batch.getPayloadSize()));
+
+	// Allocations of a hit from tracking to a queued batch
+	printResult(settings, measure(settings, "trackEvent + batch assembly", NUM_HITS_PER_RUN, [&](Stopwatch & stopwatch) {
+		BenchmarkClient client;
+		stopwatch.start();
+		for (size_t i = 0; i < NUM_HITS_PER_RUN; i += NUM_HITS_PER_CHUNK) {
+			const size_t chunkEnd = min(i + NUM_HITS_PER_CHUNK, NUM_HITS_PER_RUN);
+			for (size_t j = i; j < chunkEnd; ++j) {
+				client.trackEvent("Benchmark Category", "Tap", "Video 3", (int)j);
+			}
+			sSink += client.assembleAndDiscard(true);
+		}
+		stopwatch.stop();
+	}));
+
+	// Contention
+	for (const int numProducers : {1, 4, 16}) {
+		printResult(settings, measureAssembly(settings, numProducers));
+	}
+
+	// Bounded queue while offline
+	printResult(settings, measureOutage(settings, "drop oldest", AnalyticsClient::DROP_OLDEST));
+	printResult(settings, measureOutage(settings, "drop newest", AnalyticsClient::DROP_NEWEST));
+	printResult(settings, measureOutage(settings, "sample", AnalyticsClient::SAMPLE));
+	printResult(settings, measureOutage(settings, "spill to disk", AnalyticsClient::SPILL_TO_DISK));
+
+	return 0;
+}
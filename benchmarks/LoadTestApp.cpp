@@ -0,0 +1,287 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+// End-to-end load test of AnalyticsClient against a local MockCollector.
+// Tracks events at a fixed rate, waits until the collector has received all of them and reports
+// delivery throughput and latency (time from trackEvent() until the collector read the hit).
+// Faults can be injected to measure the cost of retries:
+//
+//   LoadTestApp [--hits <n>] [--rate <hits/s, 0 = unthrottled>] [--producers <n>] [--threads <n>]
+//               [--batch-age <s>] [--batches-per-cycle <n>] [--pipeline <depth>]
+//               [--latency <s>] [--error-rate <0..1>] [--reset-rate <0..1>]
+//               [--slow-read-chunk <bytes>] [--slow-read-delay <s>] [--timeout <s>] [--csv]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bluecadet/analytics/AnalyticsClient.h"
+#include "bluecadet/analytics/utils/Clock.hpp"
+#include "MockCollector.h"
+
+using namespace std;
+
+using namespace bluecadet::analytics;
+using namespace bluecadet::analytics::benchmarks;
+
+//! Runs headless; requests complete on the client's default event loop.
+class LoadTestApp {
+public:
+	struct Config {
+		int		numHits = 20000;
+		double	hitsPerSecond = 2000.0;
+		int		numProducers = 1;
+		int		numThreads = 1;
+		double	maxBatchAge = 1.0;
+		int		maxBatchesPerCycle = 8;
+		int		maxPipelineDepth = 1;
+		double	timeout = 60.0;		//! Seconds to wait for all hits after tracking finished
+		bool	csv = false;
+		MockCollector::Faults faults;
+	};
+
+	//! Returns false if the arguments are invalid or the collector couldn't be started.
+	bool	setup(const vector<string> & args);
+	//! Returns true once all hits have been received or the timeout has passed.
+	bool	update();
+	void	cleanup();
+	void	printReport();
+
+protected:
+	bool	parseArgs(const vector<string> & args);
+	void	startProducers();
+
+	Config				mConfig;
+	MockCollectorRef	mCollector;
+	AnalyticsClientRef	mClient;
+
+	vector<thread>		mProducers;
+	vector<double>		mTrackTimes;		//! Time each hit was tracked, indexed by the event label
+	atomic<int>			mNumProducersRunning;
+	atomic<bool>		mIsCanceled;
+	double				mStartTime = 0.0;
+	atomic<double>		mTrackingEndTime;	//! Written by the last producer to finish, read by update()
+};
+
+bool LoadTestApp::setup(const vector<string> & args) {
+	if (!parseArgs(args)) {
+		return false;
+	}
+
+	mCollector = MockCollector::create();
+	mCollector->setFaults(mConfig.faults);
+
+	if (!mCollector->start()) {
+		return false;
+	}
+
+	mClient = make_shared<AnalyticsClient>();
+	mClient->setGaBaseUrl(mCollector->getHost());
+	mClient->setGaPort(mCollector->getPort());
+	mClient->setMaxPipelineDepth(mConfig.maxPipelineDepth);
+	mClient->setup("01234567-89ab-cdef-0123-456789abcdef", "UA-00000000-1", "Load Test", "1.0.0",
+		mConfig.numThreads, mConfig.maxBatchAge, mConfig.maxBatchesPerCycle);
+
+	startProducers();
+	return true;
+}
+
+bool LoadTestApp::parseArgs(const vector<string> & args) {
+	for (size_t i = 1; i < args.size(); ++i) {
+		const string & arg = args[i];
+		const bool hasValue = i + 1 < args.size();
+
+		if (arg == "--csv") mConfig.csv = true;
+		else if (arg == "--hits" && hasValue) mConfig.numHits = max(1, stoi(args[++i]));
+		else if (arg == "--rate" && hasValue) mConfig.hitsPerSecond = max(0.0, stod(args[++i]));
+		else if (arg == "--producers" && hasValue) mConfig.numProducers = max(1, stoi(args[++i]));
+		else if (arg == "--threads" && hasValue) mConfig.numThreads = max(1, stoi(args[++i]));
+		else if (arg == "--batch-age" && hasValue) mConfig.maxBatchAge = stod(args[++i]);
+		else if (arg == "--batches-per-cycle" && hasValue) mConfig.maxBatchesPerCycle = max(1, stoi(args[++i]));
+		else if (arg == "--pipeline" && hasValue) mConfig.maxPipelineDepth = max(1, stoi(args[++i]));
+		else if (arg == "--timeout" && hasValue) mConfig.timeout = stod(args[++i]);
+		else if (arg == "--latency" && hasValue) mConfig.faults.latency = stod(args[++i]);
+		else if (arg == "--error-rate" && hasValue) mConfig.faults.errorRate = stod(args[++i]);
+		else if (arg == "--reset-rate" && hasValue) mConfig.faults.resetRate = stod(args[++i]);
+		else if (arg == "--slow-read-chunk" && hasValue) mConfig.faults.slowReadChunkSize = (size_t)max(0, stoi(args[++i]));
+		else if (arg == "--slow-read-delay" && hasValue) mConfig.faults.slowReadDelay = stod(args[++i]);
+		else {
+			fprintf(stderr, "Unknown argument '%s'; see LoadTestApp.cpp for usage\n", arg.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+void LoadTestApp::startProducers() {
+	mTrackTimes.assign(mConfig.numHits, 0.0);
+	mIsCanceled = false;
+	mNumProducersRunning = mConfig.numProducers;
+	mStartTime = utils::getElapsedSeconds();
+	mTrackingEndTime = mStartTime;
+
+	for (int p = 0; p < mConfig.numProducers; ++p) {
+		mProducers.emplace_back([this, p] {
+			const auto startTime = chrono::steady_clock::now();
+
+			// producers interleave hit indices so that the combined rate stays even
+			for (int i = p, n = 0; i < mConfig.numHits && !mIsCanceled; i += mConfig.numProducers, ++n) {
+				if (mConfig.hitsPerSecond > 0.0) {
+					const double offset = (double)i / mConfig.hitsPerSecond;
+					this_thread::sleep_until(startTime + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(offset)));
+				}
+				mTrackTimes[i] = utils::getElapsedSeconds();
+				mClient->trackEvent("Load Test", "Track", to_string(i), n);
+			}
+
+			if (--mNumProducersRunning == 0) {
+				mTrackingEndTime = utils::getElapsedSeconds();
+			}
+		});
+	}
+}
+
+bool LoadTestApp::update() {
+	if (!mCollector || mNumProducersRunning > 0) {
+		return false;
+	}
+
+	const bool isComplete = mCollector->getNumHits() >= (size_t)mConfig.numHits;
+	const bool isTimedOut = utils::getElapsedSeconds() - mTrackingEndTime > mConfig.timeout;
+
+	return isComplete || isTimedOut;
+}
+
+void LoadTestApp::printReport() {
+	for (auto & producer : mProducers) {
+		producer.join();
+	}
+	mProducers.clear();
+
+	const vector<MockCollector::Hit> hits = mCollector->getHits();
+	const MockCollector::Stats collectorStats = mCollector->getStats();
+	const utils::ConnectionPool::Stats poolStats = mClient->getConnectionPool()->getStats();
+	const utils::DnsCache::Stats dnsStats = utils::DnsCache::getInstance()->getStats();
+
+	vector<double> latencies;
+	set<int> deliveredIndices;
+	size_t numDuplicates = 0;
+	double lastReceivedTime = mStartTime;
+
+	for (const auto & hit : hits) {
+		const auto label = hit.parameters.find("el");
+		const int index = label != hit.parameters.end() ? atoi(label->second.c_str()) : -1;
+
+		if (index < 0 || index >= mConfig.numHits) {
+			continue;
+		}
+
+		if (!deliveredIndices.insert(index).second) {
+			numDuplicates++;
+			continue;
+		}
+
+		latencies.push_back(hit.timeReceived - mTrackTimes[index]);
+		lastReceivedTime = max(lastReceivedTime, hit.timeReceived);
+	}
+
+	sort(latencies.begin(), latencies.end());
+
+	const auto percentileMs = [&](const double p) {
+		if (latencies.empty()) return 0.0;
+		const size_t i = min(latencies.size() - 1, (size_t)(p * (double)latencies.size()));
+		return latencies[i] * 1000.0;
+	};
+
+	const size_t numDelivered = deliveredIndices.size();
+	const size_t numLost = (size_t)mConfig.numHits - numDelivered;
+	const double duration = lastReceivedTime - mStartTime;
+	const double throughput = duration > 0.0 ? (double)numDelivered / duration : 0.0;
+
+	if (mConfig.csv) {
+		printf("hits,delivered,lost,duplicates,hits_per_sec,p50_ms,p90_ms,p99_ms,max_ms,requests,connections,reused_connections,dns_hits,dns_misses,errors_injected,resets_injected,bytes_received\n");
+		printf("%d,%zu,%zu,%zu,%.0f,%.1f,%.1f,%.1f,%.1f,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu\n", mConfig.numHits, numDelivered, numLost, numDuplicates, throughput,
+			percentileMs(0.5), percentileMs(0.9), percentileMs(0.99), percentileMs(1.0), collectorStats.numRequests, collectorStats.numConnections,
+			poolStats.numReusedConnections, dnsStats.numHits, dnsStats.numMisses, collectorStats.numErrorsInjected, collectorStats.numResetsInjected, collectorStats.numBytesReceived);
+	} else {
+		printf("Hits delivered:      %zu of %d (%zu lost, %zu duplicates)\n", numDelivered, mConfig.numHits, numLost, numDuplicates);
+		printf("Throughput:          %.0f hits/s over %.2f s\n", throughput, duration);
+		printf("Latency:             p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms\n", percentileMs(0.5), percentileMs(0.9), percentileMs(0.99), percentileMs(1.0));
+		printf("Requests:            %zu on %zu connections (%zu reused from pool)\n", collectorStats.numRequests, collectorStats.numConnections, poolStats.numReusedConnections);
+		printf("DNS lookups:         %zu cached, %zu waited for DNS (%.0f%% hit rate)\n", dnsStats.numHits, dnsStats.numMisses, dnsStats.getHitRate() * 100.0);
+		string lanes;
+		for (const auto & lane : mClient->getThreadManager()->getLaneStats()) {
+			if (lane.numTasksAdded > 0) {
+				char laneText[128];
+				snprintf(laneText, sizeof(laneText), "%s%s %zu run (max %zu queued)", lanes.empty() ? "" : ", ", lane.name.c_str(), lane.numTasksRun, lane.maxQueueDepth);
+				lanes += laneText;
+			}
+		}
+		printf("Task lanes:          %s\n", lanes.c_str());
+		printf("Faults injected:     %zu errors, %zu resets\n", collectorStats.numErrorsInjected, collectorStats.numResetsInjected);
+		printf("Bytes received:      %zu\n", collectorStats.numBytesReceived);
+	}
+	fflush(stdout);
+}
+
+void LoadTestApp::cleanup() {
+	mIsCanceled = true;
+	for (auto & producer : mProducers) {
+		producer.join();
+	}
+	if (mClient) {
+		mClient->destroy();
+	}
+	if (mCollector) {
+		mCollector->stop();
+	}
+}
+
+int main(int argc, char * argv[]) {
+	LoadTestApp app;
+
+	if (!app.setup(vector<string>(argv, argv + argc))) {
+		app.cleanup();
+		return 1;
+	}
+
+	while (!app.update()) {
+		this_thread::sleep_for(chrono::milliseconds(10));
+	}
+
+	app.printReport();
+	app.cleanup();
+	return 0;
+}
@@ -0,0 +1,451 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "MockCollector.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <sstream>
+
+#include "boost/algorithm/string.hpp"
+
+#include "bluecadet/analytics/utils/Clock.hpp"
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace benchmarks {
+
+namespace {
+	//! 1x1 transparent GIF that GA responds to /collect with
+	const char TRANSPARENT_GIF_DATA[] = "GIF89a\x01\x00\x01\x00\x80\x00\x00\x00\x00\x00\x00\x00\x00\x21\xf9\x04\x01\x00\x00\x00\x00\x2c\x00\x00\x00\x00\x01\x00\x01\x00\x00\x02\x02\x44\x01\x00\x3b";
+	const string TRANSPARENT_GIF(TRANSPARENT_GIF_DATA, sizeof(TRANSPARENT_GIF_DATA) - 1);
+
+	asio::steady_timer::duration toDuration(const double seconds) {
+		return chrono::duration_cast<asio::steady_timer::duration>(chrono::duration<double>(seconds));
+	}
+}
+
+//==================================================
+// Connection
+// 
+
+//! A single client connection. Requests are handled strictly one after the other so that pipelined requests are answered in order.
+class MockCollector::Connection : public std::enable_shared_from_this<Connection> {
+public:
+	Connection(MockCollector & collector) :
+		mCollector(collector),
+		mSocket(collector.mIo),
+		mTimer(collector.mIo)
+	{}
+
+	asio::ip::tcp::socket & getSocket() { return mSocket; }
+
+	void start() {
+		processRequests();
+	}
+
+	void close() {
+		asio::error_code ec;
+		mTimer.cancel(ec);
+		mSocket.close(ec);
+	}
+
+protected:
+	struct Request {
+		string		method;
+		string		uri;
+		string		body;
+		bool		isKeepAlive = true;
+	};
+
+	//! Handles the next complete request in mBuffer or reads more data if there is none.
+	void processRequests() {
+		Request request;
+
+		if (!popRequest(request)) {
+			read();
+			return;
+		}
+
+		++mCollector.mNumRequests;
+
+		const Response response = mCollector.pickResponse();
+		const double latency = mCollector.getFaults().latency;
+
+		if (response == RESPOND_OK) {
+			// payload is in the body for POST and in the query for GET
+			const size_t queryPos = request.uri.find('?');
+			const string path = request.uri.substr(0, queryPos);
+			const string payload = request.method == "GET" && queryPos != string::npos ? request.uri.substr(queryPos + 1) : request.body;
+			mCollector.recordHits(path, payload);
+		}
+
+		auto self = shared_from_this();
+		const auto respond = [this, self, request, response] {
+			switch (response) {
+				case RESPOND_OK: write(request, "200 OK"); break;
+				case RESPOND_ERROR: write(request, "503 Service Unavailable"); break;
+				case RESPOND_RESET: reset(); break;
+			}
+		};
+
+		if (latency > 0.0) {
+			mTimer.expires_from_now(toDuration(latency));
+			mTimer.async_wait([respond] (const asio::error_code & ec) {
+				if (!ec) respond();
+			});
+		} else {
+			respond();
+		}
+	}
+
+	//! Extracts the first complete request from mBuffer. Returns false if more data is needed.
+	bool popRequest(Request & request) {
+		const size_t headerEnd = mBuffer.find("\r\n\r\n");
+		if (headerEnd == string::npos) {
+			return false;
+		}
+
+		istringstream header(mBuffer.substr(0, headerEnd));
+		string line;
+		getline(header, line);
+		istringstream requestLine(line);
+		requestLine >> request.method >> request.uri;
+
+		size_t contentLength = 0;
+		while (getline(header, line)) {
+			const size_t colonPos = line.find(':');
+			if (colonPos == string::npos) continue;
+			const string key = boost::trim_copy(line.substr(0, colonPos));
+			const string value = boost::trim_copy(line.substr(colonPos + 1));
+			if (boost::iequals(key, "Content-Length")) {
+				contentLength = (size_t)strtoull(value.c_str(), nullptr, 10);
+			} else if (boost::iequals(key, "Connection")) {
+				request.isKeepAlive = !boost::iequals(value, "close");
+			}
+		}
+
+		const size_t bodyStart = headerEnd + 4;
+		if (mBuffer.size() < bodyStart + contentLength) {
+			return false;
+		}
+
+		request.body = mBuffer.substr(bodyStart, contentLength);
+		mBuffer.erase(0, bodyStart + contentLength);
+		return true;
+	}
+
+	void read() {
+		const Faults faults = mCollector.getFaults();
+		const size_t maxBytes = faults.slowReadChunkSize > 0 ? min(faults.slowReadChunkSize, mReadBuffer.size()) : mReadBuffer.size();
+		auto self = shared_from_this();
+
+		mSocket.async_read_some(asio::buffer(mReadBuffer.data(), maxBytes), [this, self, faults] (const asio::error_code & ec, size_t numBytes) {
+			if (ec) {
+				close(); // client closed the connection or it was closed by stop()
+				return;
+			}
+
+			mCollector.mNumBytesReceived += numBytes;
+			mBuffer.append(mReadBuffer.data(), numBytes);
+
+			if (faults.slowReadChunkSize > 0 && faults.slowReadDelay > 0.0) {
+				mTimer.expires_from_now(toDuration(faults.slowReadDelay));
+				mTimer.async_wait([this, self] (const asio::error_code & ec) {
+					if (!ec) processRequests();
+				});
+			} else {
+				processRequests();
+			}
+		});
+	}
+
+	void write(const Request & request, const string & status) {
+		const bool isCollect = request.uri.compare(0, 8, "/collect") == 0;
+		const string body = isCollect && status[0] == '2' ? TRANSPARENT_GIF : string();
+
+		auto response = make_shared<string>("HTTP/1.1 " + status + "\r\n");
+		*response += "Content-Type: " + string(isCollect ? "image/gif" : "text/plain") + "\r\n";
+		*response += "Content-Length: " + to_string(body.size()) + "\r\n";
+		*response += "Connection: " + string(request.isKeepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+		*response += body;
+
+		auto self = shared_from_this();
+		const bool isKeepAlive = request.isKeepAlive;
+
+		asio::async_write(mSocket, asio::buffer(*response), [this, self, response, isKeepAlive] (const asio::error_code & ec, size_t) {
+			if (ec || !isKeepAlive) {
+				close();
+				return;
+			}
+			processRequests();
+		});
+	}
+
+	void reset() {
+		// closing with a zero linger timeout sends RST instead of FIN
+		asio::error_code ec;
+		mSocket.set_option(asio::socket_base::linger(true, 0), ec);
+		close();
+	}
+
+	MockCollector &			mCollector;
+	asio::ip::tcp::socket	mSocket;
+	asio::steady_timer		mTimer;
+	array<char, 16 * 1024>	mReadBuffer;
+	string					mBuffer;	//! Data received but not handled yet
+};
+
+//==================================================
+// MockCollector
+// 
+
+MockCollector::MockCollector() :
+	mIsRunning(false),
+	mPort(0),
+	mRandomSeed(5489u),
+	mNumHits(0),
+	mNumConnections(0),
+	mNumRequests(0),
+	mNumErrorsInjected(0),
+	mNumResetsInjected(0),
+	mNumBytesReceived(0)
+{
+}
+
+MockCollector::~MockCollector() {
+	stop();
+}
+
+bool MockCollector::start(const int port) {
+	stop();
+
+	try {
+		const asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), (unsigned short)port);
+		mAcceptor.reset(new asio::ip::tcp::acceptor(mIo, endpoint));
+		mPort = mAcceptor->local_endpoint().port();
+
+	} catch (std::exception & e) {
+		cout << "MockCollector: Could not listen on port " << port << ": " << e.what() << endl;
+		mAcceptor = nullptr;
+		return false;
+	}
+
+	mRandom.seed(mRandomSeed);
+	mIo.reset();
+	mWork.reset(new asio::io_service::work(mIo));
+	mIsRunning = true;
+
+	accept();
+
+	mThread = thread([this] {
+		mIo.run();
+	});
+
+	return true;
+}
+
+void MockCollector::stop() {
+	if (!mIsRunning) {
+		return;
+	}
+
+	mIsRunning = false;
+
+	// close the acceptor and all connections on the io thread, then let run() return
+	mIo.post([this] {
+		asio::error_code ec;
+		mAcceptor->close(ec);
+		for (auto & weakConnection : mConnections) {
+			if (ConnectionRef connection = weakConnection.lock()) {
+				connection->close();
+			}
+		}
+		mConnections.clear();
+	});
+
+	mWork = nullptr;
+
+	if (mThread.joinable()) {
+		mThread.join();
+	}
+
+	mAcceptor = nullptr;
+}
+
+void MockCollector::accept() {
+	ConnectionRef connection = make_shared<Connection>(*this);
+
+	mAcceptor->async_accept(connection->getSocket(), [this, connection] (const asio::error_code & ec) {
+		if (ec) {
+			return; // acceptor was closed
+		}
+
+		++mNumConnections;
+
+		// forget connections that have been closed
+		mConnections.erase(remove_if(mConnections.begin(), mConnections.end(), [] (const weak_ptr<Connection> & c) { return c.expired(); }), mConnections.end());
+		mConnections.push_back(connection);
+
+		connection->start();
+		accept();
+	});
+}
+
+MockCollector::Response MockCollector::pickResponse() {
+	const Faults faults = getFaults();
+	const double value = uniform_real_distribution<double>(0.0, 1.0)(mRandom);
+
+	if (value < faults.resetRate) {
+		++mNumResetsInjected;
+		return RESPOND_RESET;
+	}
+
+	if (value < faults.resetRate + faults.errorRate) {
+		++mNumErrorsInjected;
+		return RESPOND_ERROR;
+	}
+
+	return RESPOND_OK;
+}
+
+void MockCollector::recordHits(const std::string & uri, const std::string & body) {
+	if (uri != "/batch" && uri != "/collect") {
+		return;
+	}
+
+	const double timeReceived = utils::getElapsedSeconds();
+	vector<ParameterMap> payloads = parsePayload(body);
+
+	lock_guard<mutex> lock(mHitsMutex);
+
+	for (auto & parameters : payloads) {
+		Hit hit;
+		hit.parameters = std::move(parameters);
+		hit.uri = uri;
+		hit.timeReceived = timeReceived;
+		mHits.push_back(std::move(hit));
+	}
+
+	mNumHits += payloads.size();
+}
+
+MockCollector::Faults MockCollector::getFaults() const {
+	lock_guard<mutex> lock(mFaultsMutex);
+	return mFaults;
+}
+
+void MockCollector::setFaults(const Faults & faults) {
+	lock_guard<mutex> lock(mFaultsMutex);
+	mFaults = faults;
+}
+
+std::vector<MockCollector::Hit> MockCollector::getHits() const {
+	lock_guard<mutex> lock(mHitsMutex);
+	return mHits;
+}
+
+MockCollector::Stats MockCollector::getStats() const {
+	Stats stats;
+	stats.numConnections = mNumConnections;
+	stats.numRequests = mNumRequests;
+	stats.numHits = mNumHits;
+	stats.numErrorsInjected = mNumErrorsInjected;
+	stats.numResetsInjected = mNumResetsInjected;
+	stats.numBytesReceived = mNumBytesReceived;
+	return stats;
+}
+
+void MockCollector::clear() {
+	lock_guard<mutex> lock(mHitsMutex);
+	mHits.clear();
+	mNumHits = 0;
+	mNumConnections = 0;
+	mNumRequests = 0;
+	mNumErrorsInjected = 0;
+	mNumResetsInjected = 0;
+	mNumBytesReceived = 0;
+}
+
+std::vector<MockCollector::ParameterMap> MockCollector::parsePayload(const std::string & body) {
+	vector<ParameterMap> hits;
+
+	// batches contain one hit per line
+	vector<string> lines;
+	boost::split(lines, body, boost::is_any_of("\n"));
+
+	for (const auto & line : lines) {
+		if (line.empty()) continue;
+
+		ParameterMap parameters;
+		vector<string> pairs;
+		boost::split(pairs, line, boost::is_any_of("&"));
+
+		for (const auto & pair : pairs) {
+			if (pair.empty()) continue;
+			const size_t equalsPos = pair.find('=');
+			const string key = percentDecode(pair.substr(0, equalsPos));
+			parameters[key] = equalsPos == string::npos ? "" : percentDecode(pair.substr(equalsPos + 1));
+		}
+
+		hits.push_back(std::move(parameters));
+	}
+
+	return hits;
+}
+
+std::string MockCollector::percentDecode(const std::string & value) {
+	string result;
+	result.reserve(value.size());
+
+	for (size_t i = 0; i < value.size(); ++i) {
+		const char c = value[i];
+
+		if (c == '%' && i + 2 < value.size() && isxdigit((unsigned char)value[i + 1]) && isxdigit((unsigned char)value[i + 2])) {
+			result += (char)strtol(value.substr(i + 1, 2).c_str(), nullptr, 16);
+			i += 2;
+		} else if (c == '+') {
+			result += ' ';
+		} else {
+			result += c;
+		}
+	}
+
+	return result;
+}
+
+} // benchmarks namespace
+} // analytics namespace
+} // bluecadet namespace
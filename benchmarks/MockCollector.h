@@ -0,0 +1,164 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bluecadet/analytics/utils/Platform.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace benchmarks {
+
+typedef std::shared_ptr<class MockCollector> MockCollectorRef;
+
+/*!
+ Local stand-in for the Measurement Protocol collection endpoint (i.e. www.google-analytics.com).
+
+ Accepts HTTP/1.1 requests to /batch and /collect (including keep-alive and pipelined requests),
+ parses their payloads and records every hit. Unlike GA, which responds with 200 to anything, it
+ can be configured to misbehave so that retries and backoff can be exercised.
+
+ Runs its own io_service on a background thread, so it doesn't depend on the app's event loop.
+ */
+class MockCollector : public std::enable_shared_from_this<MockCollector> {
+
+public:
+	typedef std::map<std::string, std::string> ParameterMap;
+
+	//! A hit as received by the collector.
+	struct Hit {
+		ParameterMap	parameters;		//! Percent-decoded hit parameters (e.g. "t" -> "event")
+		std::string		uri;			//! "/batch" or "/collect"
+		double			timeReceived;	//! utils::getElapsedSeconds() when the request was fully read
+	};
+
+	//! Faults that are injected into responses. All rates are probabilities from 0 to 1 per request.
+	struct Faults {
+		double		latency = 0.0;			//! Seconds to wait before responding
+		double		errorRate = 0.0;		//! Respond with 503; hits of these requests are not recorded
+		double		resetRate = 0.0;		//! Reset the connection without responding; hits are not recorded
+		size_t		slowReadChunkSize = 0;	//! If > 0, read requests in chunks of this many bytes...
+		double		slowReadDelay = 0.0;	//! ...and wait this many seconds between chunks
+	};
+
+	struct Stats {
+		size_t	numConnections = 0;		//! Connections accepted
+		size_t	numRequests = 0;		//! Requests read, including rejected ones
+		size_t	numHits = 0;			//! Hits recorded
+		size_t	numErrorsInjected = 0;	//! Requests answered with 503
+		size_t	numResetsInjected = 0;	//! Requests answered by resetting the connection
+		size_t	numBytesReceived = 0;	//! Bytes read from all connections
+	};
+
+	static MockCollectorRef create() { return MockCollectorRef(new MockCollector()); }
+
+	~MockCollector();
+
+	//! Starts listening on the loopback interface. Uses an ephemeral port if port is 0; see getPort().
+	//! Returns false if the port couldn't be bound.
+	bool		start(const int port = 0);
+
+	//! Closes all connections and stops the background thread. Recorded hits are kept.
+	void		stop();
+
+	bool		isRunning() const { return mIsRunning; }
+	std::string	getHost() const { return "127.0.0.1"; }
+	int			getPort() const { return mPort; }
+
+	//! Faults applied to all requests from here on. Safe to call while running.
+	Faults		getFaults() const;
+	void		setFaults(const Faults & faults);
+
+	//! Seed for deciding which requests get errors or resets. Takes effect on start().
+	void		setRandomSeed(const unsigned int seed) { mRandomSeed = seed; }
+
+	//! Copy of all hits recorded so far, in the order they were received.
+	std::vector<Hit>	getHits() const;
+	size_t		getNumHits() const { return mNumHits; }
+	Stats		getStats() const;
+
+	//! Discards recorded hits and resets stats.
+	void		clear();
+
+	//! Parses a /batch or /collect body into individual hits. Exposed for tests.
+	static std::vector<ParameterMap>	parsePayload(const std::string & body);
+	static std::string	percentDecode(const std::string & value);
+
+protected:
+	MockCollector();
+
+	class Connection;
+	typedef std::shared_ptr<Connection> ConnectionRef;
+
+	void		accept();
+
+	//! Decides which fault to inject for the next request. Called on the io thread.
+	enum Response { RESPOND_OK, RESPOND_ERROR, RESPOND_RESET };
+	Response	pickResponse();
+
+	void		recordHits(const std::string & uri, const std::string & body);
+
+	asio::io_service				mIo;
+	std::unique_ptr<asio::io_service::work>	mWork;
+	std::unique_ptr<asio::ip::tcp::acceptor>	mAcceptor;
+	std::thread						mThread;
+	std::vector<std::weak_ptr<Connection>>	mConnections;	//! Only accessed on the io thread
+	std::atomic<bool>				mIsRunning;
+	std::atomic<int>				mPort;
+
+	mutable std::mutex				mFaultsMutex;
+	Faults							mFaults;
+	unsigned int					mRandomSeed;
+	std::mt19937					mRandom;		//! Only used on the io thread
+
+	mutable std::mutex				mHitsMutex;
+	std::vector<Hit>				mHits;
+	std::atomic<size_t>				mNumHits;
+	std::atomic<size_t>				mNumConnections;
+	std::atomic<size_t>				mNumRequests;
+	std::atomic<size_t>				mNumErrorsInjected;
+	std::atomic<size_t>				mNumResetsInjected;
+	std::atomic<size_t>				mNumBytesReceived;
+};
+
+} // benchmarks namespace
+} // analytics namespace
+} // bluecadet namespace
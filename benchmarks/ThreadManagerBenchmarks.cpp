@@ -0,0 +1,400 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+// Scaling benchmark for utils::ThreadManager from 1 to N worker threads. Reports tasks per second and the
+// latency from addTask() until a task starts running, as well as heap allocations per task. The backlog scenarios report the latency of the tasks
+// that are added in between a backlog of other tasks, with and without a separate, higher weighted lane.
+// Run with --csv for machine-readable output, --runs <n> to change the number of measured runs (default 5),
+// --max-threads <n> to change N (default: number of cores, at least 4), --tasks <n> for the number of tasks
+// per run and --work <n> for the busy work per task in iterations (~1 ns each). --batch-size <n> and --spin <n>
+// override ThreadManager's dequeue batch size and max spin count, e.g. to compare against taking one task at a time.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AllocationCounter.h"
+
+#include "bluecadet/analytics/utils/Log.h"
+#include "bluecadet/analytics/utils/ThreadManager.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+//==================================================
+// Helpers
+// 
+
+typedef chrono::steady_clock Clock;
+
+volatile uint64_t sSink = 0; // keeps results alive so loops aren't optimized away
+
+struct Settings {
+	int numRuns = 5;
+	int maxThreads = (int)max(4u, thread::hardware_concurrency());
+	size_t numTasks = 200000;
+	int work = 200;
+	int batchSize = -1;	// ThreadManager's default
+	int spinCount = -1;
+	bool csv = false;
+};
+
+struct Result {
+	string name;
+	int numThreads = 0;
+	double tasksPerSecond = 0.0;	// median of all runs
+	double p50Us = 0.0;				// latencies of the median run
+	double p99Us = 0.0;
+	double maxUs = 0.0;
+	double allocationsPerTask = 0.0;	// of the median run
+};
+
+inline int64_t now() {
+	return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+//! Stand-in for the work of a typical task (e.g. assembling or sending a batch)
+inline void doWork(const int numIterations) {
+	uint64_t x = 88172645463325252ull;
+	for (int i = 0; i < numIterations; ++i) {
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+	}
+	sSink += x;
+}
+
+//! Runs a scenario once to warm up and then numRuns times. Each run calls submit(manager, latencies, numCompleted)
+//! and waits until numTasks tasks have completed. Measured tasks record the time between being added and starting
+//! in latencies, which has room for numMeasured tasks (all tasks by default).
+template <class SubmitFn>
+Result measure(const Settings & settings, const string & name, const int numThreads, SubmitFn submit, size_t numMeasured = 0) {
+	numMeasured = numMeasured > 0 ? numMeasured : settings.numTasks;
+
+	struct Run {
+		double tasksPerSecond;
+		double allocationsPerTask;
+		vector<int64_t> latencies;
+	};
+
+	vector<Run> runs;
+
+	for (int run = -1; run < settings.numRuns; ++run) {
+		utils::ThreadManager manager;
+		if (settings.batchSize > 0) {
+			manager.setDequeueBatchSize(settings.batchSize);
+		}
+		if (settings.spinCount >= 0) {
+			manager.setMaxSpinCount(settings.spinCount);
+		}
+		manager.setup(numThreads);
+
+		vector<int64_t> latencies(numMeasured, 0);
+		atomic<size_t> numCompleted(0);
+
+		const size_t startAllocations = benchmarks::getNumAllocations();
+		const int64_t startTime = now();
+		submit(manager, latencies, numCompleted);
+
+		while (numCompleted.load() < settings.numTasks) {
+			this_thread::yield();
+		}
+
+		const double elapsedSeconds = (double)(now() - startTime) * 1e-9;
+		const size_t numAllocations = benchmarks::getNumAllocations() - startAllocations;
+		manager.destroy();
+
+		if (run >= 0) {
+			sort(latencies.begin(), latencies.end());
+			runs.push_back({(double)settings.numTasks / elapsedSeconds, (double)numAllocations / (double)settings.numTasks, std::move(latencies)});
+		}
+	}
+
+	sort(runs.begin(), runs.end(), [](const Run & a, const Run & b) { return a.tasksPerSecond < b.tasksPerSecond; });
+	const Run & median = runs[runs.size() / 2];
+
+	const auto percentileUs = [&](const double p) {
+		const size_t i = min(median.latencies.size() - 1, (size_t)(p * (double)median.latencies.size()));
+		return (double)median.latencies[i] * 1e-3;
+	};
+
+	Result result;
+	result.name = name;
+	result.numThreads = numThreads;
+	result.tasksPerSecond = median.tasksPerSecond;
+	result.p50Us = percentileUs(0.5);
+	result.p99Us = percentileUs(0.99);
+	result.maxUs = percentileUs(1.0);
+	result.allocationsPerTask = median.allocationsPerTask;
+	return result;
+}
+
+void printHeader(const Settings & settings) {
+	if (settings.csv) {
+		printf("benchmark,threads,tasks_per_sec,p50_us,p99_us,max_us,allocs_per_task\n");
+	} else {
+		printf("%-36s %8s %14s %10s %10s %12s %12s\n", "Benchmark", "Threads", "Tasks/s", "p50 us", "p99 us", "Max us", "Allocs/task");
+		printf("%s\n", string(108, '-').c_str());
+	}
+}
+
+void printResult(const Settings & settings, const Result & result) {
+	if (settings.csv) {
+		printf("\"%s\",%d,%.0f,%.2f,%.2f,%.2f,%.3f\n", result.name.c_str(), result.numThreads, result.tasksPerSecond, result.p50Us, result.p99Us, result.maxUs, result.allocationsPerTask);
+	} else {
+		printf("%-36s %8d %14.0f %10.2f %10.2f %12.2f %12.3f\n", result.name.c_str(), result.numThreads, result.tasksPerSecond, result.p50Us, result.p99Us, result.maxUs, result.allocationsPerTask);
+	}
+	fflush(stdout);
+}
+
+//==================================================
+// Scenarios
+// 
+
+//! numProducers threads add all tasks from outside the pool, e.g. like tracking calls or update callbacks.
+Result measureExternal(const Settings & settings, const int numThreads, const int numProducers) {
+	const string name = "addTask from " + to_string(numProducers) + " producer" + (numProducers > 1 ? "s" : "");
+
+	return measure(settings, name, numThreads, [&](utils::ThreadManager & manager, vector<int64_t> & latencies, atomic<size_t> & numCompleted) {
+		vector<thread> producers;
+		const size_t numTasksPerProducer = settings.numTasks / numProducers;
+
+		for (int p = 0; p < numProducers; ++p) {
+			const size_t begin = p * numTasksPerProducer;
+			const size_t end = p == numProducers - 1 ? settings.numTasks : begin + numTasksPerProducer;
+
+			producers.emplace_back([&, begin, end] {
+				for (size_t i = begin; i < end; ++i) {
+					const int64_t timeAdded = now();
+					manager.addTask([&, i, timeAdded] {
+						latencies[i] = now() - timeAdded;
+						doWork(settings.work);
+						numCompleted++;
+					});
+				}
+			});
+		}
+
+		for (auto & producer : producers) {
+			producer.join();
+		}
+	});
+}
+
+//! One producer adds tasks numPerCall at a time with addTasks(), e.g. like a burst of batches being sent at once.
+Result measureBulk(const Settings & settings, const int numThreads, const size_t numPerCall) {
+	const string name = "addTasks from 1 producer, " + to_string(numPerCall) + " per call";
+
+	return measure(settings, name, numThreads, [&](utils::ThreadManager & manager, vector<int64_t> & latencies, atomic<size_t> & numCompleted) {
+		vector<utils::TaskFn> tasks;
+		tasks.reserve(numPerCall);
+
+		for (size_t i = 0; i < settings.numTasks; ++i) {
+			const int64_t timeAdded = now();
+			tasks.push_back([&, i, timeAdded] {
+				latencies[i] = now() - timeAdded;
+				doWork(settings.work);
+				numCompleted++;
+			});
+
+			if (tasks.size() == numPerCall || i + 1 == settings.numTasks) {
+				manager.addTasks(tasks);
+			}
+		}
+	});
+}
+
+//! Like measureExternal() with one producer, but each task captures more state than fits inline in a task and the
+//! producer keeps at most maxBacklog tasks waiting, like steady traffic rather than a burst.
+Result measureLargeCapture(const Settings & settings, const int numThreads, const size_t maxBacklog) {
+	struct Payload {
+		uint64_t values[12];
+	};
+
+	return measure(settings, "addTask, 96 byte capture, steady", numThreads, [&](utils::ThreadManager & manager, vector<int64_t> & latencies, atomic<size_t> & numCompleted) {
+		Payload payload = {};
+
+		for (size_t i = 0; i < settings.numTasks; ++i) {
+			while (i - numCompleted.load() > maxBacklog) {
+				this_thread::yield();
+			}
+
+			payload.values[i % 12] = i;
+			const int64_t timeAdded = now();
+			manager.addTask([&, i, timeAdded, payload] {
+				latencies[i] = now() - timeAdded;
+				sSink += payload.values[0];
+				doWork(settings.work);
+				numCompleted++;
+			});
+		}
+	});
+}
+
+//! Tasks added from outside the pool each add numChildren tasks from their worker, e.g. like processBatches()
+//! sending the batches it assembled.
+Result measureFanOut(const Settings & settings, const int numThreads, const size_t numChildren) {
+	const string name = "fan-out, " + to_string(numChildren) + " tasks per parent";
+
+	return measure(settings, name, numThreads, [&](utils::ThreadManager & manager, vector<int64_t> & latencies, atomic<size_t> & numCompleted) {
+		const size_t numParents = settings.numTasks / numChildren;
+
+		for (size_t parent = 0; parent < numParents; ++parent) {
+			manager.addTask([&, parent] {
+				doWork(settings.work);
+
+				for (size_t child = 0; child < numChildren; ++child) {
+					const size_t i = parent * numChildren + child;
+					const int64_t timeAdded = now();
+					manager.addTask([&, i, timeAdded] {
+						latencies[i] = now() - timeAdded;
+						doWork(settings.work);
+						numCompleted++;
+					});
+				}
+			});
+		}
+
+		// tasks that don't divide evenly
+		for (size_t i = numParents * numChildren; i < settings.numTasks; ++i) {
+			numCompleted++;
+		}
+	});
+}
+
+//! A producer adds one urgent task for every numBulkPerUrgent bulk tasks, faster than the workers can keep up,
+//! e.g. like processBatches() tasks in between a backlog of requests. Only the urgent tasks' latencies are reported.
+Result measureBacklog(const Settings & settings, const int numThreads, const size_t numBulkPerUrgent, const bool useLanes) {
+	const string name = useLanes ? "backlog, urgent lane 4:1" : "backlog, urgent tasks in same lane";
+	const size_t stride = numBulkPerUrgent + 1;
+	const size_t numUrgent = (settings.numTasks + stride - 1) / stride;
+
+	return measure(settings, name, numThreads, [&](utils::ThreadManager & manager, vector<int64_t> & latencies, atomic<size_t> & numCompleted) {
+		const utils::ThreadManager::LaneId bulkLane = useLanes ? manager.addLane("bulk", 1) : utils::ThreadManager::DEFAULT_LANE;
+		const utils::ThreadManager::LaneId urgentLane = useLanes ? manager.addLane("urgent", 4) : utils::ThreadManager::DEFAULT_LANE;
+
+		for (size_t i = 0; i < settings.numTasks; ++i) {
+			if (i % stride == 0) {
+				const size_t j = i / stride;
+				const int64_t timeAdded = now();
+				manager.addTask([&, j, timeAdded] {
+					latencies[j] = now() - timeAdded;
+					doWork(settings.work);
+					numCompleted++;
+				}, urgentLane);
+
+			} else {
+				manager.addTask([&] {
+					doWork(settings.work);
+					numCompleted++;
+				}, bulkLane);
+			}
+		}
+	}, numUrgent);
+}
+
+} // anonymous namespace
+
+//==================================================
+// Main
+// 
+
+int main(int argc, char * argv[]) {
+	Settings settings;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--csv") == 0) {
+			settings.csv = true;
+		} else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+			settings.numRuns = max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc) {
+			settings.maxThreads = max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--tasks") == 0 && i + 1 < argc) {
+			settings.numTasks = (size_t)max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--work") == 0 && i + 1 < argc) {
+			settings.work = max(0, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--batch-size") == 0 && i + 1 < argc) {
+			settings.batchSize = max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--spin") == 0 && i + 1 < argc) {
+			settings.spinCount = max(0, atoi(argv[++i]));
+		} else {
+			fprintf(stderr, "Usage: %s [--csv] [--runs <n>] [--max-threads <n>] [--tasks <n>] [--work <n>] [--batch-size <n>] [--spin <n>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+#if defined(BLUECADET_ANALYTICS_STANDALONE)
+	utils::setMinLogLevel(utils::LOG_NONE);
+#else
+	ci::log::manager()->clearLoggers();
+#endif
+
+	// 1, 2, 4, ... up to and including maxThreads
+	vector<int> threadCounts;
+	for (int numThreads = 1; numThreads < settings.maxThreads; numThreads *= 2) {
+		threadCounts.push_back(numThreads);
+	}
+	threadCounts.push_back(settings.maxThreads);
+
+	printHeader(settings);
+
+	for (const int numThreads : threadCounts) {
+		printResult(settings, measureExternal(settings, numThreads, 1));
+	}
+	for (const int numThreads : threadCounts) {
+		printResult(settings, measureExternal(settings, numThreads, 4));
+	}
+	for (const int numThreads : threadCounts) {
+		printResult(settings, measureBulk(settings, numThreads, 16));
+	}
+	for (const int numThreads : threadCounts) {
+		printResult(settings, measureLargeCapture(settings, numThreads, 256));
+	}
+	for (const int numThreads : threadCounts) {
+		printResult(settings, measureFanOut(settings, numThreads, 16));
+	}
+	for (const int useLanes : {0, 1}) {
+		for (const int numThreads : threadCounts) {
+			printResult(settings, measureBacklog(settings, numThreads, 7, useLanes != 0));
+		}
+	}
+
+	return 0;
+}
@@ -114,6 +114,17 @@ void BasicSampleApp::setupParams() {
 			AnalyticsClient::getInstance()->trackEvent("Test Category", "Test Action");
 		}
 	});
+	mParams->addButton("Benchmark 10,000 Events", [] {
+		// measures the cost of tracking a hit on the calling thread (excludes batching and sending)
+		const int numHits = 10000;
+		const auto start = chrono::high_resolution_clock::now();
+		for (int i = 0; i < numHits; ++i) {
+			AnalyticsClient::getInstance()->trackEvent("Test Category", "Test Action", "Benchmark", i);
+		}
+		const auto end = chrono::high_resolution_clock::now();
+		const double totalNs = (double)chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+		CI_LOG_I("Tracked " << to_string(numHits) << " events in " << to_string(totalNs / 1000000.0) << "ms (" << to_string(totalNs / (double)numHits) << "ns per hit)");
+	});
 	mParams->addButton("Track 1 Screen View", [] {
 		AnalyticsClient::getInstance()->trackScreenView("Test Screen");
 	});
@@ -56,9 +56,10 @@ public:
 	void draw() override;
 
 	params::InterfaceGlRef mParams;
-	AnalyticsClientRef mClientA;
-	AnalyticsClientRef mClientB;
-	AnalyticsClientRef mClientC;
+	AnalyticsClientRef mClient;
+	AnalyticsVisitorRef mVisitorA;
+	AnalyticsVisitorRef mVisitorB;
+	AnalyticsVisitorRef mVisitorC;
 };
 
 void MultiUserSampleApp::setup() {
@@ -69,15 +70,16 @@ void MultiUserSampleApp::setup() {
 	// The name of your app (required).
 	string appName = "Multi User Sample";
 
-	// Create multiple clients if you want to track individual users in a multi-user app
-	mClientA = AnalyticsClientRef(new AnalyticsClient());
-	mClientB = AnalyticsClientRef(new AnalyticsClient());
-	mClientC = AnalyticsClientRef(new AnalyticsClient());
+	// One client sends the hits of all users in shared batches, using the same threads and connections
+	mClient = AnalyticsClientRef(new AnalyticsClient());
+	mClient->setup(boost::uuids::to_string(boost::uuids::random_generator()()), gaId, appName);
 
-	// Tracking events or screen views on these clients should measure as one active user per client ID in GA
-	mClientA->setup(boost::uuids::to_string(boost::uuids::random_generator()()), gaId, appName);
-	mClientB->setup(boost::uuids::to_string(boost::uuids::random_generator()()), gaId, appName);
-	mClientC->setup(boost::uuids::to_string(boost::uuids::random_generator()()), gaId, appName);
+	// Create one visitor per user you want to track individually in a multi-user app. Visitors are cheap,
+	// so you can create a new one whenever someone new walks up to your exhibit.
+	// Tracking events or screen views on these visitors should measure as one active user per client ID in GA
+	mVisitorA = mClient->createVisitor(boost::uuids::to_string(boost::uuids::random_generator()()));
+	mVisitorB = mClient->createVisitor(boost::uuids::to_string(boost::uuids::random_generator()()));
+	mVisitorC = mClient->createVisitor(boost::uuids::to_string(boost::uuids::random_generator()()));
 
 	setupParams();
 }
@@ -85,14 +87,17 @@ void MultiUserSampleApp::setup() {
 void MultiUserSampleApp::setupParams() {
 	mParams = params::InterfaceGl::create("MultiUserSampleApp", ivec2(256, 256));
 
-	mParams->addButton("Track 1 Event on Client A", [this] {
-		mClientA->trackEvent("Test Category", "Test Action");
+	mParams->addButton("Track 1 Event on Visitor A", [this] {
+		mVisitorA->trackEvent("Test Category", "Test Action");
 	});
-	mParams->addButton("Track 1 Event on Client B", [this] {
-		mClientB->trackEvent("Test Category", "Test Action");
+	mParams->addButton("Track 1 Event on Visitor B", [this] {
+		mVisitorB->trackEvent("Test Category", "Test Action");
 	});
-	mParams->addButton("Track 1 Event on Client C", [this] {
-		mClientC->trackEvent("Test Category", "Test Action");
+	mParams->addButton("Track 1 Event on Visitor C", [this] {
+		mVisitorC->trackEvent("Test Category", "Test Action");
+	});
+	mParams->addButton("Replace Visitor C", [this] {
+		mVisitorC = mClient->createVisitor(boost::uuids::to_string(boost::uuids::random_generator()()));
 	});
 
 	mParams->addSeparator();
@@ -1,81 +0,0 @@
-/*
-* 
-* Copyright (c) 2016, Wieden+Kennedy, 
-* Stephen Schieberl
-* All rights reserved.
-* 
-* Redistribution and use in source and binary forms, with or 
-* without modification, are permitted provided that the following 
-* conditions are met:
-* 
-* Redistributions of source code must retain the above copyright 
-* notice, this list of conditions and the following disclaimer.
-* Redistributions in binary form must reproduce the above copyright 
-* notice, this list of conditions and the following disclaimer in 
-* the documentation and/or other materials provided with the 
-* distribution.
-* 
-* Neither the name of the Ban the Rewind nor the names of its 
-* contributors may be used to endorse or promote products 
-* derived from this software without specific prior written 
-* permission.
-* 
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
-* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
-* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
-* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
-* COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
-* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
-* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
-* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
-* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
-* STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
-* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
-* ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-* 
-*/
-
-#pragma once
-
-#include "HttpInterface.h"
-
-class HttpResponse : public HttpInterface
-{
-public:
-	//! Creates empty HTTP response.
-	HttpResponse();
-	//! Creates a HTTP response. Populates status line with arguments.
-	HttpResponse( HttpVersion httpVersion, size_t statusCode, const std::string& reason );
-	
-	//! Returns reason.
-	const std::string&	getReason() const;
-	//! Sets reason to \a reason.
-	void		setReason( const std::string& reason );
-	
-	//! Returns status code.
-	size_t		getStatusCode() const;
-	//! Sets status code to \a code.
-	void		setStatusCode( size_t code );
-	
-	/*! Parses header from \a header. Throws exceptions for incomplete
-		or invalid headers. */
-	void		parseHeader( const std::string& header );
-	
-	//! Exception representing invalid status line.
-	class ExcStatusLineInvalid : public ci::Exception
-	{
-	public:
-		ExcStatusLineInvalid( const std::string &statusLine ) throw();
-		virtual const char* what() const throw()
-		{
-			return mMessage;
-		}
-	private:
-		char mMessage[ 2048 ];
-	};
-protected:
-	std::string	headerToString() const;
-	
-	std::string	mReason;
-	size_t		mStatusCode;
-};
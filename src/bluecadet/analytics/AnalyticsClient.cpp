@@ -32,207 +32,1292 @@
 
 #include "AnalyticsClient.h"
 
-#include "cinder/Log.h"
+#include "boost/variant.hpp"
 
-#include "GAEvent.hpp"
-#include "GAUserTiming.hpp"
-#include "GAScreenView.hpp"
+#include "utils/Log.h"
 
-using namespace ci;
-using namespace ci::app;
 using namespace std;
 
 namespace bluecadet {
 namespace analytics {
 
+namespace {
+	const int INGESTION_LANE_WEIGHT = 2;
+	const int DISPATCH_LANE_WEIGHT = 4;		//! Cheap and decides when fresh hits go out, so it shouldn't wait behind a backlog of requests
+	const int SERIALIZATION_LANE_WEIGHT = 1;
+
+	int64_t getUnixTimeMs() {
+		return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+	}
+}
+
 AnalyticsClient::AnalyticsClient() :
 	mThreadManager(make_shared<utils::ThreadManager>()),
-	mCacheBusterEnabled(true),
-	mAutoSessionsEnabled(true),
-	mMaxHitsPerSession(400), // stay below 500 events per session limit
+	mIngestionLane(utils::ThreadManager::DEFAULT_LANE),
+	mDispatchLane(utils::ThreadManager::DEFAULT_LANE),
+	mSerializationLane(utils::ThreadManager::DEFAULT_LANE),
+	mConnectionPool(make_shared<utils::ConnectionPool>()),
+	mUpdateCallbackId(utils::EventLoop::INVALID_CALLBACK_ID),
+	mCleanupCallbackId(utils::EventLoop::INVALID_CALLBACK_ID),
+	mIsSetUp(false),
+	mDispatchMode(EVENT_DRIVEN),
+	mMinDispatchInterval(1.0 / 60.0),
+	mScheduledProcessingTaskId(utils::ThreadManager::INVALID_TASK_ID),
+	mScheduledProcessingTime(0.0),
+	mNumUnbatchedHits(0),
+	mNumIncomingBytes(0),
+	mCurrentBatchSize(0),
+	mMaxBatchAge(4.0),
+	mCurrentMaxBatchAge(4.0),
+	mTargetDeliveryLatency(0.0),
+	mBatchAgeController(make_shared<utils::BatchAgeController>()),
 	mHitsInCurrentSession(0),
+	mMaxHitsPerSession(400), // stay below 500 events per session limit
+	mAutoSessionsEnabled(true),
+	mCacheBusterEnabled(true),
+	mIncomingHits(4096),
+	mMaxPipelineDepth(1),
+	mCircuitBreaker(make_shared<utils::CircuitBreaker>()),
+	mProbeId(0),
+	mMaxQueuedHits(0),
+	mMaxQueuedBytes(0),
+	mOverflowPolicy(DROP_OLDEST),
+	mIsQueueOverflowing(false),
+	mNumSampledBatches(0),
+	mNumSpilledHits(0),
+	mNumHitsTracked(0),
+	mNumHitsSent(0),
+	mNumHitsRetried(0),
+	mNumHitsDropped(0),
+	mNumBatchesSent(0),
+	mNumBatchesFailed(0),
+	mNumQueuedHits(0),
+	mNumQueuedBatches(0),
+	mNumQueuedBytes(0),
+	mNumBatchesInFlight(0),
+	mCurrentBackoff(0.0),
+	mTimeOfLastSuccess(0.0),
+	mNextStatsThresholdId(1),
+	mJournalSyncInterval(1.0),
+	mTimeOfLastJournalSync(0.0),
+	mIsReplayingJournal(false),
+	mIsJournalDirty(false),
 	mGaApiVersion("1")
 {
+	mCircuitBreaker->setMaxProbeInterval(GABatch::MAX_DELAY_BETWEEN_ATTEMPTS);
 }
 
 AnalyticsClient::~AnalyticsClient() {
+	if (mEventLoop) {
+		// callbacks refer to this client
+		mEventLoop->removeUpdateCallback(mUpdateCallbackId);
+		mEventLoop->removeCleanupCallback(mCleanupCallbackId);
+	}
+	cancelPendingRequests();
 }
 
 void AnalyticsClient::setup(string clientId, string gaId, string appName, string appVersion, int numThreads, double maxBatchAge, int maxBatchesPerCycle) {
 	destroy();
+
+	// requests call back into the client after the calls that sent them have returned
+	try {
+		mWeakSelf = shared_from_this();
+	} catch (const bad_weak_ptr &) {
+		CI_LOG_E("Client must be owned by an AnalyticsClientRef (e.g. created with make_shared()) to be set up");
+		return;
+	}
 	
 	mAppName = appName;
 	mAppVersion = appVersion;
 	mGaId = gaId;
 	mClientId = clientId;
 	mMaxBatchAge = maxBatchAge;
+	mCurrentMaxBatchAge = maxBatchAge;
+
+	if (!mEventLoop) {
+		mEventLoop = utils::getDefaultEventLoop();
+	}
+
+	// stop workers before the app exits, even if destroy() isn't called
+	mCleanupCallbackId = mEventLoop->addCleanupCallback([this] {
+		mThreadManager->destroy();
+	});
+
+	mIngestionLane = mThreadManager->addLane("ingestion", INGESTION_LANE_WEIGHT);
+	mDispatchLane = mThreadManager->addLane("dispatch", DISPATCH_LANE_WEIGHT);
+	mSerializationLane = mThreadManager->addLane("serialization", SERIALIZATION_LANE_WEIGHT);
+
+	mBatchAgeController->setTargetLatency(mTargetDeliveryLatency);
+	mBatchAgeController->setMaxBatchAge(mMaxBatchAge);
+	mBatchAgeController->setDispatchDelay(mMinDispatchInterval);
 	mMaxBatchesPerCycle = maxBatchesPerCycle;
+
+	if (!mJournalDirectory.empty()) {
+		// open journal on worker thread to avoid blocking the main thread with file IO
+		atomic_store(&mJournal, make_shared<utils::HitJournal>());
+		mIsReplayingJournal = true;
+		mThreadManager->addTask([this] {
+			replayJournal();
+		}, mIngestionLane);
+	}
+
+	if (mOverflowPolicy == SPILL_TO_DISK && !mSpillDirectory.empty()) {
+		mSpillQueue = make_shared<utils::SpillQueue>();
+		if (!mSpillQueue->open(mSpillDirectory)) {
+			CI_LOG_W("Could not open spill directory; batches over budget will be dropped");
+			mSpillQueue = nullptr;
+		}
+	}
+
 	mThreadManager->setup(numThreads);
+	mTimeOfLastSuccess = utils::getElapsedSeconds();
+	mIsSetUp = true;
 	
 	CI_LOG_I("Client set up with GA ID '" << mGaId << "' and client ID '" << mClientId << "'");
 	
-	mUpdateConnection = AppBase::get()->getSignalUpdate().connect([=] {
-		// process batches regularly on sub thread
-		mThreadManager->addTask([this] {
-			processBatches();
+	if (mDispatchMode == UPDATE_SIGNAL) {
+		mUpdateCallbackId = mEventLoop->addUpdateCallback([=] {
+			// process batches regularly on sub thread
+			mThreadManager->addTask([this] {
+				processBatches();
+			}, mDispatchLane);
 		});
-	});
+
+	} else {
+		// pick up any hits that were tracked before setup
+		requestProcessing(0.0);
+	}
 }
 
 void AnalyticsClient::destroy() {
+	mIsSetUp = false;
 	mThreadManager->destroy();
 	
-	if (mUpdateConnection.isConnected()) {
-		mUpdateConnection.disconnect();
+	if (mEventLoop) {
+		mEventLoop->removeUpdateCallback(mUpdateCallbackId);
+		mEventLoop->removeCleanupCallback(mCleanupCallbackId);
+	}
+	mUpdateCallbackId = utils::EventLoop::INVALID_CALLBACK_ID;
+	mCleanupCallbackId = utils::EventLoop::INVALID_CALLBACK_ID;
+
+	// requests still in flight would call back into this client from the event loop's thread
+	cancelPendingRequests();
+
+	{
+		lock_guard<mutex> dispatchLock(mDispatchMutex);
+		mThreadManager->cancelTask(mScheduledProcessingTaskId);
+		mScheduledProcessingTaskId = utils::ThreadManager::INVALID_TASK_ID;
 	}
 	
 	lock_guard<mutex> lock(mBatchMutex);
+
+	// hits that are in the journal aren't lost
+	const utils::HitJournalRef journal = getJournal();
+	const bool isJournaled = journal != nullptr;
+
+	if (journal) {
+		// write any hits that haven't been batched yet to the journal so they can be sent after the next setup()
+		if (!mIsReplayingJournal) {
+			assembleBatches();
+		}
+		// threads that still hold a reference can't write to the journal once it's closed
+		atomic_store(&mJournal, utils::HitJournalRef());
+		journal->close();
+		mIsReplayingJournal = false;
+	}
 	
-	mBatchQueue.clear();
+	GAEncodedHit hit;
+	while (mIncomingHits.tryPop(hit)) {}
+
+	{
+		lock_guard<mutex> overflowLock(mOverflowMutex);
+		mOverflowHits.clear();
+	}
+
+	if (!isJournaled) {
+		mNumHitsDropped += (uint64_t)max(0, mNumUnbatchedHits.load()) + mNumQueuedHits + mNumSpilledHits;
+	}
+
+	if (mSpillQueue) {
+		mSpillQueue->close();
+		mSpillQueue = nullptr;
+	}
+	mNumSpilledHits = 0;
+	mNumSampledBatches = 0;
+	mIsQueueOverflowing = false;
+	mCircuitBreaker->reset();
+	mProbeBatch = nullptr;
+	
+	clearBatchQueue();
+	mBatchesInFlight.clear();
+	mNumBatchesInFlight = 0;
 	mCurrentBatch = nullptr;
+	mNumUnbatchedHits = 0;
+	mNumIncomingBytes = 0;
+	mCurrentBatchSize = 0;
+
+	// abandon any flushes that are still waiting
+	for (auto & flush : mFlushes) {
+		for (const auto & batch : flush->outstandingBatches) {
+			flush->result.numHitsAbandoned += batch->numHits();
+		}
+		flush->promise.set_value(flush->result);
+	}
+	mFlushes.clear();
+
+	mConnectionPool->clear();
+}
+
+AnalyticsClient::FlushResult AnalyticsClient::destroy(const double drainTimeout) {
+	FlushResult result;
+
+	if (mIsSetUp && drainTimeout > 0) {
+		future<FlushResult> flushResult = flush(drainTimeout);
+
+		// the app loop might not run anymore (e.g. during cleanup), so process batches and network events ourselves
+		// unless the loop has a thread of its own that already does
+		while (flushResult.wait_for(chrono::milliseconds(1)) != future_status::ready) {
+			processBatches();
+			if (!mEventLoop->isRunningOwnThread()) {
+				mEventLoop->poll();
+			}
+		}
+
+		result = flushResult.get();
+		CI_LOG_I("Drained " << to_string(result.numHitsDelivered) << " hits before destroying client (" << to_string(result.numHitsAbandoned) << " hits abandoned)");
+	}
+
+	destroy();
+
+	return result;
+}
+
+std::future<AnalyticsClient::FlushResult> AnalyticsClient::flush(const double timeout) {
+	FlushOperationRef flush = make_shared<FlushOperation>();
+	flush->deadline = utils::getElapsedSeconds() + timeout;
+
+	future<FlushResult> result = flush->promise.get_future();
+
+	if (!mIsSetUp) {
+		// not set up, so nothing would ever be sent
+		flush->promise.set_value(flush->result);
+		return result;
+	}
+
+	// flush is started on the next processing cycle so that all hits tracked until then are included
+	{
+		lock_guard<mutex> lock(mBatchMutex);
+		mFlushes.push_back(flush);
+	}
+
+	requestProcessing(0.0);
+
+	return result;
 }
 
 void AnalyticsClient::trackEvent(const string & category, const string & action, const string & label, const int value, const std::string & customQuery) {
-	GAEventRef event = make_shared<GAEvent>(mAppName, mGaId, mClientId, mGaApiVersion, category, action, label, value, customQuery);
-	trackHit(event);
+	GAEvent event(mAppName, mGaId, mClientId, mGaApiVersion, category, action, label, value, customQuery);
+	enqueueHit(event, mHitsInCurrentSession);
 }
 
 void AnalyticsClient::trackScreenView(const string & screenName, const std::string & customQuery) {
-	GAScreenViewRef screenView = make_shared<GAScreenView>(mAppName, mGaId, mClientId, mGaApiVersion, screenName, customQuery);
-	trackHit(screenView);
+	GAScreenView screenView(mAppName, mGaId, mClientId, mGaApiVersion, screenName, customQuery);
+	enqueueHit(screenView, mHitsInCurrentSession);
+}
+
+void AnalyticsClient::trackEvent(const utils::InternedString & category, const utils::InternedString & action, const utils::InternedString & label, const int value, const std::string & customQuery) {
+	GAEvent event(mAppName, mGaId, mClientId, mGaApiVersion, category, action, label, value, customQuery);
+	enqueueHit(event, mHitsInCurrentSession);
+}
+
+void AnalyticsClient::trackScreenView(const utils::InternedString & screenName, const std::string & customQuery) {
+	GAScreenView screenView(mAppName, mGaId, mClientId, mGaApiVersion, screenName, customQuery);
+	enqueueHit(screenView, mHitsInCurrentSession);
 }
 
 void AnalyticsClient::trackUserTiming(const std::string & category, const std::string & variable, const int timeInMs, const std::string & label, const std::string & customQuery) {
-	GAUserTimingRef userTiming = make_shared<GAUserTiming>(mAppName, mGaId, mClientId, mGaApiVersion, category, variable, timeInMs, label, customQuery);
-	trackHit(userTiming);
+	GAUserTiming userTiming(mAppName, mGaId, mClientId, mGaApiVersion, category, variable, timeInMs, label, customQuery);
+	enqueueHit(userTiming, mHitsInCurrentSession);
+}
+
+void AnalyticsClient::trackException(const std::string & description, const bool isFatal, const std::string & customQuery) {
+	GAException exception(mAppName, mGaId, mClientId, mGaApiVersion, description, isFatal, customQuery);
+	enqueueHit(exception, mHitsInCurrentSession);
+}
+
+void AnalyticsClient::trackTransaction(const std::string & transactionId, const std::string & affiliation, const double revenue, const double shipping, const double tax, const std::string & currencyCode, const std::string & customQuery) {
+	GATransaction transaction(mAppName, mGaId, mClientId, mGaApiVersion, transactionId, affiliation, revenue, shipping, tax, currencyCode, customQuery);
+	enqueueHit(transaction, mHitsInCurrentSession);
+}
+
+void AnalyticsClient::trackItem(const std::string & transactionId, const std::string & name, const double price, const int quantity, const std::string & code, const std::string & category, const std::string & currencyCode, const std::string & customQuery) {
+	GAItem item(mAppName, mGaId, mClientId, mGaApiVersion, transactionId, name, price, quantity, code, category, currencyCode, customQuery);
+	enqueueHit(item, mHitsInCurrentSession);
+}
+
+void AnalyticsClient::trackSocial(const std::string & network, const std::string & action, const std::string & target, const std::string & customQuery) {
+	GASocial social(mAppName, mGaId, mClientId, mGaApiVersion, network, action, target, customQuery);
+	enqueueHit(social, mHitsInCurrentSession);
+}
+
+struct AnalyticsClient::HitEnqueuer : public boost::static_visitor<void> {
+	HitEnqueuer(AnalyticsClient & client, std::atomic<int> & hitsInCurrentSession) : client(client), hitsInCurrentSession(hitsInCurrentSession) {}
+	AnalyticsClient & client;
+	std::atomic<int> & hitsInCurrentSession;
+
+	template <class HitType>
+	void operator()(HitType & hit) const {
+		client.enqueueHit(hit, hitsInCurrentSession);
+	}
+};
+
+void AnalyticsClient::track(GAHitVariant hit) {
+	enqueueHitVariant(hit, mHitsInCurrentSession);
+}
+
+void AnalyticsClient::enqueueHitVariant(GAHitVariant & hit, std::atomic<int> & hitsInCurrentSession) {
+	boost::apply_visitor(HitEnqueuer(*this, hitsInCurrentSession), hit);
 }
 
 void AnalyticsClient::trackHit(GAHitRef hit) {
+	if (hit) {
+		enqueueHit(*hit, mHitsInCurrentSession);
+	}
+}
+
+AnalyticsVisitorRef AnalyticsClient::createVisitor(const std::string & clientId) {
+	return AnalyticsVisitorRef(new AnalyticsVisitor(shared_from_this(), clientId));
+}
+
+void AnalyticsClient::applyHitSettings(GAHit & hit, std::atomic<int> & hitsInCurrentSession) {
 
 	// optional hit parameters
-	hit->mAppVersion = mAppVersion;
-	hit->mCacheBuster = mCacheBusterEnabled;
-	hit->mCustomQuery += mCustomQuery;
+	hit.mAppVersion = mAppVersion;
+	hit.mCacheBuster = mCacheBusterEnabled;
+	hit.mCustomQuery += mCustomQuery;
 
 	// handle session control to stay within quotas
 	if (mAutoSessionsEnabled) {
+		const int maxHitsPerSession = max(mMaxHitsPerSession, 1);
+
+		// claim this hit's index within the current session; wraps around to start a new session
+		int hitIndex = hitsInCurrentSession.load();
+		while (!hitsInCurrentSession.compare_exchange_weak(hitIndex, hitIndex + 1 >= maxHitsPerSession ? 0 : hitIndex + 1)) {}
 
-		if (mHitsInCurrentSession <= 0) {
-			hit->mSessionControl = GAHit::SessionControl::Start;
+		if (hitIndex <= 0) {
+			hit.mSessionControl = GAHit::SessionControl::Start;
 			CI_LOG_V("Starting a new session");
 		}
 
-		mHitsInCurrentSession++;
-
-		if (mHitsInCurrentSession >= mMaxHitsPerSession) {
-			hit->mSessionControl = GAHit::SessionControl::End;
-			CI_LOG_V("Ended session after " << to_string(mHitsInCurrentSession) << " hits");
-			mHitsInCurrentSession = 0;
+		if (hitIndex + 1 >= maxHitsPerSession) {
+			hit.mSessionControl = GAHit::SessionControl::End;
+			CI_LOG_V("Ended session after " << to_string(hitIndex + 1) << " hits");
 		}
 	}
+}
 
-	mThreadManager->addTask([=] {
-		lock_guard<mutex> lock(mBatchMutex);
+void AnalyticsClient::pushEncodedHit(GAEncodedHit && encodedHit) {
+	const size_t hitSize = encodedHit.parameters.size();
+	const utils::HitJournalRef journal = getJournal();
+
+	// write ahead before the hit is handed off, so it's recovered after a crash once the journal is synced.
+	// Hits tracked before the journal has been opened are journaled when they're assembled instead.
+	if (journal) {
+		const int64_t hitUnixTimeMs = getUnixTimeMs() - (int64_t)round((utils::getElapsedSeconds() - encodedHit.timestamp) * 1000.0);
+		encodedHit.journalId = journal->append(hitUnixTimeMs, encodedHit.parameters);
+	}
+
+	// hand hit off to the next processing cycle without locking
+	if (!mIncomingHits.tryPush(std::move(encodedHit))) {
+		lock_guard<mutex> lock(mOverflowMutex);
+		mOverflowHits.push_back(std::move(encodedHit));
+	}
+
+	mNumHitsTracked.fetch_add(1, memory_order_relaxed);
+	const int numUnbatchedHits = ++mNumUnbatchedHits;
+	const size_t numIncomingBytes = mNumIncomingBytes.fetch_add(hitSize);
+	const size_t batchSize = mCurrentBatchSize + numIncomingBytes;
+
+	if (mDispatchMode != EVENT_DRIVEN) {
+		return;
+	}
+
+	// only wake up a worker when this hit starts a new batch (to age it) or fills the current one
+	const bool isBatchFull = numUnbatchedHits == GABatch::MAX_NUM_HITS ||
+		(batchSize < GABatch::MAX_BATCH_SIZE && batchSize + hitSize >= GABatch::MAX_BATCH_SIZE);
+
+	if (isBatchFull) {
+		requestProcessing(0.0);
+	} else if (numIncomingBytes == 0 && journal) {
+		// the journal is synced by processing cycles, so don't leave new hits unsynced for longer than a sync interval
+		requestProcessing(min(mJournalSyncInterval, (double)mCurrentMaxBatchAge));
+	} else if (numUnbatchedHits == 1) {
+		requestProcessing(mCurrentMaxBatchAge);
+	}
+}
+
+void AnalyticsClient::assembleBatches() {
+	const double currentTime = utils::getElapsedSeconds();
+	const int64_t currentUnixTimeMs = getUnixTimeMs();
+	const utils::HitJournalRef journal = getJournal();
+
+	const auto addHit = [&](GAEncodedHit & hit) {
+		if (journal && hit.journalId == 0) {
+			const int64_t hitUnixTimeMs = currentUnixTimeMs - (int64_t)round((currentTime - hit.timestamp) * 1000.0);
+			hit.journalId = journal->append(hitUnixTimeMs, hit.parameters);
+		}
+		if (hit.journalId != 0) {
+			mIsJournalDirty = true;
+		}
 
 		// ensure we have a batch that can fit our hit
 		if (!mCurrentBatch || !mCurrentBatch->canAddHit(hit)) {
 
 			if (mCurrentBatch) {
 				// buffer current batch for sending
-				mBatchQueue.push_back(mCurrentBatch);
+				queueCurrentBatch();
 			}
 
 			// new batch
 			mCurrentBatch = make_shared<GABatch>();
-
 		}
 
 		mCurrentBatch->addHit(hit);
-	});
+	};
+
+	mNumIncomingBytes = 0;
+
+	size_t numHits = 0;
+
+	GAEncodedHit hit;
+	while (mIncomingHits.tryPop(hit)) {
+		addHit(hit);
+		numHits++;
+	}
+
+	deque<GAEncodedHit> overflowHits;
+	{
+		lock_guard<mutex> lock(mOverflowMutex);
+		overflowHits.swap(mOverflowHits);
+	}
+
+	if (!overflowHits.empty()) {
+		CI_LOG_W("Hit buffer overflowed by " << to_string(overflowHits.size()) << " hits");
+		for (auto & overflowHit : overflowHits) {
+			addHit(overflowHit);
+		}
+		numHits += overflowHits.size();
+	}
+
+	if (numHits > 0) {
+		mBatchAgeController->addHits(numHits, currentTime);
+	}
+
+	mCurrentBatchSize = mCurrentBatch ? mCurrentBatch->getPayloadSize() : 0;
 }
 
-void AnalyticsClient::processBatches() {
+void AnalyticsClient::queueCurrentBatch() {
+	mCurrentBatch->compact();
+	mNumUnbatchedHits -= (int)mCurrentBatch->numHits();
+
+	// keep spilled hits in order by spilling anything newer as well
+	if (mNumSpilledHits == 0 || !spillBatch(mCurrentBatch)) {
+		pushQueuedBatch(mCurrentBatch, false);
+	}
 
+	mCurrentBatchSize = 0;
+	mCurrentBatch = nullptr;
+}
+
+void AnalyticsClient::replayJournal() {
 	lock_guard<mutex> lock(mBatchMutex);
 
-	// check if we should send the current batch
-	if (mCurrentBatch && (mCurrentBatch->isFull() || mCurrentBatch->getAge() >= mMaxBatchAge)) {
-		mBatchQueue.push_back(mCurrentBatch);
-		mCurrentBatch = nullptr;
+	mIsReplayingJournal = false;
+
+	// process anything that was queued while replaying (runs once we release the lock)
+	requestProcessing(0.0);
+
+	const utils::HitJournalRef journal = getJournal();
+
+	if (!journal || !journal->open(mJournalDirectory)) {
+		return;
 	}
 
-	const double currentTime = getElapsedSeconds();
-	const int maxBatchesToSend = min((int)mBatchQueue.size(), mMaxBatchesPerCycle);
-	int numHitsSent = 0;
-	int numBatchesSent = 0;
+	const vector<utils::HitJournal::Record> records = journal->readPendingRecords();
 
-	// process batch queue and send as many as we can
-	for (int i = 0; i < maxBatchesToSend; ++i) {
-		auto batch = mBatchQueue.front();
+	if (records.empty()) {
+		return;
+	}
 
-		const double timeSinceLastAttempt = currentTime - batch->getTimeOfLastSendAttempt();
-		if (timeSinceLastAttempt < batch->getDelayUntilNextSendAttempt()) {
-			continue; // wait until we can try again
+	const double currentTime = utils::getElapsedSeconds();
+	const int64_t currentUnixTimeMs = getUnixTimeMs();
+
+	deque<GABatchRef> batches;
+
+	for (const auto & record : records) {
+		// restore timestamp relative to this session so that queue time stays accurate
+		const double timestamp = currentTime - (double)(currentUnixTimeMs - record.timestampMs) / 1000.0;
+		const GAEncodedHit hit(timestamp, record.payload, mCacheBusterEnabled, record.id);
+
+		if (batches.empty() || !batches.back()->canAddHit(hit)) {
+			if (!batches.empty()) batches.back()->compact();
+			batches.push_back(make_shared<GABatch>());
 		}
 
-		// send batch
-		sendBatch(batch);
+		batches.back()->addHit(hit);
+	}
+
+	// replayed hits are older than anything tracked in this session, so send them first
+	for (auto it = batches.rbegin(); it != batches.rend(); ++it) {
+		pushQueuedBatch(*it, true);
+	}
+
+	CI_LOG_I("Replaying " << to_string(records.size()) << " hits in " << to_string(batches.size()) << " batches from journal");
+}
+
+void AnalyticsClient::processBatches() {
+
+	unique_lock<mutex> lock(mBatchMutex);
+
+	if (mIsReplayingJournal) {
+		return;
+	}
+
+	// collect all hits tracked since the last cycle
+	assembleBatches();
+
+	// bring back spilled hits once the queue has drained
+	reloadSpilledBatches();
+
+	const double currentTime = utils::getElapsedSeconds();
+
+	updateBatchAge(currentTime);
+
+	// check if we should send the current batch
+
+	if (mCurrentBatch && (mCurrentBatch->isFull() || mCurrentBatch->getAge() >= mCurrentMaxBatchAge)) {
+		queueCurrentBatch();
+	}
+
+	processFlushes(currentTime);
+
+	// send everything that's ready while flushing
+	const int maxBatchesToSend = mFlushes.empty() ? mMaxBatchesPerCycle : (int)mBatchQueue.size();
+	int numHitsSent = 0;
+	int numBatchesSent = 0;
+	vector<GABatchRef> batchesToSend;
+
+	auto sendQueuedBatch = [&](deque<GABatchRef>::iterator it) {
+		auto batch = *it;
+		batch->setTimeOfLastSend(currentTime);
+		mBatchesInFlight.insert(batch);
+		batchesToSend.push_back(batch);
 
 		numBatchesSent++;
 		numHitsSent += (int)batch->numHits();
 
-		// remove batch
-		mBatchQueue.pop_front();
+		return eraseQueuedBatch(it);
+	};
+
+	// while the circuit breaker is open, everything is held back except for a single probe
+	uint64_t probeId = 0;
+	const utils::CircuitBreaker::Permission permission = mBatchQueue.empty() ? utils::CircuitBreaker::DENY : mCircuitBreaker->requestPermission(currentTime, &probeId);
+
+	if (permission == utils::CircuitBreaker::ALLOW_PROBE) {
+		// probe with the smallest batch; the circuit breaker's backoff applies instead of the batch's own retry delay
+		auto probeIt = min_element(mBatchQueue.begin(), mBatchQueue.end(), [](const GABatchRef & a, const GABatchRef & b) {
+			return a->getPayloadSize() < b->getPayloadSize();
+		});
+		CI_LOG_I("Probing connection with a batch of " << to_string((*probeIt)->numHits()) << " hits");
+		mProbeBatch = *probeIt;
+		mProbeId = probeId;
+		sendQueuedBatch(probeIt);
+
+	} else if (permission == utils::CircuitBreaker::ALLOW_ALL) {
+		// process batch queue and send as many as we can
+		for (auto it = mBatchQueue.begin(); it != mBatchQueue.end() && numBatchesSent < maxBatchesToSend;) {
+			const double timeSinceLastAttempt = currentTime - (*it)->getTimeOfLastSendAttempt();
+			if (timeSinceLastAttempt < (*it)->getDelayUntilNextSendAttempt()) {
+				++it;
+				continue; // wait until we can try again
+			}
+
+			it = sendQueuedBatch(it);
+		}
 	}
 
+	mNumBatchesInFlight = mBatchesInFlight.size();
+
+	sendBatches(batchesToSend);
+
 	if (numBatchesSent > 0) {
 		CI_LOG_V("Sending " << to_string(numBatchesSent) << " batches with a total of " <<
 				 to_string(numHitsSent) << " hits (" << to_string(mBatchQueue.size()) << " batches remaining)");
 	}
+
+	// amortize disk syncs over many hits
+	const utils::HitJournalRef journal = getJournal();
+	if (journal && currentTime - mTimeOfLastJournalSync >= mJournalSyncInterval) {
+		journal->sync();
+		mTimeOfLastJournalSync = currentTime;
+		mIsJournalDirty = false;
+	}
+
+	scheduleNextProcessing(currentTime);
+
+	lock.unlock();
+	checkStatsThresholds();
+}
+
+void AnalyticsClient::updateBatchAge(const double currentTime) {
+	const utils::BatchAgeController::Decision decision = mBatchAgeController->update(currentTime);
+
+	if (mTargetDeliveryLatency > 0.0) {
+		if (abs(decision.maxBatchAge - mCurrentMaxBatchAge) > 0.001) {
+			CI_LOG_V("Max batch age is now " << to_string(decision.maxBatchAge) << "s at " << to_string(decision.hitRate) << " hits/s");
+		}
+		mCurrentMaxBatchAge = decision.maxBatchAge;
+	}
+}
+
+utils::BatchAgeController::Decision AnalyticsClient::getBatchingDecision() const {
+	utils::BatchAgeController::Decision decision = mBatchAgeController->getDecision();
+
+	if (mTargetDeliveryLatency <= 0.0) {
+		decision.maxBatchAge = mCurrentMaxBatchAge;
+		decision.expectedHitsPerBatch = min((double)GABatch::MAX_NUM_HITS, 1.0 + decision.hitRate * decision.maxBatchAge);
+	}
+
+	return decision;
+}
+
+void AnalyticsClient::scheduleNextProcessing(const double currentTime) {
+	if (mDispatchMode != EVENT_DRIVEN) {
+		return;
+	}
+
+	double delay = numeric_limits<double>::max();
+
+	// current batch reaches its max age
+	if (mCurrentBatch && !mCurrentBatch->isEmpty()) {
+		delay = min(delay, mCurrentMaxBatchAge - mCurrentBatch->getAge());
+	}
+
+	if (!mBatchQueue.empty()) {
+		switch (mCircuitBreaker->getState()) {
+			case utils::CircuitBreaker::CLOSED:
+				// retry delay of a queued batch elapses; batches that are ready but exceeded the per-cycle limit go out next cycle
+				for (const auto & batch : mBatchQueue) {
+					const double timeUntilNextAttempt = batch->getTimeOfLastSendAttempt() + batch->getDelayUntilNextSendAttempt() - currentTime;
+					delay = min(delay, max(timeUntilNextAttempt, mMinDispatchInterval));
+				}
+				break;
+
+			case utils::CircuitBreaker::OPEN:
+				// next probe is due
+				delay = min(delay, mCircuitBreaker->getTimeOfNextProbe() - currentTime);
+				break;
+
+			case utils::CircuitBreaker::HALF_OPEN:
+				// the probe's completion requests processing
+				break;
+		}
+	}
+
+	// spilled hits can be queued again
+	if (mNumSpilledHits > 0 && hasQueueRoomFor(GABatch::MAX_NUM_HITS, GABatch::MAX_BATCH_SIZE)) {
+		delay = min(delay, mMinDispatchInterval);
+	}
+
+	// flush expires
+	for (const auto & flush : mFlushes) {
+		delay = min(delay, flush->deadline - currentTime);
+	}
+
+	// journal needs to be synced
+	if (mIsJournalDirty && getJournal()) {
+		delay = min(delay, mTimeOfLastJournalSync + mJournalSyncInterval - currentTime);
+	}
+
+	if (delay < numeric_limits<double>::max()) {
+		requestProcessing(max(delay, 0.0));
+	}
+}
+
+void AnalyticsClient::requestProcessing(const double delay) {
+	if (!mIsSetUp || mDispatchMode != EVENT_DRIVEN) {
+		return;
+	}
+
+	lock_guard<mutex> lock(mDispatchMutex);
+
+	const double time = utils::getElapsedSeconds() + delay;
+
+	if (mScheduledProcessingTaskId != utils::ThreadManager::INVALID_TASK_ID) {
+		if (mScheduledProcessingTime <= time) {
+			return; // already scheduled to run sooner
+		}
+		mThreadManager->cancelTask(mScheduledProcessingTaskId);
+	}
+
+	mScheduledProcessingTime = time;
+	mScheduledProcessingTaskId = mThreadManager->addDelayedTask([this] {
+		{
+			// anything requested from here on needs another cycle
+			lock_guard<mutex> lock(mDispatchMutex);
+			mScheduledProcessingTaskId = utils::ThreadManager::INVALID_TASK_ID;
+		}
+		processBatches();
+	}, delay, mDispatchLane);
+}
+
+void AnalyticsClient::processFlushes(const double currentTime) {
+	for (auto it = mFlushes.begin(); it != mFlushes.end();) {
+		FlushOperationRef flush = *it;
+
+		if (!flush->isStarted) {
+			// include the current batch and everything queued or in flight
+			if (mCurrentBatch && !mCurrentBatch->isEmpty()) {
+				queueCurrentBatch();
+			}
+			flush->outstandingBatches.insert(mBatchQueue.begin(), mBatchQueue.end());
+			flush->outstandingBatches.insert(mBatchesInFlight.begin(), mBatchesInFlight.end());
+			flush->isStarted = true;
+		}
+
+		const bool isExpired = currentTime >= flush->deadline;
+
+		if (flush->outstandingBatches.empty() || isExpired) {
+			for (const auto & batch : flush->outstandingBatches) {
+				flush->result.numHitsAbandoned += batch->numHits();
+			}
+			flush->promise.set_value(flush->result);
+			it = mFlushes.erase(it);
+
+		} else {
+			++it;
+		}
+	}
+}
+
+void AnalyticsClient::sendBatches(const std::vector<GABatchRef> & batches) {
+	const size_t pipelineDepth = (size_t)max(1, mMaxPipelineDepth);
+
+	for (size_t i = 0; i < batches.size(); i += pipelineDepth) {
+		const size_t numBatches = min(pipelineDepth, batches.size() - i);
+
+		if (numBatches == 1) {
+			sendBatch(batches[i]);
+		} else {
+			sendPipelinedBatches(vector<GABatchRef>(batches.begin() + i, batches.begin() + i + numBatches));
+		}
+	}
 }
 
 void AnalyticsClient::sendBatch(GABatchRef batch) {
-	mThreadManager->addTask([=] {
-		const string body = batch->getPayloadString();
-		
+	const weak_ptr<AnalyticsClient> weakSelf = mWeakSelf;
+
+	const auto send = [=] {
+		// the batch stays alive and unchanged while it's in flight, so the request can send its payload without copying it
 		utils::UrlRequest::Options options;
 		options.method = utils::UrlRequest::Method::POST;
-		options.setBodyText(body);
-		utils::UrlRequestRef request = utils::UrlRequest::create(mGaBaseUrl, mGaBatchUri, options);
+		options.sharedBody = shared_ptr<const string>(batch, &batch->updatePayload());
+		options.header = getBatchRequestHeader();
+		options.connectionPool = mConnectionPool;
+		utils::UrlRequestRef request = utils::UrlRequest::create(mEventLoop->getIoService(), mGaBaseUrl, mGaBatchUri, options);
 		
 		// save and send request
 		lock_guard<mutex> lock(mRequestMutex);
 		mPendingRequests.insert(request);
 		request->connect([=] (utils::UrlRequestRef request) {
-			handleBatchRequestCompleted(batch, request);
-		});
-	});
+			if (AnalyticsClientRef self = weakSelf.lock()) {
+				self->handleBatchRequestCompleted(batch, request);
+			}
+		}, mGaPort);
+	};
+
+	if (mThreadManager->getNumThreads() > 0) {
+		mThreadManager->addTask(send, mSerializationLane);
+	} else {
+		send(); // workers have already been shut down (e.g. while draining during app cleanup)
+	}
+}
+
+void AnalyticsClient::sendPipelinedBatches(std::vector<GABatchRef> batches) {
+	const weak_ptr<AnalyticsClient> weakSelf = mWeakSelf;
+
+	const auto send = [=] {
+		utils::UrlRequestPipelineRef pipeline = utils::UrlRequestPipeline::create(mEventLoop->getIoService(), mGaBaseUrl, mConnectionPool);
+
+		const utils::HttpRequestHeaderRef header = getBatchRequestHeader();
+
+		for (const auto & batch : batches) {
+			utils::UrlRequest::Options options;
+			options.method = utils::UrlRequest::Method::POST;
+			options.sharedBody = shared_ptr<const string>(batch, &batch->updatePayload());
+			options.header = header;
+			pipeline->addRequest(mGaBatchUri, std::move(options));
+		}
+
+		// save and send pipeline
+		lock_guard<mutex> lock(mRequestMutex);
+		mPendingPipelines.insert(pipeline);
+		pipeline->connect([=] (utils::UrlRequestPipelineRef pipeline) {
+			if (AnalyticsClientRef self = weakSelf.lock()) {
+				self->handleBatchPipelineCompleted(batches, pipeline);
+			}
+		}, mGaPort);
+	};
+
+	if (mThreadManager->getNumThreads() > 0) {
+		mThreadManager->addTask(send, mSerializationLane);
+	} else {
+		send();
+	}
+}
+
+utils::HttpRequestHeaderRef AnalyticsClient::getBatchRequestHeader() {
+	lock_guard<mutex> lock(mRequestMutex);
+
+	if (!mBatchRequestHeader || mBatchRequestHeader->getHost() != mGaBaseUrl || mBatchRequestHeader->getUri() != mGaBatchUri) {
+		utils::UrlRequest::Options options;
+		options.method = utils::UrlRequest::Method::POST;
+		mBatchRequestHeader = utils::UrlRequest::createRequestHeader(mGaBaseUrl, mGaBatchUri, options, true);
+	}
+
+	return mBatchRequestHeader;
 }
 
 void AnalyticsClient::handleBatchRequestCompleted(GABatchRef batch, utils::UrlRequestRef request) {
-	if (!request || !request->wasSuccessful()) {
+	const bool wasSuccessful = request && request->wasSuccessful();
+	string reason = "(unknown reason)";
+	if (request) {
+		reason = request->getHttpResponse().hasHeader() ? request->getHttpResponse().getReason() : request->getError();
+	}
 
-		// increase delay until next attempt
-		batch->setTimeOfLastSendAttempt(getElapsedSeconds());
-		batch->increaseDelayUntilNextSendAttempt();
-		
-		const string reason = request ? request->getHttpResponse().getReason() : "(unknown reason)";
-		CI_LOG_W("Batch failed to send: " << reason <<
-				 " - attempting again in " << to_string(batch->getDelayUntilNextSendAttempt()) << " seconds");
+	completeBatch(batch, wasSuccessful, reason);
 
-		// push batch back onto queue to retry
+	const weak_ptr<AnalyticsClient> weakSelf = mWeakSelf;
+	mEventLoop->getIoService().post([weakSelf, request] {
+		// discard request asynchronously (can't remove it directly from our callback)
+		if (AnalyticsClientRef self = weakSelf.lock()) {
+			lock_guard<mutex> lock(self->mRequestMutex);
+			self->mPendingRequests.erase(request);
+		}
+	});
+}
+
+void AnalyticsClient::handleBatchPipelineCompleted(std::vector<GABatchRef> batches, utils::UrlRequestPipelineRef pipeline) {
+	const size_t numResponses = pipeline->getNumResponses();
+
+	for (size_t i = 0; i < numResponses && i < batches.size(); ++i) {
+		completeBatch(batches[i], pipeline->wasSuccessful(i), pipeline->getHttpResponse(i).getReason());
+	}
+
+	if (numResponses < batches.size()) {
+		if (numResponses == 0) {
+			// nothing got through, so treat this like any other failed request
+			const string error = pipeline->getError();
+			for (size_t i = 0; i < batches.size(); ++i) {
+				completeBatch(batches[i], false, error.empty() ? "Connection failed" : error);
+			}
+
+		} else {
+			// the connection was closed mid-pipeline (e.g. by a per-connection request limit); the remaining
+			// batches weren't rejected, so requeue them in order without backing off
+			lock_guard<mutex> lock(mBatchMutex);
+			for (size_t i = batches.size(); i-- > numResponses;) {
+				mBatchesInFlight.erase(batches[i]);
+				pushQueuedBatch(batches[i], true);
+				mNumHitsRetried += batches[i]->numHits();
+			}
+			mNumBatchesInFlight = mBatchesInFlight.size();
+			CI_LOG_V("Pipeline closed after " << to_string(numResponses) << " of " << to_string(batches.size()) << " responses; requeued remaining batches");
+			requestProcessing(mMinDispatchInterval);
+		}
+	}
+
+	const weak_ptr<AnalyticsClient> weakSelf = mWeakSelf;
+	mEventLoop->getIoService().post([weakSelf, pipeline] {
+		// discard pipeline asynchronously (can't remove it directly from our callback)
+		if (AnalyticsClientRef self = weakSelf.lock()) {
+			lock_guard<mutex> lock(self->mRequestMutex);
+			self->mPendingPipelines.erase(pipeline);
+		}
+	});
+}
+
+void AnalyticsClient::cancelPendingRequests() {
+	set<utils::UrlRequestRef> requests;
+	set<utils::UrlRequestPipelineRef> pipelines;
+	{
+		lock_guard<mutex> lock(mRequestMutex);
+		requests.swap(mPendingRequests);
+		pipelines.swap(mPendingPipelines);
+	}
+
+	// cancel outside of mRequestMutex; a request that's currently calling back holds its own lock until it's done
+	for (const auto & request : requests) {
+		request->cancel();
+	}
+	for (const auto & pipeline : pipelines) {
+		pipeline->cancel();
+	}
+}
+
+void AnalyticsClient::completeBatch(GABatchRef batch, const bool wasSuccessful, const std::string & failureReason) {
+	bool isFlushing = false;
+	uint64_t probeId = 0;
+
+	{
 		lock_guard<mutex> lock(mBatchMutex);
+		mBatchesInFlight.erase(batch);
+		mNumBatchesInFlight = mBatchesInFlight.size();
+
+		if (batch == mProbeBatch) {
+			probeId = mProbeId;
+			mProbeBatch = nullptr;
+		}
+
+		if (wasSuccessful) {
+			// the outage (if any) is over
+			mIsQueueOverflowing = false;
+			mNumSampledBatches = 0;
+
+			for (auto & flush : mFlushes) {
+				if (flush->outstandingBatches.erase(batch) > 0) {
+					flush->result.numHitsDelivered += batch->numHits();
+				}
+			}
+		}
+
+		isFlushing = !mFlushes.empty();
+	}
+
+	if (isFlushing) {
+		// let flushes complete or send the next batches right away
+		requestProcessing(0.0);
+	}
+
+	if (!wasSuccessful) {
+		const double currentTime = utils::getElapsedSeconds();
+		const utils::CircuitBreaker::State previousState = mCircuitBreaker->recordFailure(currentTime, probeId);
+		const bool isCircuitOpen = !mCircuitBreaker->isClosed();
+
+		batch->setTimeOfLastSendAttempt(currentTime);
+
+		if (previousState == utils::CircuitBreaker::CLOSED) {
+			// increase delay until next attempt; failed probes and requests that were in flight
+			// when the circuit opened are covered by the circuit breaker's backoff instead
+			batch->increaseDelayUntilNextSendAttempt();
+		}
+
+		const double retryDelay = isCircuitOpen ? max(0.0, mCircuitBreaker->getTimeOfNextProbe() - currentTime) : batch->getDelayUntilNextSendAttempt();
+
+		mNumBatchesFailed.fetch_add(1, memory_order_relaxed);
+		mNumHitsRetried.fetch_add(batch->numHits(), memory_order_relaxed);
+		mCurrentBackoff = retryDelay;
+
+		if (previousState == utils::CircuitBreaker::CLOSED && isCircuitOpen) {
+			CI_LOG_W("Batch failed to send: " << failureReason << " - pausing all sends after " <<
+					 to_string(mCircuitBreaker->getNumConsecutiveFailures()) << " consecutive failures; probing again in " << to_string(retryDelay) << " seconds");
+
+		} else if (previousState == utils::CircuitBreaker::HALF_OPEN) {
+			CI_LOG_W("Probe failed: " << failureReason << " - probing again in " << to_string(retryDelay) << " seconds");
+
+		} else if (previousState == utils::CircuitBreaker::OPEN) {
+			CI_LOG_V("Batch failed to send while sends are paused: " << failureReason);
+
+		} else {
+			CI_LOG_W("Batch failed to send: " << failureReason <<
+					 " - attempting again in " << to_string(retryDelay) << " seconds");
+		}
+
+		// push batch back onto queue to retry
+		{
+			lock_guard<mutex> lock(mBatchMutex);
+			pushQueuedBatch(batch, true);
+		}
+
+		requestProcessing(retryDelay);
+
+	} else {
+		if (mCircuitBreaker->recordSuccess() != utils::CircuitBreaker::CLOSED) {
+			CI_LOG_I("Connection restored; resuming sends");
+			requestProcessing(0.0);
+		}
+
+		mNumBatchesSent.fetch_add(1, memory_order_relaxed);
+		mNumHitsSent.fetch_add(batch->numHits(), memory_order_relaxed);
+		mCurrentBackoff = 0.0;
+		mTimeOfLastSuccess = utils::getElapsedSeconds();
+
+		mBatchAgeController->addRequestLatency(mTimeOfLastSuccess - batch->getTimeOfLastSend());
+		mBatchAgeController->addDeliveryLatency(batch->getAge());
+
+		if (const utils::HitJournalRef journal = getJournal()) {
+			// delivered; remove hits from journal
+			journal->acknowledge(batch->getJournalIds());
+		}
+	}
+}
+
+void AnalyticsClient::pushQueuedBatch(GABatchRef batch, const bool toFront) {
+	if (toFront) {
 		mBatchQueue.push_front(batch);
+	} else {
+		mBatchQueue.push_back(batch);
 	}
+	mNumQueuedBatches = mBatchQueue.size();
+	mNumQueuedHits += batch->numHits();
+	mNumQueuedBytes += batch->getPayloadSize();
 
-	AppBase::get()->dispatchAsync([=] {
-		// discard request asynchronously (can't remove it directly from our callback)
-		lock_guard<mutex> lock(mRequestMutex);
-		auto it = mPendingRequests.find(request);
-		if (it != mPendingRequests.end()) {
-			mPendingRequests.erase(it);
+	if (isQueueOverBudget()) {
+		handleQueueOverflow(toFront);
+	}
+}
+
+std::deque<GABatchRef>::iterator AnalyticsClient::eraseQueuedBatch(std::deque<GABatchRef>::iterator it) {
+	mNumQueuedHits -= (*it)->numHits();
+	mNumQueuedBytes -= (*it)->getPayloadSize();
+	it = mBatchQueue.erase(it);
+	mNumQueuedBatches = mBatchQueue.size();
+	return it;
+}
+
+void AnalyticsClient::clearBatchQueue() {
+	mBatchQueue.clear();
+	mNumQueuedBatches = 0;
+	mNumQueuedHits = 0;
+	mNumQueuedBytes = 0;
+}
+
+bool AnalyticsClient::isQueueOverBudget() const {
+	return (mMaxQueuedHits > 0 && mNumQueuedHits > mMaxQueuedHits) ||
+		(mMaxQueuedBytes > 0 && mNumQueuedBytes > mMaxQueuedBytes);
+}
+
+bool AnalyticsClient::hasQueueRoomFor(const size_t numHits, const size_t numBytes) const {
+	return (mMaxQueuedHits == 0 || mNumQueuedHits + numHits <= mMaxQueuedHits) &&
+		(mMaxQueuedBytes == 0 || mNumQueuedBytes + numBytes <= mMaxQueuedBytes);
+}
+
+void AnalyticsClient::handleQueueOverflow(const bool isRetry) {
+	if (!mIsQueueOverflowing) {
+		CI_LOG_W("Batch queue exceeded its budget with " << to_string(mNumQueuedHits) << " hits (" << to_string(mNumQueuedBytes) << " bytes) queued");
+		mIsQueueOverflowing = true;
+	}
+
+	OverflowPolicy policy = mOverflowPolicy;
+
+	if (policy == SPILL_TO_DISK && !mSpillQueue) {
+		policy = DROP_OLDEST;
+	}
+
+	switch (policy) {
+		case DROP_NEWEST:
+			while (isQueueOverBudget() && !mBatchQueue.empty()) {
+				dropQueuedBatch(mBatchQueue.end() - 1);
+			}
+			break;
+
+		case SAMPLE:
+			if (!isRetry) {
+				// reservoir sampling: the n-th batch offered during this overflow is kept with a probability of capacity / n,
+				// in which case it replaces a random batch. This keeps an even sample across the whole outage.
+				mNumSampledBatches = max(mNumSampledBatches + 1, mBatchQueue.size());
+				const size_t capacity = mBatchQueue.size() - 1;
+				const bool isKept = uniform_int_distribution<size_t>(0, mNumSampledBatches - 1)(mRandom) < capacity;
+
+				if (isKept && capacity > 0) {
+					dropQueuedBatch(mBatchQueue.begin() + uniform_int_distribution<size_t>(0, capacity - 1)(mRandom));
+				} else {
+					dropQueuedBatch(mBatchQueue.end() - 1);
+				}
+			}
+			while (isQueueOverBudget() && !mBatchQueue.empty()) {
+				dropQueuedBatch(mBatchQueue.begin() + uniform_int_distribution<size_t>(0, mBatchQueue.size() - 1)(mRandom));
+			}
+			break;
+
+		case SPILL_TO_DISK:
+			while (isQueueOverBudget() && !mBatchQueue.empty()) {
+				GABatchRef newestBatch = mBatchQueue.back();
+				if (spillBatch(newestBatch)) {
+					eraseQueuedBatch(mBatchQueue.end() - 1);
+					abandonBatch(newestBatch);
+				} else {
+					dropQueuedBatch(mBatchQueue.end() - 1);
+				}
+			}
+			break;
+
+		case DROP_OLDEST:
+		default:
+			while (isQueueOverBudget() && !mBatchQueue.empty()) {
+				dropQueuedBatch(mBatchQueue.begin());
+			}
+			break;
+	}
+}
+
+std::deque<GABatchRef>::iterator AnalyticsClient::dropQueuedBatch(std::deque<GABatchRef>::iterator it) {
+	GABatchRef batch = *it;
+
+	mNumHitsDropped += batch->numHits();
+	CI_LOG_V("Dropped batch with " << to_string(batch->numHits()) << " hits");
+
+	if (const utils::HitJournalRef journal = getJournal()) {
+		// dropped on purpose, so don't replay these hits after a restart
+		journal->acknowledge(batch->getJournalIds());
+	}
+
+	abandonBatch(batch);
+
+	return eraseQueuedBatch(it);
+}
+
+bool AnalyticsClient::spillBatch(GABatchRef batch) {
+	if (!mSpillQueue) {
+		return false;
+	}
+
+	const double currentTime = utils::getElapsedSeconds();
+	const int64_t currentUnixTimeMs = getUnixTimeMs();
+
+	vector<utils::SpillQueue::Record> records;
+	for (auto & hit : batch->getEncodedHits()) {
+		utils::SpillQueue::Record record;
+		record.timestampMs = currentUnixTimeMs - (int64_t)round((currentTime - hit.timestamp) * 1000.0);
+		record.journalId = hit.journalId;
+		record.cacheBuster = hit.cacheBuster;
+		record.payload = std::move(hit.parameters);
+		records.push_back(std::move(record));
+	}
+
+	if (!mSpillQueue->push(records)) {
+		return false;
+	}
+
+	mNumSpilledHits += records.size();
+	return true;
+}
+
+void AnalyticsClient::reloadSpilledBatches() {
+	if (!mSpillQueue || mNumSpilledHits == 0) {
+		return;
+	}
+
+	const double currentTime = utils::getElapsedSeconds();
+	const int64_t currentUnixTimeMs = getUnixTimeMs();
+
+	while (mNumSpilledHits > 0 && hasQueueRoomFor(GABatch::MAX_NUM_HITS, GABatch::MAX_BATCH_SIZE)) {
+		const vector<utils::SpillQueue::Record> records = mSpillQueue->pop(GABatch::MAX_NUM_HITS);
+
+		if (records.empty()) {
+			CI_LOG_W("Lost " << to_string(mNumSpilledHits) << " spilled hits");
+			mNumHitsDropped += mNumSpilledHits;
+			mNumSpilledHits = 0;
+			break;
 		}
-	});
+
+		mNumSpilledHits -= min(mNumSpilledHits.load(), records.size());
+
+		GABatchRef batch = make_shared<GABatch>();
+
+		for (const auto & record : records) {
+			const double timestamp = currentTime - (double)(currentUnixTimeMs - record.timestampMs) / 1000.0;
+			const GAEncodedHit hit(timestamp, record.payload, record.cacheBuster, record.journalId);
+
+			if (!batch->canAddHit(hit)) {
+				batch->compact();
+				pushQueuedBatch(batch, false);
+				batch = make_shared<GABatch>();
+			}
+
+			batch->addHit(hit);
+		}
+
+		batch->compact();
+		pushQueuedBatch(batch, false);
+	}
+}
+
+void AnalyticsClient::abandonBatch(GABatchRef batch) {
+	for (auto & flush : mFlushes) {
+		if (flush->outstandingBatches.erase(batch) > 0) {
+			flush->result.numHitsAbandoned += batch->numHits();
+		}
+	}
+}
+
+//==================================================
+// Stats
+// 
+
+AnalyticsClient::Stats AnalyticsClient::getStats() const {
+	Stats stats;
+	stats.numHitsTracked = mNumHitsTracked.load(memory_order_relaxed);
+	stats.numHitsSent = mNumHitsSent.load(memory_order_relaxed);
+	stats.numHitsRetried = mNumHitsRetried.load(memory_order_relaxed);
+	stats.numHitsDropped = mNumHitsDropped.load(memory_order_relaxed);
+	stats.numBatchesSent = mNumBatchesSent.load(memory_order_relaxed);
+	stats.numBatchesFailed = mNumBatchesFailed.load(memory_order_relaxed);
+	stats.numHitsPending = (size_t)max(0, mNumUnbatchedHits.load(memory_order_relaxed));
+	stats.numQueuedHits = mNumQueuedHits.load(memory_order_relaxed);
+	stats.numQueuedBatches = mNumQueuedBatches.load(memory_order_relaxed);
+	stats.numQueuedBytes = mNumQueuedBytes.load(memory_order_relaxed);
+	stats.numBatchesInFlight = mNumBatchesInFlight.load(memory_order_relaxed);
+	stats.numSpilledHits = mNumSpilledHits.load(memory_order_relaxed);
+	stats.currentBackoff = mCurrentBackoff.load(memory_order_relaxed);
+	stats.timeSinceLastSuccess = mIsSetUp ? utils::getElapsedSeconds() - mTimeOfLastSuccess.load(memory_order_relaxed) : 0.0;
+	stats.isCircuitOpen = !mCircuitBreaker->isClosed();
+	return stats;
+}
+
+AnalyticsClient::StatsThresholdId AnalyticsClient::addStatsThreshold(StatsCondition condition, StatsCallback callback) {
+	lock_guard<mutex> lock(mStatsThresholdMutex);
+	StatsThreshold threshold;
+	threshold.id = mNextStatsThresholdId++;
+	threshold.condition = condition;
+	threshold.callback = callback;
+	mStatsThresholds.push_back(threshold);
+	return threshold.id;
+}
+
+void AnalyticsClient::removeStatsThreshold(const StatsThresholdId id) {
+	lock_guard<mutex> lock(mStatsThresholdMutex);
+	mStatsThresholds.erase(remove_if(mStatsThresholds.begin(), mStatsThresholds.end(), [id] (const StatsThreshold & threshold) {
+		return threshold.id == id;
+	}), mStatsThresholds.end());
+}
+
+void AnalyticsClient::checkStatsThresholds() {
+	vector<StatsCallback> callbacks;
+	Stats stats;
+
+	{
+		lock_guard<mutex> lock(mStatsThresholdMutex);
+
+		if (mStatsThresholds.empty()) {
+			return;
+		}
+
+		stats = getStats();
+
+		for (auto & threshold : mStatsThresholds) {
+			const bool isExceeded = threshold.condition && threshold.condition(stats);
+			if (isExceeded && !threshold.isExceeded && threshold.callback) {
+				callbacks.push_back(threshold.callback);
+			}
+			threshold.isExceeded = isExceeded;
+		}
+	}
+
+	// call outside of the lock so that callbacks can add or remove thresholds
+	for (const auto & callback : callbacks) {
+		callback(stats);
+	}
 }
 
 } // analytics namespace
@@ -32,9 +32,23 @@
 
 #pragma once
 
+#include <deque>
+#include <future>
+#include <random>
+#include <set>
+
+#include "AnalyticsVisitor.h"
 #include "GABatch.hpp"
+#include "GAHitVariant.hpp"
+#include "utils/BatchAgeController.h"
+#include "utils/CircuitBreaker.h"
+#include "utils/EventLoop.h"
+#include "utils/HitJournal.h"
+#include "utils/MpscRingBuffer.hpp"
+#include "utils/SpillQueue.h"
 #include "utils/ThreadManager.h"
 #include "utils/UrlRequest.h"
+#include "utils/UrlRequestPipeline.h"
 
 namespace bluecadet {
 namespace analytics {
@@ -44,15 +58,65 @@ typedef std::shared_ptr<class AnalyticsClient> AnalyticsClientRef;
 /*!
  Google Analytics API v1 client.
  
- Provides static shared instance for convenience, but can be instantiated freely.
+ Provides static shared instance for convenience, but can be instantiated freely. Clients need to be
+ owned by an AnalyticsClientRef (e.g. created with std::make_shared()) by the time setup() is called,
+ since requests hold weak references to their client.
+ To track many users (e.g. visitors of an exhibit), create one client and one AnalyticsVisitor per user
+ with createVisitor() instead of one client per user.
  
  See:
  - https://developers.google.com/analytics/devguides/collection/protocol/v1/parameters
  - https://developers.google.com/analytics/devguides/collection/protocol/v1/devguide#event
  */
-class AnalyticsClient {
+class AnalyticsClient : public std::enable_shared_from_this<AnalyticsClient> {
 
 public:
+
+	//! How processing cycles (batching, sending and retrying) are triggered
+	enum DispatchMode {
+		EVENT_DRIVEN,	//! Process only when a batch fills up, a batch reaches its max age, a retry is due or a flush is requested
+		UPDATE_SIGNAL	//! Process once per app update, i.e. once per frame
+	};
+
+	//! What happens to batches that don't fit within the batch queue's budget (see setMaxQueuedHits() and setMaxQueuedBytes())
+	enum OverflowPolicy {
+		DROP_OLDEST,	//! Discard the batches at the front of the queue, i.e. the oldest hits
+		DROP_NEWEST,	//! Discard the batches at the back of the queue, i.e. the most recent hits
+		SAMPLE,			//! Keep a uniform random sample of all batches queued while over budget (reservoir sampling)
+		SPILL_TO_DISK	//! Move the most recent batches to disk and queue them again once there's room (see setSpillDirectory())
+	};
+
+	//! Outcome of flush() and destroy(drainTimeout)
+	struct FlushResult {
+		size_t numHitsDelivered = 0;	//! Hits that were acknowledged by GA before the deadline
+		size_t numHitsAbandoned = 0;	//! Hits that were still queued or in flight when the deadline passed
+	};
+
+	//! Snapshot of the client's counters. See getStats().
+	struct Stats {
+		// Totals since the client was created
+		uint64_t	numHitsTracked = 0;		//! Hits passed to any of the track methods
+		uint64_t	numHitsSent = 0;		//! Hits in batches that were acknowledged by GA
+		uint64_t	numHitsRetried = 0;		//! Hits that had to be sent again after a failed or interrupted request
+		uint64_t	numHitsDropped = 0;		//! Hits that were discarded without being delivered (e.g. on destroy() without a journal)
+		uint64_t	numBatchesSent = 0;		//! Batches that were acknowledged by GA
+		uint64_t	numBatchesFailed = 0;	//! Failed send attempts
+
+		// Current state
+		size_t		numHitsPending = 0;		//! Hits that haven't been added to a queued batch yet
+		size_t		numQueuedHits = 0;		//! Hits in batches that are waiting to be sent or retried
+		size_t		numQueuedBatches = 0;	//! Batches that are waiting to be sent or retried
+		size_t		numQueuedBytes = 0;		//! Payload size of all queued batches
+		size_t		numBatchesInFlight = 0;	//! Batches with a pending request
+		size_t		numSpilledHits = 0;		//! Hits that have been moved to disk by SPILL_TO_DISK
+		double		currentBackoff = 0.0;	//! Retry delay in seconds of the last failed batch or probe; 0 after a successful send
+		double		timeSinceLastSuccess = 0.0;	//! Seconds since the last acknowledged batch, or since setup() if there hasn't been one
+		bool		isCircuitOpen = false;	//! Sending is paused after repeated failures; see setCircuitBreakerThreshold()
+	};
+
+	typedef std::function<bool(const Stats & stats)> StatsCondition;
+	typedef std::function<void(const Stats & stats)> StatsCallback;
+	typedef size_t StatsThresholdId;
 	
 	
 	//! Shared instance for singleton use. Singleton is not enforced, so you can still create multiple instances per app.
@@ -68,13 +132,25 @@ public:
 	virtual ~AnalyticsClient();
 
 	
-	//! Adds client to cinder update loop and automatically starts processing events and batches
+	//! Starts worker threads and automatically starts processing events and batches
+	//! (adds client to the event loop's updates if the dispatch mode is UPDATE_SIGNAL)
 	//! setup() and destroy() are symmetrical and can be called repeatedly.
+	//! Logs an error and doesn't start if the client isn't owned by an AnalyticsClientRef.
 	void setup(std::string clientId, std::string gaId, std::string appName, std::string appVersion = "", int numThreads = 1, double maxBatchAge = 4.0, int maxBatchesPerCycle = 8);
 	
 	//! Removes client from the update loop and clears any remaining hits.
+	//! If the journal is enabled, remaining hits are kept on disk and sent after the next setup().
 	//! setup() and destroy() are symmetrical and can be called repeatedly.
 	void destroy();
+
+	//! Attempts to send all remaining hits for up to drainTimeout seconds, then destroys the client.
+	//! Blocks the calling thread and drives networking itself, so it can be called from App::cleanup().
+	FlushResult destroy(const double drainTimeout);
+
+	//! Sends all hits tracked so far as soon as possible, ignoring the max batch age and max batches per cycle.
+	//! The future is fulfilled once all of these hits have been delivered or timeout seconds have passed.
+	//! Requires the client to be set up; progress is made on each processing cycle.
+	std::future<FlushResult> flush(const double timeout = 5.0);
 	
 	
 	
@@ -86,11 +162,39 @@ public:
 	//! Any custom query will be added to this client's default custom query.
 	void trackScreenView(const std::string & screenName, const std::string & customQuery = "");
 
+	//! Same as above, but with strings from the StringDictionary that don't need to be copied or encoded again.
+	//! E.g. static const auto tap = utils::StringDictionary::get().intern("Tap");
+	void trackEvent(const utils::InternedString & category, const utils::InternedString & action, const utils::InternedString & label = utils::InternedString(), const int value = -1, const std::string & customQuery = "");
+	void trackScreenView(const utils::InternedString & screenName, const std::string & customQuery = "");
+
 	//! Tracks an instance of a user timing hit and batches it with other hits if possible. Time is in MILLISECONDS
 	void trackUserTiming(const std::string & category, const std::string & variable, const int timeInMs, const std::string & label = "", const std::string & customQuery = "");
 
-	//! Tracks an instance of a base hit type and batches it with other hits if possible
+	//! Tracks an exception. Description is optional.
+	void trackException(const std::string & description, const bool isFatal = false, const std::string & customQuery = "");
+
+	//! Tracks an ecommerce transaction. Negative amounts and empty strings are omitted.
+	void trackTransaction(const std::string & transactionId, const std::string & affiliation = "", const double revenue = -1.0, const double shipping = -1.0, const double tax = -1.0, const std::string & currencyCode = "", const std::string & customQuery = "");
+
+	//! Tracks an item of an ecommerce transaction. Negative amounts and empty strings are omitted.
+	void trackItem(const std::string & transactionId, const std::string & name, const double price = -1.0, const int quantity = -1, const std::string & code = "", const std::string & category = "", const std::string & currencyCode = "", const std::string & customQuery = "");
+
+	//! Tracks a social interaction.
+	void trackSocial(const std::string & network, const std::string & action, const std::string & target, const std::string & customQuery = "");
+
+	//! Tracks any built-in hit type by value and batches it with other hits if possible.
+	//! Session control, app version, cache buster and custom query are applied like for all other hits.
+	void track(GAHitVariant hit);
+
+	//! Tracks an instance of a base hit type and batches it with other hits if possible.
+	//! Lock-free and safe to call from any thread; hits are collected into batches on the next processing cycle.
+	//! The hit is serialized right away and not referenced after this call.
 	void trackHit(GAHitRef hit);
+
+	//! Creates a handle that tracks hits with its own client ID and sessions. Hits of all visitors and of
+	//! this client are sent in shared batches by this client's threads and connections.
+	//! Requires the client to be owned by an AnalyticsClientRef.
+	AnalyticsVisitorRef createVisitor(const std::string & clientId);
 	
 	
 	
@@ -133,41 +237,324 @@ public:
 	bool getCacheBusterEnabled() const { return mCacheBusterEnabled; }
 	void setCacheBusterEnabled(const bool value) { mCacheBusterEnabled = value; }
 
+	//! Directory for an optional on-disk journal of all unsent hits. Disabled if empty (default).
+	//! Hits are written to the journal when they're tracked and removed once delivered. Any hits left
+	//! in the journal when the app quits or crashes are sent on the next setup(). Writes reach the disk
+	//! within getJournalSyncInterval(), so a crash loses at most the hits tracked since the last sync, plus
+	//! any tracked while the journal is still being opened after setup(). Takes effect on setup().
+	fs::path getJournalDirectory() const { return mJournalDirectory; }
+	void setJournalDirectory(const fs::path & directory) { mJournalDirectory = directory; }
+
+	//! Minimum time in seconds between forcing journal writes to disk. Defaults to 1.
+	//! Lower values lose fewer hits on power loss at the cost of more disk syncs.
+	double getJournalSyncInterval() const { return mJournalSyncInterval; }
+	void setJournalSyncInterval(const double value) { mJournalSyncInterval = value; }
+
+	//! Maximum number of batches written back-to-back on a single connection (HTTP/1.1 pipelining). Defaults to 1 (disabled).
+	//! Values like 8 let a large backlog (e.g. after an outage) clear in a few round trips instead of one per batch.
+	//! If the connection closes mid-pipeline, unanswered batches are requeued and retried.
+	int getMaxPipelineDepth() const { return mMaxPipelineDepth; }
+	void setMaxPipelineDepth(const int value) { mMaxPipelineDepth = value; }
+
+	//! Number of consecutive failed requests after which all sending is paused. Defaults to 5. 0 to disable.
+	//! While paused, a single small batch is sent as a probe with jittered exponential backoff and all other
+	//! batches are held back without increasing their own retry delays. The first successful request resumes sending.
+	int getCircuitBreakerThreshold() const { return mCircuitBreaker->getFailureThreshold(); }
+	void setCircuitBreakerThreshold(const int value) { mCircuitBreaker->setFailureThreshold(value); }
+
+	//! Whether sending is currently paused by the circuit breaker. See utils::CircuitBreaker.
+	utils::CircuitBreaker::State getCircuitBreakerState() const { return mCircuitBreaker->getState(); }
+
+	//! Target p99 delivery latency in seconds, from tracking a hit until GA acknowledged it. 0 to disable adaptive batching (default).
+	//! If set, batches are held for up to the max batch age passed to setup() only while more hits are likely to join them
+	//! and the target can still be met. See utils::BatchAgeController. Takes effect on setup().
+	double getTargetDeliveryLatency() const { return mTargetDeliveryLatency; }
+	void setTargetDeliveryLatency(const double value) { mTargetDeliveryLatency = value; }
+
+	//! The batch age currently in use and the hit rate and latencies it was based on.
+	//! Observations are also collected if adaptive batching is disabled.
+	utils::BatchAgeController::Decision getBatchingDecision() const;
+
+	//! Maximum number of hits held by queued batches, e.g. while offline. 0 for no limit (default).
+	//! Batches beyond this limit are handled according to getOverflowPolicy().
+	size_t getMaxQueuedHits() const { return mMaxQueuedHits; }
+	void setMaxQueuedHits(const size_t value) { mMaxQueuedHits = value; }
+
+	//! Maximum payload size in bytes of all queued batches. 0 for no limit (default).
+	//! Batches beyond this limit are handled according to getOverflowPolicy().
+	size_t getMaxQueuedBytes() const { return mMaxQueuedBytes; }
+	void setMaxQueuedBytes(const size_t value) { mMaxQueuedBytes = value; }
+
+	//! What happens to batches that exceed the queue budget. Defaults to DROP_OLDEST. Dropped hits are counted in getStats().
+	OverflowPolicy getOverflowPolicy() const { return mOverflowPolicy; }
+	void setOverflowPolicy(const OverflowPolicy value) { mOverflowPolicy = value; }
+
+	//! Directory used by SPILL_TO_DISK. Takes effect on setup(); batches are dropped like with DROP_OLDEST if empty (default).
+	//! Spilled hits don't survive restarts unless the journal is enabled as well and aren't included in flushes.
+	fs::path getSpillDirectory() const { return mSpillDirectory; }
+	void setSpillDirectory(const fs::path & directory) { mSpillDirectory = directory; }
+
+	//! How processing cycles are triggered. Defaults to EVENT_DRIVEN. Takes effect on setup().
+	DispatchMode getDispatchMode() const { return mDispatchMode; }
+	void setDispatchMode(const DispatchMode value) { mDispatchMode = value; }
+
+	//! Minimum time in seconds between processing cycles while batches are held back by max batches per cycle.
+	//! Only used in EVENT_DRIVEN mode. Defaults to 1/60.
+	double getMinDispatchInterval() const { return mMinDispatchInterval; }
+	void setMinDispatchInterval(const double value) { mMinDispatchInterval = value; }
+
+	//! Host and port that batches are sent to. Default to www.google-analytics.com and 80.
+	//! Can be pointed at a local collector, e.g. for load testing. Should be set before setup().
+	std::string getGaBaseUrl() const { return mGaBaseUrl; }
+	void setGaBaseUrl(const std::string & value) { mGaBaseUrl = value; }
+	int getGaPort() const { return mGaPort; }
+	void setGaPort(const int value) { mGaPort = value; }
+
+	//! Current counters. Lock-free and cheap enough to call every frame.
+	Stats getStats() const;
+
+	//! Calls callback whenever condition becomes true, e.g. when numQueuedBatches exceeds a limit.
+	//! Conditions are evaluated after each processing cycle; the callback is called once when the condition
+	//! becomes true and again only after it has been false in between. Callbacks are called on a worker thread.
+	StatsThresholdId addStatsThreshold(StatsCondition condition, StatsCallback callback);
+	void removeStatsThreshold(const StatsThresholdId id);
+
+	//! Persistent connections to the GA endpoint that are reused across batches.
+	//! Can be used to adjust pool size and idle timeout or to inspect reuse stats.
+	utils::ConnectionPoolRef getConnectionPool() const { return mConnectionPool; }
+
+	//! Worker threads that batches are assembled and sent on. Can be replaced with a custom executor before setup().
+	//! setup() and destroy() start and stop its threads, so it shouldn't be shared with other clients.
+	//! Tasks run on three lanes so that one kind of work can't hold up the others: "ingestion" (replaying the journal),
+	//! "dispatch" (assembling batches and deciding what to send) and "serialization" (rendering and sending requests).
+	//! Their weights can be adjusted with ThreadManager::setLaneWeight() and their queue depths inspected with getLaneStats().
+	utils::ThreadManagerRef getThreadManager() const { return mThreadManager; }
+	void setThreadManager(utils::ThreadManagerRef value) { mThreadManager = value; }
+
+	//! Event loop that requests complete on and that drives UPDATE_SIGNAL dispatching. Can be shared between clients.
+	//! Defaults to utils::getDefaultEventLoop() (the app's loop in Cinder apps) if not set before setup(). Should be set before setup().
+	utils::EventLoopRef getEventLoop() const { return mEventLoop; }
+	void setEventLoop(utils::EventLoopRef value) { mEventLoop = value; }
+
 	
 	
 protected:
-	
-	//! Determines which batches are ready for sending and sends those. Called by update().
+	friend class AnalyticsVisitor;
+	
+	//! Applies client settings and session control to hit, encodes it and queues it for the next processing cycle.
+	//! Built-in hit types are serialized without virtual calls. hitsInCurrentSession is the session state of the
+	//! client or visitor that tracked the hit.
+	template <class HitType>
+	void			enqueueHit(HitType & hit, std::atomic<int> & hitsInCurrentSession) {
+		applyHitSettings(hit, hitsInCurrentSession);
+		pushEncodedHit(GABatch::encodeHit(hit));
+	}
+
+	//! Applies app version, cache buster, custom query and session control to hit.
+	void			applyHitSettings(GAHit & hit, std::atomic<int> & hitsInCurrentSession);
+
+	//! Queues an encoded hit for the next processing cycle and wakes up the dispatcher if needed.
+	void			pushEncodedHit(GAEncodedHit && encodedHit);
+
+	//! Enqueues whichever hit type the variant holds.
+	void			enqueueHitVariant(GAHitVariant & hit, std::atomic<int> & hitsInCurrentSession);
+
+	struct HitEnqueuer;
+
+	//! Determines which batches are ready for sending and sends those. Called by update() or scheduled by requestProcessing().
 	void			processBatches();
+
+	//! Drains all newly tracked hits into batches. Expects mBatchMutex to be locked.
+	void			assembleBatches();
+
+	//! Moves mCurrentBatch to the batch queue. Expects mBatchMutex to be locked.
+	void			queueCurrentBatch();
+
+	//! Lets the batch age controller pick the max batch age for the next cycle. Expects mBatchMutex to be locked.
+	void			updateBatchAge(const double currentTime);
+
+	//! Schedules a processing cycle in delay seconds unless one is already scheduled sooner. Only used in EVENT_DRIVEN mode.
+	void			requestProcessing(const double delay);
+
+	//! The open journal or nullptr. Safe to call from any thread; the returned journal rejects writes once destroy() closed it.
+	utils::HitJournalRef	getJournal() const { return std::atomic_load(&mJournal); }
+
+	//! Schedules the next processing cycle for when the current batch expires or a retry is due. Expects mBatchMutex to be locked.
+	void			scheduleNextProcessing(const double currentTime);
+
+	//! Opens the journal and queues any hits that weren't delivered in previous sessions. Runs on a worker thread.
+	void			replayJournal();
 	
+	//! Sends batches individually or in pipelines of up to mMaxPipelineDepth batches.
+	void			sendBatches(const std::vector<GABatchRef> & batches);
+
 	//! Attempts to send batch; Discards it on success, adds it back to front of the queue on failure.
-	
 	void			sendBatch(GABatchRef batch);
+
+	//! Sends batches back-to-back on a single connection.
+	void			sendPipelinedBatches(std::vector<GABatchRef> batches);
+
+	//! Request line and headers shared by all batch POSTs; rendered again if the collector's host or uri changed.
+	utils::HttpRequestHeaderRef	getBatchRequestHeader();
+
 	//! Called by requests once they complete. Moves the batch back to the queue on failure.
 	void			handleBatchRequestCompleted(GABatchRef batch, utils::UrlRequestRef request);
+
+	//! Called by pipelines once they complete. Unanswered batches are moved back to the queue.
+	void			handleBatchPipelineCompleted(std::vector<GABatchRef> batches, utils::UrlRequestPipelineRef pipeline);
+
+	//! Closes all pending requests and pipelines without calling back, since the event loop may outlive this client.
+	void			cancelPendingRequests();
+
+	//! Discards a delivered batch or schedules a failed one for another attempt.
+	void			completeBatch(GABatchRef batch, const bool wasSuccessful, const std::string & failureReason);
+
+	//! Add batches to or remove them from mBatchQueue and keep queue stats up to date. Expect mBatchMutex to be locked.
+	//! pushQueuedBatch() applies the overflow policy if the queue exceeds its budget.
+	void			pushQueuedBatch(GABatchRef batch, const bool toFront);
+	std::deque<GABatchRef>::iterator	eraseQueuedBatch(std::deque<GABatchRef>::iterator it);
+	void			clearBatchQueue();
+
+	//! Queue budget. Expect mBatchMutex to be locked.
+	bool			isQueueOverBudget() const;
+	bool			hasQueueRoomFor(const size_t numHits, const size_t numBytes) const;
+
+	//! Brings the queue back within budget after a batch has been pushed. Expects mBatchMutex to be locked.
+	void			handleQueueOverflow(const bool isRetry);
+
+	//! Removes a queued batch without sending it. Expects mBatchMutex to be locked.
+	std::deque<GABatchRef>::iterator	dropQueuedBatch(std::deque<GABatchRef>::iterator it);
+
+	//! Moves batch to mSpillQueue. Returns false if it couldn't be written. Expects mBatchMutex to be locked.
+	bool			spillBatch(GABatchRef batch);
+
+	//! Queues spilled hits again while there's room. Expects mBatchMutex to be locked.
+	void			reloadSpilledBatches();
+
+	//! Stops waiting for batch in any flushes since it won't be sent. Expects mBatchMutex to be locked.
+	void			abandonBatch(GABatchRef batch);
+
+	//! Calls threshold callbacks whose conditions have become true. Expects mBatchMutex to be unlocked.
+	void			checkStatsThresholds();
+
+	//! Starts pending flushes and fulfills completed or expired ones. Expects mBatchMutex to be locked.
+	void			processFlushes(const double currentTime);
+
+	struct FlushOperation {
+		std::promise<FlushResult>	promise;
+		double						deadline;
+		bool						isStarted = false;
+		std::set<GABatchRef>		outstandingBatches;	//! Batches that still need to be delivered
+		FlushResult					result;
+	};
+	typedef std::shared_ptr<FlushOperation> FlushOperationRef;
+
+	struct StatsThreshold {
+		StatsThresholdId	id;
+		StatsCondition		condition;
+		StatsCallback		callback;
+		bool				isExceeded = false;
+	};
 	
 	
 	
 	// Threading
 	std::mutex				mBatchMutex;
 	std::mutex				mRequestMutex;
+	utils::EventLoopRef		mEventLoop;				//! Declared before anything that holds sockets, which must be closed before the loop's io_service is destroyed
 	utils::ThreadManagerRef	mThreadManager;
-	ci::signals::ScopedConnection mUpdateConnection;
+	utils::ThreadManager::LaneId	mIngestionLane;
+	utils::ThreadManager::LaneId	mDispatchLane;
+	utils::ThreadManager::LaneId	mSerializationLane;
+	utils::ConnectionPoolRef	mConnectionPool;
+	utils::EventLoop::CallbackId	mUpdateCallbackId;
+	utils::EventLoop::CallbackId	mCleanupCallbackId;
+	std::atomic<bool>		mIsSetUp;
+	std::weak_ptr<AnalyticsClient>	mWeakSelf;		//! Captured by requests; only written by setup() while no workers are running
+
+
+
+	// Dispatching
+	DispatchMode			mDispatchMode;
+	double					mMinDispatchInterval;
+	std::mutex				mDispatchMutex;
+	utils::ThreadManager::TaskId	mScheduledProcessingTaskId;	//! Pending processing task or INVALID_TASK_ID
+	double					mScheduledProcessingTime;
+	std::atomic<int>		mNumUnbatchedHits;		//! Hits tracked but not yet in a queued batch (i.e. incoming or in mCurrentBatch)
+	std::atomic<size_t>		mNumIncomingBytes;		//! Encoded size of hits tracked since the last assembleBatches()
+	std::atomic<size_t>		mCurrentBatchSize;		//! Payload size of mCurrentBatch as of the last assembleBatches()
 	
 	
 	
 	// Batch management
 	int						mMaxBatchesPerCycle;	//! Maximum number of batches to send in one cycle (i.e. one update frame)
 	double					mMaxBatchAge;			//! Maximum time in seconds waited until a batch is sent off
+	std::atomic<double>		mCurrentMaxBatchAge;	//! mMaxBatchAge or the batch age controller's latest decision
+	double					mTargetDeliveryLatency;	//! Enables the batch age controller if > 0
+	utils::BatchAgeControllerRef	mBatchAgeController;
 
-	int						mHitsInCurrentSession;
+	std::atomic<int>		mHitsInCurrentSession;
 	int						mMaxHitsPerSession;		//! GA has a limit of 500 hits per session. See https://developers.google.com/analytics/devguides/collection/protocol/v1/limits-quotas
 	bool					mAutoSessionsEnabled;
 	bool					mCacheBusterEnabled;
 	
+	utils::MpscRingBuffer<GAEncodedHit>	mIncomingHits;	//! Hits tracked since the last processing cycle; written to by any thread, drained by assembleBatches()
+	std::mutex				mOverflowMutex;
+	std::deque<GAEncodedHit>	mOverflowHits;		//! Fallback for hits tracked while mIncomingHits is full
+
 	std::deque<GABatchRef>	mBatchQueue;			//! Batches ready for sending
 	GABatchRef				mCurrentBatch;			//! The current batch to capture events
+	std::set<GABatchRef>	mBatchesInFlight;		//! Batches that have been sent but not completed yet
 	std::set<utils::UrlRequestRef>	mPendingRequests;
+	std::set<utils::UrlRequestPipelineRef>	mPendingPipelines;
+	utils::HttpRequestHeaderRef	mBatchRequestHeader;	//! Guarded by mRequestMutex
+	int						mMaxPipelineDepth;		//! Maximum number of batches sent back-to-back on one connection
+	utils::CircuitBreakerRef	mCircuitBreaker;	//! Pauses all sends after consecutive failures
+	GABatchRef				mProbeBatch;			//! Batch in flight as the circuit breaker's probe, if any
+	uint64_t				mProbeId;				//! Circuit breaker id of mProbeBatch
+	std::vector<FlushOperationRef>	mFlushes;		//! Flushes waiting for batches to be delivered
+
+
+
+	// Queue budget
+	size_t					mMaxQueuedHits;
+	size_t					mMaxQueuedBytes;
+	OverflowPolicy			mOverflowPolicy;
+	bool					mIsQueueOverflowing;	//! Set on the first overflow and reset once a batch has been delivered
+	size_t					mNumSampledBatches;		//! Number of batches offered to the SAMPLE reservoir during the current overflow
+	std::minstd_rand		mRandom;
+	fs::path			mSpillDirectory;
+	utils::SpillQueueRef	mSpillQueue;
+	std::atomic<size_t>		mNumSpilledHits;
+
+
+
+	// Stats
+	std::atomic<uint64_t>	mNumHitsTracked;
+	std::atomic<uint64_t>	mNumHitsSent;
+	std::atomic<uint64_t>	mNumHitsRetried;
+	std::atomic<uint64_t>	mNumHitsDropped;
+	std::atomic<uint64_t>	mNumBatchesSent;
+	std::atomic<uint64_t>	mNumBatchesFailed;
+	std::atomic<size_t>		mNumQueuedHits;
+	std::atomic<size_t>		mNumQueuedBatches;
+	std::atomic<size_t>		mNumQueuedBytes;
+	std::atomic<size_t>		mNumBatchesInFlight;
+	std::atomic<double>		mCurrentBackoff;
+	std::atomic<double>		mTimeOfLastSuccess;
+	std::mutex				mStatsThresholdMutex;
+	std::vector<StatsThreshold>	mStatsThresholds;
+	StatsThresholdId		mNextStatsThresholdId;
+
+
+
+	// Journal
+	utils::HitJournalRef	mJournal;	//! Read by any thread; only access through getJournal() and atomic_store()
+	fs::path			mJournalDirectory;
+	double					mJournalSyncInterval;
+	double					mTimeOfLastJournalSync;
+	bool					mIsReplayingJournal;	//! Batches aren't processed until the journal has been opened
+	bool					mIsJournalDirty;		//! Hits have been appended since the last sync
 	
 	
 	
@@ -178,6 +565,7 @@ protected:
 	std::string				mAppVersion;	//! Google Analytics App Version (optional, shows up in reports and is filterable)
 	std::string				mClientId;		//! Required client ID formatted as UUID according to http://www.ietf.org/rfc/rfc4122.txt
 	std::string				mGaBaseUrl	= "www.google-analytics.com";
+	int						mGaPort		= 80;
 	std::string				mGaBatchUri	= "/batch";
 	std::string				mCustomQuery = "";
 };
@@ -0,0 +1,105 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "AnalyticsVisitor.h"
+
+#include "AnalyticsClient.h"
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+
+AnalyticsVisitor::AnalyticsVisitor(AnalyticsClientRef client, const std::string & clientId) :
+	mClient(client),
+	mClientId(clientId),
+	mHitsInCurrentSession(0)
+{
+}
+
+void AnalyticsVisitor::trackEvent(const string & category, const string & action, const string & label, const int value, const std::string & customQuery) {
+	GAEvent event(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, category, action, label, value, mCustomQuery + customQuery);
+	mClient->enqueueHit(event, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackScreenView(const string & screenName, const std::string & customQuery) {
+	GAScreenView screenView(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, screenName, mCustomQuery + customQuery);
+	mClient->enqueueHit(screenView, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackEvent(const utils::InternedString & category, const utils::InternedString & action, const utils::InternedString & label, const int value, const std::string & customQuery) {
+	GAEvent event(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, category, action, label, value, mCustomQuery + customQuery);
+	mClient->enqueueHit(event, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackScreenView(const utils::InternedString & screenName, const std::string & customQuery) {
+	GAScreenView screenView(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, screenName, mCustomQuery + customQuery);
+	mClient->enqueueHit(screenView, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackUserTiming(const std::string & category, const std::string & variable, const int timeInMs, const std::string & label, const std::string & customQuery) {
+	GAUserTiming userTiming(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, category, variable, timeInMs, label, mCustomQuery + customQuery);
+	mClient->enqueueHit(userTiming, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackException(const std::string & description, const bool isFatal, const std::string & customQuery) {
+	GAException exception(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, description, isFatal, mCustomQuery + customQuery);
+	mClient->enqueueHit(exception, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackTransaction(const std::string & transactionId, const std::string & affiliation, const double revenue, const double shipping, const double tax, const std::string & currencyCode, const std::string & customQuery) {
+	GATransaction transaction(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, transactionId, affiliation, revenue, shipping, tax, currencyCode, mCustomQuery + customQuery);
+	mClient->enqueueHit(transaction, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackItem(const std::string & transactionId, const std::string & name, const double price, const int quantity, const std::string & code, const std::string & category, const std::string & currencyCode, const std::string & customQuery) {
+	GAItem item(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, transactionId, name, price, quantity, code, category, currencyCode, mCustomQuery + customQuery);
+	mClient->enqueueHit(item, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackSocial(const std::string & network, const std::string & action, const std::string & target, const std::string & customQuery) {
+	GASocial social(mClient->mAppName, mClient->mGaId, mClientId, mClient->mGaApiVersion, network, action, target, mCustomQuery + customQuery);
+	mClient->enqueueHit(social, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::track(GAHitVariant hit) {
+	mClient->enqueueHitVariant(hit, mHitsInCurrentSession);
+}
+
+void AnalyticsVisitor::trackHit(GAHitRef hit) {
+	if (hit) {
+		mClient->enqueueHit(*hit, mHitsInCurrentSession);
+	}
+}
+
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,100 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "GAHitVariant.hpp"
+
+namespace bluecadet {
+namespace analytics {
+
+typedef std::shared_ptr<class AnalyticsClient> AnalyticsClientRef;
+typedef std::shared_ptr<class AnalyticsVisitor> AnalyticsVisitorRef;
+
+/*!
+ Lightweight handle for tracking hits on behalf of a single visitor (i.e. one GA user).
+
+ Only holds the visitor's client ID, custom query and session state. Hits are batched and sent by the
+ AnalyticsClient that created the visitor, together with the hits of all other visitors, so any number of
+ visitors share one set of worker threads, batches and connections. Create with AnalyticsClient::createVisitor().
+
+ Visitors keep their client alive. Track methods are safe to call from any thread, like the client's.
+ */
+class AnalyticsVisitor {
+
+public:
+	//! Client ID in RFC 4122 UUID format used for all hits tracked by this visitor.
+	const std::string & getClientId() const { return mClientId; }
+
+	//! Added to every hit of this visitor, in addition to the client's custom query. E.g. &cd1=myCustomDimensionValue
+	std::string getCustomQuery() const { return mCustomQuery; }
+	void setCustomQuery(const std::string customQuery) { mCustomQuery = customQuery; }
+
+	//! Starts a new session with the next hit, e.g. when a returning visitor is recognized.
+	//! Only applies if auto sessions are enabled on the client.
+	void startNewSession() { mHitsInCurrentSession = 0; }
+
+	//! The client that sends this visitor's hits.
+	AnalyticsClientRef getClient() const { return mClient; }
+
+	//! See the equivalent methods of AnalyticsClient.
+	void trackEvent(const std::string & category, const std::string & action, const std::string & label = "", const int value = -1, const std::string & customQuery = "");
+	void trackScreenView(const std::string & screenName, const std::string & customQuery = "");
+	void trackEvent(const utils::InternedString & category, const utils::InternedString & action, const utils::InternedString & label = utils::InternedString(), const int value = -1, const std::string & customQuery = "");
+	void trackScreenView(const utils::InternedString & screenName, const std::string & customQuery = "");
+	void trackUserTiming(const std::string & category, const std::string & variable, const int timeInMs, const std::string & label = "", const std::string & customQuery = "");
+	void trackException(const std::string & description, const bool isFatal = false, const std::string & customQuery = "");
+	void trackTransaction(const std::string & transactionId, const std::string & affiliation = "", const double revenue = -1.0, const double shipping = -1.0, const double tax = -1.0, const std::string & currencyCode = "", const std::string & customQuery = "");
+	void trackItem(const std::string & transactionId, const std::string & name, const double price = -1.0, const int quantity = -1, const std::string & code = "", const std::string & category = "", const std::string & currencyCode = "", const std::string & customQuery = "");
+	void trackSocial(const std::string & network, const std::string & action, const std::string & target, const std::string & customQuery = "");
+
+	//! Tracks a prebuilt hit with this visitor's session state. The hit should be created with getClientId().
+	void track(GAHitVariant hit);
+	void trackHit(GAHitRef hit);
+
+protected:
+	friend class AnalyticsClient;
+
+	AnalyticsVisitor(AnalyticsClientRef client, const std::string & clientId);
+
+	AnalyticsClientRef	mClient;
+	const std::string	mClientId;
+	std::string			mCustomQuery;
+	std::atomic<int>	mHitsInCurrentSession;
+};
+
+} // analytics namespace
+} // bluecadet namespace
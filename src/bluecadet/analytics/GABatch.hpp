@@ -32,49 +32,169 @@
 
 #pragma once
 
-#include "cinder/app/App.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "GAEncodedHit.hpp"
 #include "GAHit.hpp"
+#include "utils/Log.h"
+#include "utils/PercentEncoding.hpp"
 
 namespace bluecadet {
 namespace analytics {
 
 typedef std::shared_ptr<class GABatch> GABatchRef;
 
+/*!
+ A batch of hits that is sent in a single request.
+
+ Hits are added in their encoded form and appended to a single payload buffer that acts as the batch's
+ arena, so queued hits only cost their encoded bytes plus a few bytes of metadata. The exact size of
+ the batch is always known. Parameters that change with each send attempt (queue time and cache buster)
+ are written as fixed-width placeholders that are patched in place by updatePayload().
+
+ See https://developers.google.com/analytics/devguides/collection/protocol/v1/devguide#batch-limitations
+ */
 class GABatch {
 public:
 
 	static const size_t MAX_NUM_HITS	= 20;			//! 20 items max per batch
-	//static const size_t MAX_HIT_SIZE	= 8 * 1014;		//! 8kb max per item
-	//static const size_t MAX_BATCH_SIZE= 16 * 1024;	//! 16kb max per batch
+	static const size_t MAX_HIT_SIZE	= 8 * 1024;		//! 8kb max per item
+	static const size_t MAX_BATCH_SIZE	= 16 * 1024;	//! 16kb max per batch
 	static const int MAX_DELAY_BETWEEN_ATTEMPTS = 300;	//! How long in seconds to wait until re-attempting to send this batch
 
-	GABatch() {};
+	GABatch() {
+		mPayload.reserve(INITIAL_PAYLOAD_CAPACITY);
+		mHits.reserve(MAX_NUM_HITS);
+	};
 	~GABatch() {};
 
-	std::string getPayloadString() const {
-		std::string result = "";
-		for (auto hit : mHits) {
-			if (!result.empty()) result += "\n";
-			result += hit->getPayloadString();
+	//! Serializes hit and truncates it to fit within MAX_HIT_SIZE if necessary.
+	static GAEncodedHit encodeHit(const GAHit & hit) {
+		return truncateHit(GAEncodedHit(hit.mTimestamp, hit.getParameterString(), hit.mCacheBuster));
+	}
+
+	//! Serializes a built-in hit type without any virtual calls and truncates it to fit within MAX_HIT_SIZE if necessary.
+	template <class HitType>
+	static GAEncodedHit encodeHit(const GATypedHit<HitType> & hit) {
+		return truncateHit(GAEncodedHit(hit.mTimestamp, schema::serializeParameters(static_cast<const HitType &>(hit)), hit.mCacheBuster));
+	}
+
+	//! Truncates encodedHit to fit within MAX_HIT_SIZE if necessary.
+	static GAEncodedHit truncateHit(GAEncodedHit encodedHit) {
+		std::string & parameters = encodedHit.parameters;
+		const size_t maxSize = MAX_HIT_SIZE - getVariableParametersSize(encodedHit.cacheBuster);
+
+		if (parameters.size() > maxSize) {
+			CI_LOG_W("Truncating hit from " << std::to_string(parameters.size() + getVariableParametersSize(encodedHit.cacheBuster)) << " to " << std::to_string(MAX_HIT_SIZE) << " bytes");
+
+			// don't cut through percent-encoded characters or multi-byte UTF-8 sequences
+			parameters.resize(utils::getPercentEncodedCutSize(parameters, maxSize));
 		}
-		return result;
-	};
 
-	void addHit(GAHitRef hit) {
-		mHits.push_back(hit);
+		return encodedHit;
+	}
+
+	//! Updates queue time and cache buster of each hit and returns the payload. Doesn't re-serialize any other parameters.
+	const std::string & updatePayload() {
+		const double currentTime = utils::getElapsedSeconds();
+
+		for (const auto & hit : mHits) {
+			// Delta time since hit in miliseconds
+			const double queueTime = round((currentTime - hit.timestamp) * 1000.0);
+
+			writeDigits(&mPayload[hit.queueTimeOffset], queueTime > 0.0 ? (uint64_t)queueTime : 0);
+
+			if (hit.cacheBuster) {
+				writeDigits(&mPayload[hit.queueTimeOffset + NUM_DIGITS + getCacheBusterKey().size()], (uint64_t)rand());
+			}
+		}
+
+		return mPayload;
+	}
+
+	//! Appends hit to the payload. Use canAddHit() first to stay within limits.
+	void addHit(const GAEncodedHit & hit) {
+		if (!mPayload.empty()) {
+			mPayload += "\n";
+		}
+
+		HitInfo info;
+		info.timestamp = hit.timestamp;
+		info.journalId = hit.journalId;
+		info.cacheBuster = hit.cacheBuster;
+
+		mPayload += hit.parameters;
+		mPayload += getQueueTimeKey();
+		info.queueTimeOffset = (uint32_t)mPayload.size();
+		mPayload.append(NUM_DIGITS, '0');
+
+		if (hit.cacheBuster) {
+			mPayload += getCacheBusterKey(); // should be final parameter
+			mPayload.append(NUM_DIGITS, '0');
+		}
+
+		mHits.push_back(info);
+	}
+
+	//! Whether hit fits within this batch's hit count and size limits
+	bool canAddHit(const GAEncodedHit & hit) const {
+		if (mHits.size() >= MAX_NUM_HITS) {
+			return false;
+		}
+		const size_t separatorSize = mPayload.empty() ? 0 : 1;
+		return mPayload.size() + separatorSize + hit.parameters.size() + getVariableParametersSize(hit.cacheBuster) <= MAX_BATCH_SIZE;
 	}
-	bool canAddHit(GAHitRef hit) const { return mHits.size() < MAX_NUM_HITS; }
-	bool isFull() const { return mHits.size() >= MAX_NUM_HITS; }
+
+	//! Releases any unused capacity once no more hits will be added
+	void compact() {
+		mPayload.shrink_to_fit();
+		mHits.shrink_to_fit();
+	}
+
+	bool isFull() const { return mHits.size() >= MAX_NUM_HITS || mPayload.size() >= MAX_BATCH_SIZE; }
 	bool isEmpty() const { return mHits.empty(); }
 	size_t numHits() const { return mHits.size(); }
+	size_t getPayloadSize() const { return mPayload.size(); }
+
+	//! Ids of all journaled hits in this batch
+	std::vector<uint64_t> getJournalIds() const {
+		std::vector<uint64_t> ids;
+		for (const auto & hit : mHits) {
+			if (hit.journalId != 0) {
+				ids.push_back(hit.journalId);
+			}
+		}
+		return ids;
+	}
+
+	//! Extracts all hits in their encoded form (without queue time and cache buster values), e.g. to store them elsewhere.
+	std::vector<GAEncodedHit> getEncodedHits() const {
+		std::vector<GAEncodedHit> hits;
+		hits.reserve(mHits.size());
+		size_t hitStart = 0;
+
+		for (const auto & hit : mHits) {
+			const size_t parametersEnd = hit.queueTimeOffset - getQueueTimeKey().size();
+			hits.push_back(GAEncodedHit(hit.timestamp, mPayload.substr(hitStart, parametersEnd - hitStart), hit.cacheBuster, hit.journalId));
+			hitStart = parametersEnd + getVariableParametersSize(hit.cacheBuster) + 1; // skip separator
+		}
+
+		return hits;
+	}
 
 	//! Gets the age in seconds of the oldest hit or 0 if no hits added yet
-	double getAge() { return mHits.empty() ? 0.0 : ci::app::getElapsedSeconds() - mHits.front()->mTimestamp; }
+	double getAge() { return mHits.empty() ? 0.0 : utils::getElapsedSeconds() - mHits.front().timestamp; }
 
 	double getTimeOfLastSendAttempt() const { return mTimeOfLastSendAttempt; }
 	void setTimeOfLastSendAttempt(double timeOfLastSendAttempt) { mTimeOfLastSendAttempt = timeOfLastSendAttempt; }
 
+	//! Time when this batch was last handed to a request; used to measure request latency
+	double getTimeOfLastSend() const { return mTimeOfLastSend; }
+	void setTimeOfLastSend(double timeOfLastSend) { mTimeOfLastSend = timeOfLastSend; }
+
 	double getDelayUntilNextSendAttempt() const { return mDelayUntilNextSendAttempt; }
 	void increaseDelayUntilNextSendAttempt() {
 		if (mDelayUntilNextSendAttempt < (double)MAX_DELAY_BETWEEN_ATTEMPTS) {
@@ -83,8 +203,37 @@ public:
 	}
 
 protected:
-	std::vector<GAHitRef> mHits;
+	static const size_t NUM_DIGITS = 10; //! Fixed width of queue time and cache buster values
+	static const size_t INITIAL_PAYLOAD_CAPACITY = 4 * 1024; //! Fits a typical full batch without reallocating
+
+	//! Everything needed to patch a hit's variable parameters at send time
+	struct HitInfo {
+		double		timestamp;
+		uint64_t	journalId;
+		uint32_t	queueTimeOffset;	//! Offset of the queue time digits in mPayload
+		bool		cacheBuster;
+	};
+
+	static const std::string & getQueueTimeKey() { static const std::string key = "&qt="; return key; }
+	static const std::string & getCacheBusterKey() { static const std::string key = "&z="; return key; }
+
+	//! Size of the queue time and cache buster parameters that are appended to each hit
+	static size_t getVariableParametersSize(const bool cacheBuster) {
+		return getQueueTimeKey().size() + NUM_DIGITS + (cacheBuster ? getCacheBusterKey().size() + NUM_DIGITS : 0);
+	}
+
+	//! Writes value as zero-padded decimal with NUM_DIGITS digits
+	static void writeDigits(char * dst, uint64_t value) {
+		for (size_t i = NUM_DIGITS; i > 0; --i) {
+			dst[i - 1] = (char)('0' + value % 10);
+			value /= 10;
+		}
+	}
+
+	std::vector<HitInfo> mHits;
+	std::string mPayload;
 	double mTimeOfLastSendAttempt = 0.0;
+	double mTimeOfLastSend = 0.0;
 	double mDelayUntilNextSendAttempt = 1.0;
 	
 };
@@ -0,0 +1,59 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "GAHit.hpp"
+
+namespace bluecadet {
+namespace analytics {
+
+//! A hit that has already been serialized into its final parameters, minus queue time and cache buster.
+//! Tracked hits are converted to this compact value type right away so that queued hits don't hold on to
+//! any of the strings they were created from.
+struct GAEncodedHit {
+	GAEncodedHit() {}
+	GAEncodedHit(const double timestamp, std::string parameters, const bool cacheBuster, const uint64_t journalId = 0) :
+		timestamp(timestamp),
+		journalId(journalId),
+		cacheBuster(cacheBuster),
+		parameters(std::move(parameters))
+	{}
+
+	double		timestamp	= 0.0;		//! Time in seconds when the hit was tracked
+	uint64_t	journalId	= 0;		//! Set once the hit has been recorded in a HitJournal; 0 if not journaled
+	bool		cacheBuster	= true;		//! Whether to append a cache buster parameter when sending
+	std::string	parameters;				//! All parameters except for queue time and cache buster
+};
+
+} // analytics namespace
+} // bluecadet namespace
@@ -29,47 +29,54 @@
  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-
 #pragma once
 
-#include "cinder/app/App.h"
-#include "cinder/Url.h"
-
 #include "GAHit.hpp"
 
 namespace bluecadet {
 namespace analytics {
 typedef std::shared_ptr<class GAEvent> GAEventRef;
 
-class GAEvent : public GAHit {
+// https://developers.google.com/analytics/devguides/collection/protocol/v1/devguide#event
+class GAEvent final : public GATypedHit<GAEvent> {
 public:
 	GAEvent(const std::string & appName, const std::string & trackingId, const std::string & clientId, const std::string & version,
 		const std::string & category, const std::string & action, const std::string & label = "", int value = -1, const std::string & customQuery = "") :
-		GAHit(appName, trackingId, clientId, version, "event", customQuery),
+		GATypedHit(appName, trackingId, clientId, version, "event", customQuery),
 		mCategory(category),
 		mAction(action),
 		mLabel(label),
 		mValue(value)
 	{}
-	virtual ~GAEvent() {};
 
-	virtual std::string getPayloadString() const override {
-		std::string result = GAHit::getPayloadString();
+	//! Category, action and label are serialized from their cached encoded form. See utils::StringDictionary.
+	GAEvent(const std::string & appName, const std::string & trackingId, const std::string & clientId, const std::string & version,
+		const utils::InternedString & category, const utils::InternedString & action, const utils::InternedString & label = utils::InternedString(), int value = -1, const std::string & customQuery = "") :
+		GATypedHit(appName, trackingId, clientId, version, "event", customQuery),
+		mValue(value),
+		mInternedCategory(category),
+		mInternedAction(action),
+		mInternedLabel(label)
+	{}
 
-		result += "&ec=" + ci::Url::encode(mCategory);	// Event category
-		result += "&ea=" + ci::Url::encode(mAction);	// Event action
+	template <class Visitor>
+	void visitHitParameters(Visitor & visitor) const {
+		visitor.text("&ec=", mCategory, mInternedCategory);			// Event category
+		visitor.text("&ea=", mAction, mInternedAction);				// Event action
 
 		// Optional values
-		if (!mLabel.empty())	result += "&el=" + ci::Url::encode(mLabel);
-		if (mValue >= 0)		result += "&ev=" + std::to_string(mValue);
-
-		return result;
+		visitor.optionalText("&el=", mLabel, mInternedLabel);		// Event label
+		visitor.optionalInteger("&ev=", mValue);					// Event value
 	}
 
-	const std::string	mCategory;		//! Mandatory
-	const std::string	mAction;		//! Mandatory
+	const std::string	mCategory;		//! Mandatory; Empty if constructed from interned strings
+	const std::string	mAction;		//! Mandatory; Empty if constructed from interned strings
 	const std::string	mLabel;			//! Optional; Empty string will be omitted
 	const int			mValue;			//! Optional; Negative values will be omitted
+
+	const utils::InternedString	mInternedCategory;	//! Used instead of mCategory if set
+	const utils::InternedString	mInternedAction;	//! Used instead of mAction if set
+	const utils::InternedString	mInternedLabel;		//! Used instead of mLabel if set
 };
 
 } // analytics namespace
@@ -32,13 +32,18 @@
 
 #pragma once
 
-#include "cinder/app/App.h"
-#include "cinder/Url.h"
+#include <memory>
+#include <string>
+
+#include "GAHitSchema.hpp"
+#include "utils/Clock.hpp"
 
 namespace bluecadet {
 namespace analytics {
 typedef std::shared_ptr<class GAHit> GAHitRef;
 
+//! Base class for all hits with the parameters shared by all hit types.
+//! Custom hit types can subclass GAHit and override getParameterString(). Built-in hit types derive from GATypedHit instead.
 class GAHit {
 public:
 
@@ -50,7 +55,7 @@ public:
 	};
 
 	GAHit(const std::string & appName, const std::string & trackingId, const std::string & clientId, const std::string & version, const std::string & type, const std::string & customQuery = "") :
-		mTimestamp(ci::app::getElapsedSeconds()),
+		mTimestamp(utils::getElapsedSeconds()),
 		mAppName(appName),
 		mTrackingId(trackingId),
 		mClientId(clientId),
@@ -60,30 +65,45 @@ public:
 	{}
 	virtual ~GAHit() {};
 
-	virtual std::string getPayloadString() const {
+	//! The full payload including the parameters that change with each send attempt (queue time and cache buster).
+	//! Hits are sent via getParameterString(), so this is final: custom hit types that still override it fail to compile
+	//! instead of silently losing their parameters. Override getParameterString() instead.
+	virtual std::string getPayloadString() const final {
 		// Delta time since hit in miliseconds
-		int queueTime = (int)round((ci::app::getElapsedSeconds() - mTimestamp) * 1000.0);
+		int queueTime = (int)round((utils::getElapsedSeconds() - mTimestamp) * 1000.0);
 
-		// Mandatory values
-		std::string result =
-			"v=" + mVersion +						// API version
-			"&an=" + ci::Url::encode(mAppName) +	// App Name
-			"&tid=" + mTrackingId +					// Tracking ID
-			"&cid=" + mClientId +					// Client ID
-			"&t=" + mType +							// Hit type
-			"&qt=" + std::to_string(queueTime);		// Queue time 
+		std::string result = getParameterString();
+
+		result += "&qt=" + std::to_string(queueTime);	// Queue time
 
-		// Optional values
-		if (!mAppVersion.empty())		result += "&av=" + ci::Url::encode(mAppVersion);
-		if (!mCustomQuery.empty())		result += mCustomQuery;
-		if (mAnonymizeIp)				result += "&aip=1";
-		if (mSessionControl == Start)	result += "&sc=start";
-		if (mSessionControl == End)		result += "&sc=end";
 		if (mCacheBuster)				result += "&z=" + std::to_string(rand()); // should be final parameter
 
 		return result;
 	}
 
+	//! All parameters that don't change between send attempts. Override this to add parameters to custom hit types.
+	virtual std::string getParameterString() const {
+		return schema::serializeParameters(*this);
+	}
+
+	//! Visits the parameters shared by all hit types. See GAHitSchema.hpp.
+	template <class Visitor>
+	void visitParameters(Visitor & visitor) const {
+		// Mandatory values
+		visitor.raw("v=", mVersion);			// API version
+		visitor.text("&an=", mAppName);			// App Name
+		visitor.raw("&tid=", mTrackingId);		// Tracking ID
+		visitor.raw("&cid=", mClientId);		// Client ID
+		visitor.raw("&t=", mType);				// Hit type
+
+		// Optional values
+		visitor.optionalText("&av=", mAppVersion);
+		visitor.query(mCustomQuery);
+		visitor.flag("&aip=1", mAnonymizeIp);
+		visitor.flag("&sc=start", mSessionControl == Start);
+		visitor.flag("&sc=end", mSessionControl == End);
+	}
+
 	const double		mTimestamp;		//! Time in seconds; Set in constructor automatically
 
 	const std::string	mAppName;		//! Mandatory GA application name (required by mobile app type properties)
@@ -100,5 +120,26 @@ public:
 	SessionControl		mSessionControl = None;
 };
 
+/*!
+ Base for built-in hit types. HitType declares its own parameters in a template method
+ 'template <class Visitor> void visitHitParameters(Visitor & visitor) const', which are serialized after the shared ones.
+ Built-in hit types are final, copyable value types, so they can be serialized without virtual calls and stored in a GAHitVariant.
+ */
+template <class HitType>
+class GATypedHit : public GAHit {
+public:
+	using GAHit::GAHit;
+
+	std::string getParameterString() const override {
+		return schema::serializeParameters(static_cast<const HitType &>(*this));
+	}
+
+	template <class Visitor>
+	void visitParameters(Visitor & visitor) const {
+		GAHit::visitParameters(visitor);
+		static_cast<const HitType &>(*this).visitHitParameters(visitor);
+	}
+};
+
 } // analytics namespace
 } // bluecadet namespace
@@ -0,0 +1,219 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "utils/PercentEncoding.hpp"
+#include "utils/StringDictionary.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace schema {
+
+/*!
+ Compile-time description of hit parameters.
+
+ Hit types declare their parameters in a visitParameters() template that calls one of the methods
+ of ParameterVisitor per parameter, with the parameter key as a string literal (e.g. '&ec='). Keys
+ are resolved at compile time, so there is no lookup, virtual dispatch or intermediate string per
+ parameter. serializeParameters() visits a hit twice: once to count its exact encoded size and once
+ to write it straight into a buffer of that size.
+ */
+
+//! Counts bytes without writing them.
+struct SizeSink {
+	size_t size = 0;
+
+	void put(const char * /*data*/, const size_t length) { size += length; }
+	void putEncoded(const std::string & value) { size += utils::getPercentEncodedSize(value); }
+};
+
+//! Writes bytes into a buffer that has been sized with SizeSink.
+struct BufferSink {
+	explicit BufferSink(char * out) : out(out) {}
+	char * out;
+
+	void put(const char * data, const size_t length) { memcpy(out, data, length); out += length; }
+	void putEncoded(const std::string & value) { out = utils::writePercentEncoded(out, value); }
+};
+
+//! Writes value as decimal integer into buffer (at least 21 chars) and returns the number of chars written.
+inline size_t formatInteger(const int64_t value, char * buffer) {
+	char digits[20];
+	size_t numDigits = 0;
+	uint64_t remainder = value < 0 ? (uint64_t)(-(value + 1)) + 1 : (uint64_t)value;
+
+	do {
+		digits[numDigits++] = (char)('0' + remainder % 10);
+		remainder /= 10;
+	} while (remainder > 0);
+
+	size_t length = 0;
+	if (value < 0) buffer[length++] = '-';
+	while (numDigits > 0) buffer[length++] = digits[--numDigits];
+	return length;
+}
+
+//! Writes value with up to 6 decimals and without trailing zeros into buffer (at least 32 chars). Returns the number of chars written.
+inline size_t formatDecimal(const double value, char * buffer) {
+	if (!std::isfinite(value)) {
+		buffer[0] = '0';
+		return 1;
+	}
+
+	int length = snprintf(buffer, 32, "%.6f", value);
+	if (length <= 0 || length >= 32) {
+		buffer[0] = '0';
+		return 1;
+	}
+
+	while (length > 0 && buffer[length - 1] == '0') length--;
+	if (length > 0 && buffer[length - 1] == '.') length--;
+	return (size_t)length;
+}
+
+template <class Sink>
+class ParameterVisitor {
+public:
+	explicit ParameterVisitor(Sink & sink) : mSink(sink) {}
+
+	//! Value is written as is. Use for values that are already URL-safe (IDs, versions, hit types).
+	template <size_t N>
+	void raw(const char (&key)[N], const std::string & value) {
+		mSink.put(key, N - 1);
+		mSink.put(value.data(), value.size());
+	}
+
+	//! Value is percent-encoded.
+	template <size_t N>
+	void text(const char (&key)[N], const std::string & value) {
+		mSink.put(key, N - 1);
+		mSink.putEncoded(value);
+	}
+
+	//! Value is percent-encoded and omitted if empty.
+	template <size_t N>
+	void optionalText(const char (&key)[N], const std::string & value) {
+		if (!value.empty()) text(key, value);
+	}
+
+	//! Writes the cached encoded form of interned if it's set and percent-encodes value otherwise.
+	template <size_t N>
+	void text(const char (&key)[N], const std::string & value, const utils::InternedString & interned) {
+		if (interned) {
+			mSink.put(key, N - 1);
+			mSink.put(interned.getEncodedValue().data(), interned.getEncodedValue().size());
+		} else {
+			text(key, value);
+		}
+	}
+
+	//! Like text(key, value, interned), but omitted if empty.
+	template <size_t N>
+	void optionalText(const char (&key)[N], const std::string & value, const utils::InternedString & interned) {
+		if (interned ? !interned.getValue().empty() : !value.empty()) text(key, value, interned);
+	}
+
+	template <size_t N>
+	void integer(const char (&key)[N], const int64_t value) {
+		char buffer[24];
+		mSink.put(key, N - 1);
+		mSink.put(buffer, formatInteger(value, buffer));
+	}
+
+	//! Value is omitted if negative.
+	template <size_t N>
+	void optionalInteger(const char (&key)[N], const int64_t value) {
+		if (value >= 0) integer(key, value);
+	}
+
+	//! Value is omitted if negative.
+	template <size_t N>
+	void optionalDecimal(const char (&key)[N], const double value) {
+		if (value >= 0.0) {
+			char buffer[32];
+			mSink.put(key, N - 1);
+			mSink.put(buffer, formatDecimal(value, buffer));
+		}
+	}
+
+	template <size_t N>
+	void boolean(const char (&key)[N], const bool value) {
+		mSink.put(key, N - 1);
+		mSink.put(value ? "1" : "0", 1);
+	}
+
+	//! Writes a complete parameter (key and value, e.g. '&aip=1') if isSet is true.
+	template <size_t N>
+	void flag(const char (&parameter)[N], const bool isSet) {
+		if (isSet) mSink.put(parameter, N - 1);
+	}
+
+	//! Appends a pre-encoded query string as is.
+	void query(const std::string & value) {
+		mSink.put(value.data(), value.size());
+	}
+
+protected:
+	Sink & mSink;
+};
+
+//! Returns the exact size of hit's encoded parameters.
+template <class Hit>
+size_t getParametersSize(const Hit & hit) {
+	SizeSink sink;
+	ParameterVisitor<SizeSink> visitor(sink);
+	hit.visitParameters(visitor);
+	return sink.size;
+}
+
+//! Serializes hit's parameters into a string with a single, exact allocation.
+template <class Hit>
+std::string serializeParameters(const Hit & hit) {
+	std::string result(getParametersSize(hit), '\0');
+
+	if (!result.empty()) {
+		BufferSink sink(&result[0]);
+		ParameterVisitor<BufferSink> visitor(sink);
+		hit.visitParameters(visitor);
+	}
+
+	return result;
+}
+
+} // schema namespace
+} // analytics namespace
+} // bluecadet namespace
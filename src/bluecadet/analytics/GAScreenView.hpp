@@ -29,35 +29,36 @@
  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-
 #pragma once
 
-#include "cinder/app/App.h"
-#include "cinder/Url.h"
-
 #include "GAHit.hpp"
 
 namespace bluecadet {
 namespace analytics {
 typedef std::shared_ptr<class GAScreenView> GAScreenViewRef;
 
-class GAScreenView : public GAHit {
+// https://developers.google.com/analytics/devguides/collection/protocol/v1/devguide#screenView
+class GAScreenView final : public GATypedHit<GAScreenView> {
 public:
 	GAScreenView(const std::string & appName, const std::string & trackingId, const std::string & clientId, const std::string & version, const std::string & screenName, const std::string & customQuery = "") :
-		GAHit(appName, trackingId, clientId, version, "screenview", customQuery),
+		GATypedHit(appName, trackingId, clientId, version, "screenview", customQuery),
 		mScreenName(screenName)
 	{}
-	virtual ~GAScreenView() {};
-
-	virtual std::string getPayloadString() const override {
-		std::string result = GAHit::getPayloadString();
 
-		result += "&cd=" + ci::Url::encode(mScreenName);
+	//! The screen name is serialized from its cached encoded form. See utils::StringDictionary.
+	GAScreenView(const std::string & appName, const std::string & trackingId, const std::string & clientId, const std::string & version, const utils::InternedString & screenName, const std::string & customQuery = "") :
+		GATypedHit(appName, trackingId, clientId, version, "screenview", customQuery),
+		mInternedScreenName(screenName)
+	{}
 
-		return result;
+	template <class Visitor>
+	void visitHitParameters(Visitor & visitor) const {
+		visitor.text("&cd=", mScreenName, mInternedScreenName);		// Screen name
 	}
 
-	const std::string	mScreenName;	//! Mandatory
+	const std::string	mScreenName;	//! Mandatory; Empty if constructed from an interned string
+
+	const utils::InternedString	mInternedScreenName;	//! Used instead of mScreenName if set
 };
 
 } // analytics namespace
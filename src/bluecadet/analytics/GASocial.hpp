@@ -0,0 +1,64 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "GAHit.hpp"
+
+namespace bluecadet {
+namespace analytics {
+typedef std::shared_ptr<class GASocial> GASocialRef;
+
+// https://developers.google.com/analytics/devguides/collection/protocol/v1/devguide#social
+class GASocial final : public GATypedHit<GASocial> {
+public:
+	GASocial(const std::string & appName, const std::string & trackingId, const std::string & clientId, const std::string & version,
+		const std::string & network, const std::string & action, const std::string & target, const std::string & customQuery = "") :
+		GATypedHit(appName, trackingId, clientId, version, "social", customQuery),
+		mNetwork(network),
+		mAction(action),
+		mTarget(target)
+	{}
+
+	template <class Visitor>
+	void visitHitParameters(Visitor & visitor) const {
+		visitor.text("&sn=", mNetwork);		// Social network
+		visitor.text("&sa=", mAction);		// Social action
+		visitor.text("&st=", mTarget);		// Social action target
+	}
+
+	const std::string	mNetwork;	//! Mandatory
+	const std::string	mAction;	//! Mandatory
+	const std::string	mTarget;	//! Mandatory
+};
+
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,76 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "GAHit.hpp"
+
+namespace bluecadet {
+namespace analytics {
+typedef std::shared_ptr<class GATransaction> GATransactionRef;
+
+// https://developers.google.com/analytics/devguides/collection/protocol/v1/devguide#ecom
+class GATransaction final : public GATypedHit<GATransaction> {
+public:
+	GATransaction(const std::string & appName, const std::string & trackingId, const std::string & clientId, const std::string & version,
+		const std::string & transactionId, const std::string & affiliation = "", double revenue = -1.0, double shipping = -1.0, double tax = -1.0,
+		const std::string & currencyCode = "", const std::string & customQuery = "") :
+		GATypedHit(appName, trackingId, clientId, version, "transaction", customQuery),
+		mTransactionId(transactionId),
+		mAffiliation(affiliation),
+		mRevenue(revenue),
+		mShipping(shipping),
+		mTax(tax),
+		mCurrencyCode(currencyCode)
+	{}
+
+	template <class Visitor>
+	void visitHitParameters(Visitor & visitor) const {
+		visitor.text("&ti=", mTransactionId);			// Transaction ID
+
+		// Optional values
+		visitor.optionalText("&ta=", mAffiliation);		// Transaction affiliation
+		visitor.optionalDecimal("&tr=", mRevenue);		// Transaction revenue
+		visitor.optionalDecimal("&ts=", mShipping);		// Transaction shipping
+		visitor.optionalDecimal("&tt=", mTax);			// Transaction tax
+		visitor.optionalText("&cu=", mCurrencyCode);	// Currency code
+	}
+
+	const std::string	mTransactionId;		//! Mandatory
+	const std::string	mAffiliation;		//! Optional; Empty string will be omitted
+	const double		mRevenue;			//! Optional; Negative values will be omitted
+	const double		mShipping;			//! Optional; Negative values will be omitted
+	const double		mTax;				//! Optional; Negative values will be omitted
+	const std::string	mCurrencyCode;		//! Optional ISO 4217 code; Empty string will be omitted
+};
+
+} // analytics namespace
+} // bluecadet namespace
@@ -29,13 +29,8 @@
  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-
 #pragma once
 
-#include "cinder/app/App.h"
-#include "cinder/Url.h"
-#include "cinder/Utilities.h"
-
 #include "GAHit.hpp"
 
 namespace bluecadet {
@@ -43,29 +38,25 @@ namespace analytics {
 typedef std::shared_ptr<class GAUserTiming> GAUserTimingRef;
 
 // https://developers.google.com/analytics/devguides/collection/protocol/v1/devguide#usertiming
-class GAUserTiming : public GAHit {
+class GAUserTiming final : public GATypedHit<GAUserTiming> {
 public:
 	GAUserTiming(const std::string & appName, const std::string & trackingId, const std::string & clientId, const std::string & version,
 		const std::string & category, const std::string & variable, int timeInMs, const std::string & label = "", const std::string & customQuery = "") :
-		GAHit(appName, trackingId, clientId, version, "timing", customQuery),
+		GATypedHit(appName, trackingId, clientId, version, "timing", customQuery),
 		mUserTimingCategory(category),
 		mUserTimingVariable(variable),
 		mUserTimingTime(timeInMs),
 		mUserTimingLabel(label)
 	{}
-	virtual ~GAUserTiming() {};
 
-	virtual std::string getPayloadString() const override {
-		std::string result = GAHit::getPayloadString();
-
-		result += "&utc=" + ci::Url::encode(mUserTimingCategory);	// Timing category
-		result += "&utv=" + ci::Url::encode(mUserTimingVariable);	// Timing variable
-		result += "&utt=" + ci::toString(mUserTimingTime);			// Timing time
+	template <class Visitor>
+	void visitHitParameters(Visitor & visitor) const {
+		visitor.text("&utc=", mUserTimingCategory);		// Timing category
+		visitor.text("&utv=", mUserTimingVariable);		// Timing variable
+		visitor.integer("&utt=", mUserTimingTime);		// Timing time
 
 		// Optional values
-		if (!mUserTimingLabel.empty())	result += "&utl=" + ci::Url::encode(mUserTimingLabel);	// Timing label
-
-		return result;
+		visitor.optionalText("&utl=", mUserTimingLabel);	// Timing label
 	}
 
 	const std::string	mUserTimingCategory;		//! Mandatory
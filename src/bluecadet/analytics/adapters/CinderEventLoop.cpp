@@ -0,0 +1,105 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "CinderEventLoop.h"
+
+#include "../utils/StandaloneEventLoop.h"
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace adapters {
+
+CinderEventLoop::CinderEventLoop(ci::app::AppBase * app) :
+	mApp(app),
+	mNextCallbackId(INVALID_CALLBACK_ID + 1)
+{
+}
+
+CinderEventLoop::~CinderEventLoop() {
+	lock_guard<mutex> lock(mMutex);
+	mConnections.clear();
+}
+
+asio::io_service & CinderEventLoop::getIoService() {
+	return mApp->io_service();
+}
+
+utils::EventLoop::CallbackId CinderEventLoop::addUpdateCallback(Callback callback) {
+	lock_guard<mutex> lock(mMutex);
+	const CallbackId id = mNextCallbackId++;
+	mConnections[id] = mApp->getSignalUpdate().connect(callback);
+	return id;
+}
+
+void CinderEventLoop::removeUpdateCallback(const CallbackId id) {
+	lock_guard<mutex> lock(mMutex);
+	mConnections.erase(id); // disconnects
+}
+
+utils::EventLoop::CallbackId CinderEventLoop::addCleanupCallback(Callback callback) {
+	lock_guard<mutex> lock(mMutex);
+	const CallbackId id = mNextCallbackId++;
+	mConnections[id] = mApp->getSignalCleanup().connect(callback);
+	return id;
+}
+
+void CinderEventLoop::removeCleanupCallback(const CallbackId id) {
+	lock_guard<mutex> lock(mMutex);
+	mConnections.erase(id);
+}
+
+} // adapters namespace
+
+namespace utils {
+
+EventLoopRef getDefaultEventLoop() {
+	static mutex defaultLoopMutex;
+	static EventLoopRef defaultLoop;
+
+	lock_guard<mutex> lock(defaultLoopMutex);
+	if (!defaultLoop) {
+		if (AppBase::get()) {
+			defaultLoop = adapters::CinderEventLoop::create(AppBase::get());
+		} else {
+			// e.g. headless tools that link Cinder but don't run an app
+			defaultLoop = make_shared<StandaloneEventLoop>();
+		}
+	}
+	return defaultLoop;
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
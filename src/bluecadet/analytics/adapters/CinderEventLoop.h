@@ -0,0 +1,83 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include "cinder/app/App.h"
+
+#include <map>
+#include <mutex>
+
+#include "../utils/EventLoop.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace adapters {
+
+typedef std::shared_ptr<class CinderEventLoop> CinderEventLoopRef;
+
+/*!
+ Runs the client on a Cinder app: requests complete on the app's io_service (i.e. on the main thread),
+ update callbacks are connected to the app's update signal and cleanup callbacks to its cleanup signal.
+
+ This is the default event loop in Cinder builds whenever an app is running. Not available in
+ standalone builds.
+ */
+class CinderEventLoop : public utils::EventLoop {
+
+public:
+	static CinderEventLoopRef create(ci::app::AppBase * app = ci::app::AppBase::get()) {
+		return CinderEventLoopRef(new CinderEventLoop(app));
+	}
+
+	CinderEventLoop(ci::app::AppBase * app);
+	~CinderEventLoop();
+
+	asio::io_service &	getIoService() override;
+
+	CallbackId			addUpdateCallback(Callback callback) override;
+	void				removeUpdateCallback(const CallbackId id) override;
+
+	CallbackId			addCleanupCallback(Callback callback) override;
+	void				removeCleanupCallback(const CallbackId id) override;
+
+	ci::app::AppBase *	getApp() const { return mApp; }
+
+protected:
+	ci::app::AppBase *	mApp;
+
+	std::mutex			mMutex;
+	std::map<CallbackId, ci::signals::ScopedConnection> mConnections;
+	CallbackId			mNextCallbackId;
+};
+
+} // adapters namespace
+} // analytics namespace
+} // bluecadet namespace
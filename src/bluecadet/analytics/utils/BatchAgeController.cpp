@@ -0,0 +1,156 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "BatchAgeController.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+namespace {
+	const double HIT_RATE_TIME_CONSTANT = 10.0;	//! Seconds over which the hit rate is averaged
+	const size_t NUM_LATENCY_SAMPLES = 128;
+	const double MAX_HITS_PER_BATCH = 20.0;		//! See GABatch::MAX_NUM_HITS
+}
+
+BatchAgeController::BatchAgeController() :
+	mTargetLatency(5.0),
+	mMaxBatchAge(4.0),
+	mDispatchDelay(0.0),
+	mHitRate(0.0),
+	mTimeOfLastHitRateUpdate(0.0)
+{
+}
+
+double BatchAgeController::getTargetLatency() const {
+	lock_guard<mutex> lock(mMutex);
+	return mTargetLatency;
+}
+
+void BatchAgeController::setTargetLatency(const double value) {
+	lock_guard<mutex> lock(mMutex);
+	mTargetLatency = value;
+}
+
+double BatchAgeController::getMaxBatchAge() const {
+	lock_guard<mutex> lock(mMutex);
+	return mMaxBatchAge;
+}
+
+void BatchAgeController::setMaxBatchAge(const double value) {
+	lock_guard<mutex> lock(mMutex);
+	mMaxBatchAge = value;
+}
+
+void BatchAgeController::setDispatchDelay(const double value) {
+	lock_guard<mutex> lock(mMutex);
+	mDispatchDelay = value;
+}
+
+void BatchAgeController::addHits(const size_t numHits, const double time) {
+	lock_guard<mutex> lock(mMutex);
+	decayHitRate(time);
+	mHitRate += (double)numHits / HIT_RATE_TIME_CONSTANT;
+}
+
+void BatchAgeController::addRequestLatency(const double seconds) {
+	lock_guard<mutex> lock(mMutex);
+	mRequestLatencies.add(seconds);
+}
+
+void BatchAgeController::addDeliveryLatency(const double seconds) {
+	lock_guard<mutex> lock(mMutex);
+	mDeliveryLatencies.add(seconds);
+}
+
+BatchAgeController::Decision BatchAgeController::update(const double time) {
+	lock_guard<mutex> lock(mMutex);
+
+	decayHitRate(time);
+
+	Decision decision;
+	decision.hitRate = mHitRate;
+	decision.requestLatency = mRequestLatencies.getPercentile(0.99);
+	decision.deliveryLatency = mDeliveryLatencies.getPercentile(0.99);
+
+	// whatever is left of the target after sending can be spent on batching
+	const double batchingBudget = max(0.0, min(mMaxBatchAge, mTargetLatency - decision.requestLatency - mDispatchDelay));
+
+	// only hold batches if more hits are expected to join them; otherwise waiting adds latency without saving requests
+	const double expectedAdditionalHits = mHitRate * batchingBudget;
+	decision.maxBatchAge = expectedAdditionalHits >= 1.0 ? batchingBudget : 0.0;
+	decision.expectedHitsPerBatch = min(MAX_HITS_PER_BATCH, 1.0 + mHitRate * decision.maxBatchAge);
+
+	mDecision = decision;
+	return decision;
+}
+
+BatchAgeController::Decision BatchAgeController::getDecision() const {
+	lock_guard<mutex> lock(mMutex);
+	return mDecision;
+}
+
+void BatchAgeController::decayHitRate(const double time) {
+	const double elapsed = time - mTimeOfLastHitRateUpdate;
+	if (elapsed > 0.0) {
+		mHitRate *= exp(-elapsed / HIT_RATE_TIME_CONSTANT);
+		mTimeOfLastHitRateUpdate = time;
+	}
+}
+
+void BatchAgeController::SampleWindow::add(const double sample) {
+	if (samples.size() < NUM_LATENCY_SAMPLES) {
+		samples.push_back(sample);
+	} else {
+		samples[next] = sample;
+	}
+	next = (next + 1) % NUM_LATENCY_SAMPLES;
+}
+
+double BatchAgeController::SampleWindow::getPercentile(const double percentile) const {
+	if (samples.empty()) {
+		return 0.0;
+	}
+	vector<double> sorted(samples);
+	const size_t index = min(sorted.size() - 1, (size_t)(percentile * (double)sorted.size()));
+	nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
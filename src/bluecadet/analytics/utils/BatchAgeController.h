@@ -0,0 +1,121 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class BatchAgeController> BatchAgeControllerRef;
+
+/*!
+ Picks how long batches may wait for more hits based on the observed hit rate and request latency.
+
+ Holding a batch only pays off if more hits are likely to join it. The controller therefore spends the
+ latency budget that's left after the p99 request latency on batching, but only if at least one more hit
+ is expected to arrive within that time. During quiet periods hits are sent right away; during busy periods
+ batches are held as long as the delivery latency target allows, which keeps requests per second low.
+
+ All methods are thread-safe.
+ */
+class BatchAgeController {
+
+public:
+	//! The controller's current choice and the observations it was based on.
+	struct Decision {
+		double		maxBatchAge = 0.0;			//! Seconds a batch may wait for more hits before it's sent
+		double		hitRate = 0.0;				//! Recent hits per second
+		double		requestLatency = 0.0;		//! p99 time in seconds from sending a batch to its response
+		double		deliveryLatency = 0.0;		//! Observed p99 time in seconds from tracking a hit to its delivery
+		double		expectedHitsPerBatch = 1.0;	//! Expected batch size with maxBatchAge at the current hit rate
+	};
+
+	BatchAgeController();
+
+	//! Target p99 delivery latency in seconds (from tracking a hit until GA acknowledged it).
+	double		getTargetLatency() const;
+	void		setTargetLatency(const double value);
+
+	//! Upper bound for the batch age, e.g. the client's max batch age.
+	double		getMaxBatchAge() const;
+	void		setMaxBatchAge(const double value);
+
+	//! Delay between a batch expiring and it being sent, e.g. the minimum dispatch interval.
+	void		setDispatchDelay(const double value);
+
+	//! Hits that arrived at time (in seconds).
+	void		addHits(const size_t numHits, const double time);
+
+	//! Time between sending a batch and receiving its response.
+	void		addRequestLatency(const double seconds);
+
+	//! Time between tracking the oldest hit of a batch and its delivery.
+	void		addDeliveryLatency(const double seconds);
+
+	//! Recomputes the decision at time (in seconds).
+	Decision	update(const double time);
+
+	//! The decision made by the last update().
+	Decision	getDecision() const;
+
+protected:
+	//! A fixed number of recent samples
+	struct SampleWindow {
+		std::vector<double>	samples;
+		size_t				next = 0;
+
+		void	add(const double sample);
+		double	getPercentile(const double percentile) const;
+	};
+
+	//! Decays the hit rate to time. Expects mMutex to be locked.
+	void		decayHitRate(const double time);
+
+	mutable std::mutex	mMutex;
+	double			mTargetLatency;
+	double			mMaxBatchAge;
+	double			mDispatchDelay;
+	double			mHitRate;
+	double			mTimeOfLastHitRateUpdate;
+	SampleWindow	mRequestLatencies;
+	SampleWindow	mDeliveryLatencies;
+	Decision		mDecision;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,178 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CircuitBreaker.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+CircuitBreaker::CircuitBreaker() :
+	mState(CLOSED),
+	mFailureThreshold(5),
+	mNumConsecutiveFailures(0),
+	mMinProbeInterval(1.0),
+	mMaxProbeInterval(300.0),
+	mProbeInterval(1.0),
+	mTimeOfNextProbe(0.0),
+	mProbeId(0),
+	mRandom(random_device()())
+{
+}
+
+int CircuitBreaker::getFailureThreshold() const {
+	lock_guard<mutex> lock(mMutex);
+	return mFailureThreshold;
+}
+
+void CircuitBreaker::setFailureThreshold(const int value) {
+	lock_guard<mutex> lock(mMutex);
+	mFailureThreshold = value;
+}
+
+double CircuitBreaker::getMinProbeInterval() const {
+	lock_guard<mutex> lock(mMutex);
+	return mMinProbeInterval;
+}
+
+void CircuitBreaker::setMinProbeInterval(const double value) {
+	lock_guard<mutex> lock(mMutex);
+	mMinProbeInterval = value;
+}
+
+double CircuitBreaker::getMaxProbeInterval() const {
+	lock_guard<mutex> lock(mMutex);
+	return mMaxProbeInterval;
+}
+
+void CircuitBreaker::setMaxProbeInterval(const double value) {
+	lock_guard<mutex> lock(mMutex);
+	mMaxProbeInterval = value;
+}
+
+CircuitBreaker::Permission CircuitBreaker::requestPermission(const double time, uint64_t * probeId) {
+	lock_guard<mutex> lock(mMutex);
+
+	switch (mState) {
+		case CLOSED:
+			return ALLOW_ALL;
+
+		case OPEN:
+			if (time >= mTimeOfNextProbe) {
+				mState = HALF_OPEN;
+				mProbeId++;
+				if (probeId) {
+					*probeId = mProbeId;
+				}
+				return ALLOW_PROBE;
+			}
+			return DENY;
+
+		case HALF_OPEN:
+		default:
+			return DENY;
+	}
+}
+
+CircuitBreaker::State CircuitBreaker::recordSuccess() {
+	lock_guard<mutex> lock(mMutex);
+	const State previousState = mState;
+	mState = CLOSED;
+	mNumConsecutiveFailures = 0;
+	mProbeInterval = mMinProbeInterval;
+	return previousState;
+}
+
+CircuitBreaker::State CircuitBreaker::recordFailure(const double time, const uint64_t probeId) {
+	lock_guard<mutex> lock(mMutex);
+
+	const State previousState = mState;
+	mNumConsecutiveFailures++;
+
+	switch (previousState) {
+		case CLOSED:
+			if (mFailureThreshold > 0 && mNumConsecutiveFailures >= mFailureThreshold) {
+				mProbeInterval = mMinProbeInterval;
+				open(time);
+			}
+			break;
+
+		case HALF_OPEN:
+			if (probeId != mProbeId) {
+				// a request that was already in flight when the circuit opened; the probe is still pending
+				return OPEN;
+			}
+			// probe failed
+			open(time);
+			break;
+
+		case OPEN:
+		default:
+			// requests that were already in flight when the circuit opened
+			break;
+	}
+
+	return previousState;
+}
+
+void CircuitBreaker::reset() {
+	lock_guard<mutex> lock(mMutex);
+	mState = CLOSED;
+	mNumConsecutiveFailures = 0;
+	mProbeInterval = mMinProbeInterval;
+	mTimeOfNextProbe = 0.0;
+}
+
+int CircuitBreaker::getNumConsecutiveFailures() const {
+	lock_guard<mutex> lock(mMutex);
+	return mNumConsecutiveFailures;
+}
+
+double CircuitBreaker::getTimeOfNextProbe() const {
+	lock_guard<mutex> lock(mMutex);
+	return mTimeOfNextProbe;
+}
+
+void CircuitBreaker::open(const double time) {
+	const double interval = min(mProbeInterval, mMaxProbeInterval);
+	mTimeOfNextProbe = time + uniform_real_distribution<double>(0.5 * interval, interval)(mRandom);
+	mProbeInterval = min(mProbeInterval * 2.0, mMaxProbeInterval);
+	mState = OPEN;
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
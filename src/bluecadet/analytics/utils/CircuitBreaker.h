@@ -0,0 +1,128 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class CircuitBreaker> CircuitBreakerRef;
+
+/*!
+ Transport-level circuit breaker.
+
+ Counts consecutive failed requests. Once the failure threshold is reached, the circuit opens and no requests
+ should be sent, except for a single probe once the probe interval has passed. The probe interval doubles
+ with every failed probe and is jittered so that many clients don't retry in lockstep. The first success
+ closes the circuit again.
+
+ Each probe gets an id from requestPermission() that its failure is reported with. Requests that were
+ already in flight when the circuit opened can't be mistaken for the probe and reopen the circuit early.
+
+ All methods are thread-safe.
+ */
+class CircuitBreaker {
+
+public:
+	enum State {
+		CLOSED,		//! Requests are sent normally
+		OPEN,		//! Requests are held back until the next probe is due
+		HALF_OPEN	//! A probe is in flight; requests are held back until it completes
+	};
+
+	enum Permission {
+		ALLOW_ALL,		//! Send as many requests as needed
+		ALLOW_PROBE,	//! Send exactly one request as a probe
+		DENY			//! Don't send anything
+	};
+
+	CircuitBreaker();
+
+	//! Number of consecutive failures that open the circuit. Defaults to 5. 0 disables the circuit breaker.
+	int			getFailureThreshold() const;
+	void		setFailureThreshold(const int value);
+
+	//! Interval in seconds before the first probe. Doubles with each failed probe up to the max interval.
+	//! Defaults to 1 and 300 seconds. Probes are sent after a random delay between 50% and 100% of the interval.
+	double		getMinProbeInterval() const;
+	void		setMinProbeInterval(const double value);
+	double		getMaxProbeInterval() const;
+	void		setMaxProbeInterval(const double value);
+
+	//! Whether requests may be sent at time. Returns ALLOW_PROBE once per probe interval while open,
+	//! after which the circuit is half-open until recordSuccess() or the probe's recordFailure() is called.
+	//! probeId receives the probe's id if ALLOW_PROBE is returned.
+	Permission	requestPermission(const double time, uint64_t * probeId = nullptr);
+
+	//! Closes the circuit. Returns the state before the success.
+	State		recordSuccess();
+
+	//! Counts a failure at time and opens the circuit if needed. Pass the id from requestPermission() if the
+	//! failed request was a probe; only that probe's failure reopens a half-open circuit. Returns the state
+	//! before the failure, i.e. CLOSED if the failure wasn't already attributed to an outage and HALF_OPEN
+	//! only for the current probe. Other failures while half-open return OPEN.
+	State		recordFailure(const double time, const uint64_t probeId = 0);
+
+	//! Closes the circuit and forgets all failures.
+	void		reset();
+
+	State		getState() const { return mState; }
+	bool		isClosed() const { return mState == CLOSED; }
+	int			getNumConsecutiveFailures() const;
+	double		getTimeOfNextProbe() const;
+
+protected:
+	//! Schedules the next probe and increases the probe interval. Expects mMutex to be locked.
+	void		open(const double time);
+
+	mutable std::mutex	mMutex;
+	std::atomic<State>	mState;
+	int					mFailureThreshold;
+	int					mNumConsecutiveFailures;
+	double				mMinProbeInterval;
+	double				mMaxProbeInterval;
+	double				mProbeInterval;		//! Interval used for the next probe
+	double				mTimeOfNextProbe;
+	uint64_t			mProbeId;			//! Id of the current or last probe; 0 before the first one
+	std::minstd_rand	mRandom;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
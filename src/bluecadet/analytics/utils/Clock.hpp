@@ -0,0 +1,71 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+//! Returns the current time in seconds. Must be monotonic and safe to call from any thread.
+typedef double (*ClockFunction)();
+
+//! Monotonic time in seconds since the first call, based on std::chrono::steady_clock. The default clock.
+inline double getSteadyClockSeconds() {
+	typedef std::chrono::steady_clock Clock;
+	static const Clock::time_point startTime = Clock::now();
+	return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+inline std::atomic<ClockFunction> & getClockFunction() {
+	static std::atomic<ClockFunction> clockFunction(&getSteadyClockSeconds);
+	return clockFunction;
+}
+
+//! Replaces the clock used for hit timestamps, batch ages, retry delays and idle connection timeouts,
+//! e.g. with a simulated clock that can be advanced manually. Pass nullptr to restore the steady clock.
+//! Thread pools still wait in real time, so a simulated clock only affects when work is considered due.
+inline void setClock(ClockFunction clockFunction) {
+	getClockFunction() = clockFunction ? clockFunction : &getSteadyClockSeconds;
+}
+
+//! Current time in seconds of the active clock (see setClock()). Used instead of ci::app::getElapsedSeconds()
+//! so that hits and batches don't depend on a running app.
+inline double getElapsedSeconds() {
+	return getClockFunction().load(std::memory_order_relaxed)();
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
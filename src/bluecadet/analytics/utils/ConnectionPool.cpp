@@ -0,0 +1,154 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ConnectionPool.h"
+#include "Clock.hpp"
+
+#include <iostream>
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+ConnectionPool::ConnectionPool(const size_t maxIdleConnectionsPerHost, const double idleTimeout) :
+	mMaxIdleConnectionsPerHost(maxIdleConnectionsPerHost),
+	mIdleTimeout(idleTimeout),
+	mNumNewConnections(0),
+	mNumReusedConnections(0),
+	mNumExpiredConnections(0)
+{
+}
+
+ConnectionPool::~ConnectionPool() {
+	clear();
+}
+
+SocketRef ConnectionPool::acquire(const std::string & host, const int port) {
+	lock_guard<mutex> lock(mMutex);
+
+	auto it = mIdleSockets.find(getKey(host, port));
+	if (it == mIdleSockets.end()) {
+		return nullptr;
+	}
+
+	IdleSocketQueue & sockets = it->second;
+	removeExpiredSockets(sockets, utils::getElapsedSeconds());
+
+	// hand out the most recently used connection first since it's the least likely to have been closed by the server
+	while (!sockets.empty()) {
+		SocketRef socket = sockets.back().socket;
+		sockets.pop_back();
+
+		if (isOpen(socket)) {
+			mNumReusedConnections++;
+			return socket;
+		}
+
+		mNumExpiredConnections++;
+	}
+
+	return nullptr;
+}
+
+void ConnectionPool::release(const std::string & host, const int port, SocketRef socket) {
+	if (!isOpen(socket)) {
+		return;
+	}
+
+	lock_guard<mutex> lock(mMutex);
+
+	const double currentTime = utils::getElapsedSeconds();
+	IdleSocketQueue & sockets = mIdleSockets[getKey(host, port)];
+	sockets.push_back({socket, currentTime});
+	removeExpiredSockets(sockets, currentTime);
+}
+
+void ConnectionPool::clear() {
+	lock_guard<mutex> lock(mMutex);
+
+	for (auto & kvp : mIdleSockets) {
+		for (auto & idleSocket : kvp.second) {
+			closeSocket(idleSocket.socket);
+		}
+	}
+
+	mIdleSockets.clear();
+}
+
+ConnectionPool::Stats ConnectionPool::getStats() {
+	Stats stats;
+	stats.numNewConnections = mNumNewConnections;
+	stats.numReusedConnections = mNumReusedConnections;
+	stats.numExpiredConnections = mNumExpiredConnections;
+
+	lock_guard<mutex> lock(mMutex);
+	for (const auto & kvp : mIdleSockets) {
+		stats.numIdleConnections += kvp.second.size();
+	}
+
+	return stats;
+}
+
+void ConnectionPool::removeExpiredSockets(IdleSocketQueue & sockets, const double currentTime) {
+	const double idleTimeout = mIdleTimeout;
+	const size_t maxNumSockets = mMaxIdleConnectionsPerHost;
+
+	// connections are ordered by release time, so expired connections are always at the front
+	while (!sockets.empty() && (sockets.size() > maxNumSockets || currentTime - sockets.front().timeReleased > idleTimeout)) {
+		closeSocket(sockets.front().socket);
+		sockets.pop_front();
+		mNumExpiredConnections++;
+	}
+}
+
+bool ConnectionPool::isOpen(const SocketRef & socket) {
+	return socket && socket->is_open();
+}
+
+void ConnectionPool::closeSocket(const SocketRef & socket) {
+	if (!socket) {
+		return;
+	}
+
+	asio::error_code ec;
+	socket->shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+	socket->close(ec);
+
+	if (ec) {
+		cout << "ConnectionPool: Error on close: " << ec.message() << endl;
+	}
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,123 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "Platform.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class ConnectionPool> ConnectionPoolRef;
+typedef std::shared_ptr<asio::ip::tcp::socket> SocketRef;
+
+/*!
+ Keeps idle, persistent TCP connections around so that subsequent HTTP requests to the same host
+ can skip DNS resolution, the TCP handshake and slow start.
+
+ Connections are pooled per host and port. Connections that have been idle for longer than the idle timeout
+ are closed and discarded the next time the pool is accessed. If more than the max number of idle
+ connections is returned for a host, the oldest ones are closed.
+
+ All methods are thread-safe.
+ */
+class ConnectionPool {
+
+public:
+	struct Stats {
+		size_t numNewConnections = 0;		//! Number of connections that were opened from scratch
+		size_t numReusedConnections = 0;	//! Number of connections that were handed out from the pool
+		size_t numExpiredConnections = 0;	//! Number of idle connections that were closed because they timed out or exceeded the pool size
+		size_t numIdleConnections = 0;		//! Number of connections currently held by the pool
+	};
+
+	ConnectionPool(const size_t maxIdleConnectionsPerHost = 4, const double idleTimeout = 30.0);
+	~ConnectionPool();
+
+	//! Returns an open, idle connection for host and port or nullptr if none is available.
+	SocketRef				acquire(const std::string & host, const int port);
+
+	//! Returns a connection to the pool. The connection must not have any pending reads or writes.
+	void					release(const std::string & host, const int port, SocketRef socket);
+
+	//! Call whenever a new connection was opened for a request that will be released to this pool.
+	void					addNewConnection() { mNumNewConnections++; }
+
+	//! Closes and removes all idle connections.
+	void					clear();
+
+	Stats					getStats();
+
+	//! The max number of idle connections kept per host. Defaults to 4.
+	size_t					getMaxIdleConnectionsPerHost() const { return mMaxIdleConnectionsPerHost; }
+	void					setMaxIdleConnectionsPerHost(const size_t value) { mMaxIdleConnectionsPerHost = value; }
+
+	//! Idle connections are closed after this many seconds. Should be lower than the server's keep-alive timeout. Defaults to 30.
+	double					getIdleTimeout() const { return mIdleTimeout; }
+	void					setIdleTimeout(const double value) { mIdleTimeout = value; }
+
+protected:
+	struct IdleSocket {
+		SocketRef	socket;
+		double		timeReleased;
+	};
+
+	typedef std::deque<IdleSocket> IdleSocketQueue;
+
+	static std::string		getKey(const std::string & host, const int port) { return host + ":" + std::to_string(port); }
+	static bool				isOpen(const SocketRef & socket);
+	static void				closeSocket(const SocketRef & socket);
+
+	//! Removes expired connections. mMutex must be locked.
+	void					removeExpiredSockets(IdleSocketQueue & sockets, const double currentTime);
+
+	std::mutex				mMutex;
+	std::map<std::string, IdleSocketQueue> mIdleSockets; // newest connections at the back
+
+	std::atomic<size_t>		mMaxIdleConnectionsPerHost;
+	std::atomic<double>		mIdleTimeout;
+
+	std::atomic<size_t>		mNumNewConnections;
+	std::atomic<size_t>		mNumReusedConnections;
+	std::atomic<size_t>		mNumExpiredConnections;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
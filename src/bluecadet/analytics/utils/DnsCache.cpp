@@ -0,0 +1,285 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "DnsCache.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Clock.hpp"
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+namespace {
+	const double LOOKUP_TIMEOUT = 60.0;	//! Seconds after which a pending query is assumed lost (e.g. because its io_service was stopped)
+}
+
+DnsCacheRef DnsCache::getInstance() {
+	static DnsCacheRef instance = make_shared<DnsCache>();
+	return instance;
+}
+
+DnsCache::DnsCache(const double ttl, const double refreshTime) :
+	mNextLookupId(1),
+	mTtl(ttl),
+	mRefreshTime(refreshTime),
+	mNumHits(0),
+	mNumMisses(0),
+	mNumFallbacks(0),
+	mNumRefreshes(0),
+	mNumFailures(0)
+{
+}
+
+void DnsCache::resolve(asio::io_service & io, const std::string & host, const int port, Callback callback) {
+	const double currentTime = utils::getElapsedSeconds();
+	const double ttl = mTtl;
+
+	lock_guard<mutex> lock(mMutex);
+	Entry & entry = mEntries[getKey(host, port)];
+	entry.host = host;
+	entry.port = port;
+	entry.timeLastUsed = currentTime;
+
+	if (entry.isLookupPending && currentTime - entry.timeLookupStarted > LOOKUP_TIMEOUT) {
+		entry.isLookupPending = false;
+	}
+
+	if (entry.endpoints && currentTime - entry.timeResolved < ttl) {
+		mNumHits++;
+
+		// the refresh timer didn't run, e.g. because its io_service was cancelled
+		if (!entry.isLookupPending && currentTime - entry.timeResolved >= ttl - mRefreshTime) {
+			mNumRefreshes++;
+			lookup(entry, io);
+		}
+
+		EndpointListRef endpoints = entry.endpoints;
+		io.post([callback, endpoints] {
+			callback(asio::error_code(), endpoints);
+		});
+		return;
+	}
+
+	// expired or unknown, so wait for a fresh lookup
+	mNumMisses++;
+	entry.pendingCallbacks.push_back({&io, callback});
+
+	if (!entry.isLookupPending) {
+		lookup(entry, io);
+	}
+}
+
+void DnsCache::cancel(asio::io_service & io) {
+	lock_guard<mutex> lock(mMutex);
+
+	for (auto & kvp : mEntries) {
+		Entry & entry = kvp.second;
+		auto & callbacks = entry.pendingCallbacks;
+
+		callbacks.erase(remove_if(callbacks.begin(), callbacks.end(), [&io] (const PendingCallback & pending) {
+			return pending.io == &io;
+		}), callbacks.end());
+
+		if (entry.lookupIo != &io) {
+			continue;
+		}
+
+		// results and timers that still arrive on io are ignored from here on
+		entry.lookupId = 0;
+		entry.lookupIo = nullptr;
+		entry.isLookupPending = false;
+
+		if (entry.refreshTimer) {
+			entry.refreshTimer->cancel();
+			entry.refreshTimer = nullptr;
+		}
+
+		if (!callbacks.empty()) {
+			lookup(entry, *callbacks.front().io);
+		}
+	}
+}
+
+void DnsCache::clear() {
+	lock_guard<mutex> lock(mMutex);
+
+	for (auto it = mEntries.begin(); it != mEntries.end();) {
+		if (it->second.isLookupPending) {
+			// keep the entry so that its callbacks are still called
+			it->second.endpoints = nullptr;
+			++it;
+		} else {
+			if (it->second.refreshTimer) {
+				it->second.refreshTimer->cancel();
+			}
+			it = mEntries.erase(it);
+		}
+	}
+}
+
+DnsCache::Stats DnsCache::getStats() {
+	Stats stats;
+	stats.numHits = mNumHits;
+	stats.numMisses = mNumMisses;
+	stats.numFallbacks = mNumFallbacks;
+	stats.numRefreshes = mNumRefreshes;
+	stats.numFailures = mNumFailures;
+
+	lock_guard<mutex> lock(mMutex);
+	stats.numHosts = mEntries.size();
+
+	return stats;
+}
+
+void DnsCache::lookup(Entry & entry, asio::io_service & io) {
+	if (entry.refreshTimer) {
+		entry.refreshTimer->cancel();
+		entry.refreshTimer = nullptr;
+	}
+
+	entry.isLookupPending = true;
+	entry.timeLookupStarted = utils::getElapsedSeconds();
+	entry.lookupId = mNextLookupId++;
+	entry.lookupIo = &io;
+
+	auto self = shared_from_this();
+	auto resolver = make_shared<asio::ip::tcp::resolver>(io);
+	const string key = getKey(entry.host, entry.port);
+	const uint64_t lookupId = entry.lookupId;
+
+	resolver->async_resolve(asio::ip::tcp::resolver::query(entry.host, to_string(entry.port)), [self, resolver, key, lookupId] (const asio::error_code & ec, asio::ip::tcp::resolver::iterator it) {
+		auto endpoints = make_shared<EndpointList>();
+		for (; !ec && it != asio::ip::tcp::resolver::iterator(); ++it) {
+			endpoints->push_back(it->endpoint());
+		}
+		self->handleLookup(key, lookupId, ec, endpoints);
+	});
+}
+
+void DnsCache::handleLookup(const std::string & key, const uint64_t lookupId, const asio::error_code & ec, EndpointListRef endpoints) {
+	vector<PendingCallback> callbacks;
+	EndpointListRef result;
+	asio::error_code error = ec;
+
+	{
+		lock_guard<mutex> lock(mMutex);
+		auto it = mEntries.find(key);
+
+		if (it == mEntries.end() || it->second.lookupId != lookupId) {
+			return; // cancelled or superseded
+		}
+
+		Entry & entry = it->second;
+		entry.isLookupPending = false;
+		callbacks.swap(entry.pendingCallbacks);
+
+		if (!ec && !endpoints->empty()) {
+			entry.endpoints = endpoints;
+			entry.timeResolved = utils::getElapsedSeconds();
+			scheduleRefresh(entry);
+
+		} else {
+			mNumFailures++;
+
+			if (!error) {
+				error = asio::error::host_not_found;
+			}
+
+			if (entry.endpoints) {
+				// keep using the last known good addresses for another refresh period, then try again in the foreground
+				const double currentTime = utils::getElapsedSeconds();
+				if (currentTime - entry.timeResolved >= mTtl) {
+					entry.timeResolved = currentTime - mTtl + mRefreshTime;
+				}
+				mNumFallbacks += callbacks.size();
+				error = asio::error_code();
+			}
+		}
+
+		result = entry.endpoints;
+	}
+
+	for (auto & pending : callbacks) {
+		Callback callback = pending.callback;
+		pending.io->post([callback, error, result] {
+			callback(error, result);
+		});
+	}
+}
+
+void DnsCache::scheduleRefresh(Entry & entry) {
+	if (!entry.lookupIo) {
+		return;
+	}
+
+	const double delay = max(0.0, entry.timeResolved + mTtl - mRefreshTime - utils::getElapsedSeconds());
+
+	auto self = shared_from_this();
+	auto timer = make_shared<asio::steady_timer>(*entry.lookupIo);
+	const string key = getKey(entry.host, entry.port);
+	const uint64_t lookupId = entry.lookupId;
+
+	timer->expires_from_now(chrono::duration_cast<asio::steady_timer::duration>(chrono::duration<double>(delay)));
+	timer->async_wait([self, timer, key, lookupId] (const asio::error_code & ec) {
+		if (!ec) {
+			self->handleRefresh(key, lookupId);
+		}
+	});
+
+	entry.refreshTimer = timer;
+}
+
+void DnsCache::handleRefresh(const std::string & key, const uint64_t lookupId) {
+	lock_guard<mutex> lock(mMutex);
+	auto it = mEntries.find(key);
+
+	if (it == mEntries.end() || it->second.lookupId != lookupId || it->second.isLookupPending || !it->second.lookupIo) {
+		return; // cancelled, cleared or already being refreshed
+	}
+
+	Entry & entry = it->second;
+	entry.refreshTimer = nullptr;
+
+	// only keep hosts fresh that are still in use; others are looked up again on their next use
+	if (utils::getElapsedSeconds() - entry.timeLastUsed < mTtl) {
+		mNumRefreshes++;
+		lookup(entry, *entry.lookupIo);
+	}
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
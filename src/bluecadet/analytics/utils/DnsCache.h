@@ -0,0 +1,159 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class DnsCache> DnsCacheRef;
+
+/*!
+ Caches host name lookups so that new connections don't have to wait for DNS.
+
+ Addresses are cached per host and port for the TTL. Hosts that have been used within the last TTL are
+ looked up again on a timer the refresh time before their addresses expire, so hosts that are used regularly
+ never have to wait. If that timer couldn't run (e.g. its io_service was cancelled), an entry that is used within
+ the refresh time before it expires is renewed instead. Concurrent lookups of the same host share a single DNS query.
+
+ If DNS fails, the last known good addresses are handed out instead of an error and the lookup is
+ retried in the background. Only hosts that have never been resolved fail.
+
+ Queries, refresh timers and callbacks run on the io_services passed to resolve(). Since the cache outlives
+ them, an io_service must be passed to cancel() before it's destroyed (StandaloneEventLoop does so when it stops).
+
+ System resolvers don't expose record TTLs, so the TTL is a fixed setting. All methods are thread-safe.
+ */
+class DnsCache : public std::enable_shared_from_this<DnsCache> {
+
+public:
+	typedef std::vector<asio::ip::tcp::endpoint> EndpointList;
+	typedef std::shared_ptr<const EndpointList> EndpointListRef;
+	typedef std::function<void(const asio::error_code & ec, EndpointListRef endpoints)> Callback;
+
+	struct Stats {
+		size_t numHits = 0;			//! Lookups that were answered from the cache
+		size_t numMisses = 0;		//! Lookups that had to wait for DNS
+		size_t numFallbacks = 0;	//! Misses that were answered with the last known good addresses because DNS failed
+		size_t numRefreshes = 0;	//! Background lookups that renewed an entry before it expired
+		size_t numFailures = 0;		//! DNS queries that failed, including background refreshes
+		size_t numHosts = 0;		//! Hosts currently in the cache
+
+		double getHitRate() const { return numHits + numMisses > 0 ? (double)numHits / (double)(numHits + numMisses) : 0.0; }
+	};
+
+	//! Shared instance that requests use unless they're given a different cache.
+	static DnsCacheRef getInstance();
+
+	DnsCache(const double ttl = 300.0, const double refreshTime = 30.0);
+
+	//! Calls callback with the addresses of host on io. The callback is never called from within resolve().
+	//! DNS queries run on the io_service of the first caller that needs them.
+	void					resolve(asio::io_service & io, const std::string & host, const int port, Callback callback);
+
+	//! Drops all callbacks that are waiting to be posted to io and stops using io for queries and refresh timers.
+	//! Must be called before io is destroyed. Queries that were running on io are restarted on the io_service of
+	//! another waiting caller, if any. Callbacks that have already been posted to io aren't affected.
+	void					cancel(asio::io_service & io);
+
+	//! Removes all addresses. Lookups that are in progress still complete.
+	void					clear();
+
+	Stats					getStats();
+
+	//! Seconds that addresses are cached for. Defaults to 300.
+	double					getTtl() const { return mTtl; }
+	void					setTtl(const double value) { mTtl = value; }
+
+	//! Entries are refreshed in the background this many seconds before they expire.
+	//! Also how long the last known good addresses are used after a failed lookup before trying again in the foreground. Defaults to 30.
+	double					getRefreshTime() const { return mRefreshTime; }
+	void					setRefreshTime(const double value) { mRefreshTime = value; }
+
+protected:
+	struct PendingCallback {
+		asio::io_service *	io;
+		Callback			callback;
+	};
+
+	struct Entry {
+		std::string			host;
+		int					port = 0;
+		EndpointListRef		endpoints;			// last known good addresses or nullptr
+		double				timeResolved = 0.0;
+		double				timeLastUsed = 0.0;
+		bool				isLookupPending = false;
+		double				timeLookupStarted = 0.0;
+		uint64_t			lookupId = 0;		// results and timers of older lookups are ignored
+		asio::io_service *	lookupIo = nullptr;	// runs the pending query or the refresh timer; nullptr once cancelled
+		std::shared_ptr<asio::steady_timer> refreshTimer;
+		std::vector<PendingCallback> pendingCallbacks; // waiting for the pending lookup
+	};
+
+	static std::string		getKey(const std::string & host, const int port) { return host + ":" + std::to_string(port); }
+
+	//! Starts a DNS query for entry on io. mMutex must be locked.
+	void					lookup(Entry & entry, asio::io_service & io);
+	void					handleLookup(const std::string & key, const uint64_t lookupId, const asio::error_code & ec, EndpointListRef endpoints);
+
+	//! Starts a timer that refreshes entry before it expires if it's still in use. mMutex must be locked.
+	void					scheduleRefresh(Entry & entry);
+	void					handleRefresh(const std::string & key, const uint64_t lookupId);
+
+	std::mutex				mMutex;
+	std::map<std::string, Entry> mEntries;
+	uint64_t				mNextLookupId;
+
+	std::atomic<double>		mTtl;
+	std::atomic<double>		mRefreshTime;
+
+	std::atomic<size_t>		mNumHits;
+	std::atomic<size_t>		mNumMisses;
+	std::atomic<size_t>		mNumFallbacks;
+	std::atomic<size_t>		mNumRefreshes;
+	std::atomic<size_t>		mNumFailures;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,92 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "Platform.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class EventLoop> EventLoopRef;
+
+/*!
+ The loop that network requests complete on and that drives update-based dispatching.
+
+ Abstracts the host application so that the client doesn't depend on Cinder: CinderEventLoop
+ (see adapters/) runs on the app's io_service and update/cleanup signals, StandaloneEventLoop
+ runs its own io_service on a background thread. Custom implementations can be passed to
+ AnalyticsClient::setEventLoop(), e.g. to share an io_service with other parts of an app. Implementations
+ whose io_service is destroyed while the process keeps running need to pass it to DnsCache::cancel() first.
+
+ All methods must be thread-safe.
+ */
+class EventLoop {
+
+public:
+	typedef std::function<void(void)> Callback;
+	typedef uint64_t CallbackId;
+	static const CallbackId INVALID_CALLBACK_ID = 0;
+
+	virtual ~EventLoop() {}
+
+	//! The io_service that sockets are created on. Completion handlers run on whichever thread runs it.
+	virtual asio::io_service &	getIoService() = 0;
+
+	//! Calls callback regularly (e.g. once per frame) until it's removed.
+	virtual CallbackId			addUpdateCallback(Callback callback) = 0;
+	virtual void				removeUpdateCallback(const CallbackId id) = 0;
+
+	//! Calls callback once before the loop shuts down (e.g. on app cleanup) unless it's removed before.
+	virtual CallbackId			addCleanupCallback(Callback callback) = 0;
+	virtual void				removeCleanupCallback(const CallbackId id) = 0;
+
+	//! Runs all ready handlers on the calling thread. Used to make progress when the loop
+	//! itself might not run anymore, e.g. while draining during app cleanup.
+	virtual void				poll() { getIoService().poll(); }
+
+	//! Whether the loop runs its io_service on a thread of its own. poll() must not be called on
+	//! such loops since handlers would then run on two threads at once.
+	virtual bool				isRunningOwnThread() const { return false; }
+};
+
+//! Shared loop used by clients that haven't been given one. This is the running app's loop in Cinder
+//! builds (see adapters/CinderEventLoop) and a StandaloneEventLoop otherwise.
+EventLoopRef getDefaultEventLoop();
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,384 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "HitJournal.h"
+
+#include "Log.h"
+
+#include <fstream>
+#include <iomanip>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+namespace {
+	const string SEGMENT_PREFIX = "journal-";
+	const string SEGMENT_EXTENSION = ".log";
+	const size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+	void syncFile(FILE * file) {
+		fflush(file);
+#if defined(_WIN32)
+		_commit(_fileno(file));
+#else
+		fsync(fileno(file));
+#endif
+	}
+
+	void removeFile(const fs::path & path) {
+		try {
+			fs::remove(path);
+		} catch (std::exception & e) {
+			CI_LOG_EXCEPTION("Could not remove journal segment '" << path << "'", e);
+		}
+	}
+}
+
+HitJournal::HitJournal() :
+	mMaxSegmentSize(1024 * 1024),
+	mFile(nullptr),
+	mNextId(1),
+	mNumPendingHits(0),
+	mNeedsSync(false)
+{
+}
+
+HitJournal::~HitJournal() {
+	close();
+}
+
+bool HitJournal::open(const fs::path & directory, const size_t maxSegmentSize) {
+	lock_guard<mutex> lock(mMutex);
+
+	closeSegment();
+	mSegments.clear();
+	mRecoveredRecords.clear();
+	mNumPendingHits = 0;
+	mNextId = 1;
+
+	mDirectory = directory;
+	mMaxSegmentSize = maxSegmentSize;
+
+	try {
+		fs::create_directories(mDirectory);
+
+		// find existing segments
+		for (fs::directory_iterator it(mDirectory), end; it != end; ++it) {
+			const string filename = it->path().filename().string();
+			if (filename.size() <= SEGMENT_PREFIX.size() + SEGMENT_EXTENSION.size() ||
+				filename.compare(0, SEGMENT_PREFIX.size(), SEGMENT_PREFIX) != 0 ||
+				it->path().extension().string() != SEGMENT_EXTENSION) {
+				continue;
+			}
+
+			Segment segment;
+			segment.index = stoull(it->path().stem().string().substr(SEGMENT_PREFIX.size()));
+			segment.path = it->path();
+			segment.firstId = 0;
+			segment.lastId = 0;
+			segment.numPending = 0;
+			segment.size = (size_t)fs::file_size(it->path());
+			mSegments.push_back(segment);
+		}
+
+	} catch (std::exception & e) {
+		CI_LOG_EXCEPTION("Could not open journal at '" << mDirectory << "'", e);
+		mSegments.clear();
+		return false;
+	}
+
+	sort(mSegments.begin(), mSegments.end(), [](const Segment & a, const Segment & b) { return a.index < b.index; });
+
+	// recover hits and acknowledgements from previous sessions
+	map<uint64_t, Record> hits;
+	set<uint64_t> acknowledgedIds;
+	vector<vector<uint64_t>> hitIdsPerSegment(mSegments.size());
+
+	for (size_t i = 0; i < mSegments.size(); ++i) {
+		scanSegment(mSegments[i], hits, acknowledgedIds, hitIdsPerSegment[i]);
+	}
+
+	for (size_t i = 0; i < mSegments.size(); ++i) {
+		for (const auto id : hitIdsPerSegment[i]) {
+			if (acknowledgedIds.find(id) == acknowledgedIds.end()) {
+				mSegments[i].numPending++;
+			}
+		}
+		mNumPendingHits += mSegments[i].numPending;
+	}
+
+	for (auto & hit : hits) {
+		if (acknowledgedIds.find(hit.first) == acknowledgedIds.end()) {
+			mRecoveredRecords.push_back(std::move(hit.second));
+		}
+	}
+
+	if (!hits.empty()) {
+		mNextId = hits.rbegin()->first + 1;
+	}
+
+	// never append to existing segments since their last record might be incomplete
+	if (!openNewSegment()) {
+		mSegments.clear();
+		mRecoveredRecords.clear();
+		mNumPendingHits = 0;
+		return false;
+	}
+
+	removeAcknowledgedSegments();
+
+	CI_LOG_I("Opened journal at '" << mDirectory << "' with " << to_string(mRecoveredRecords.size()) << " pending hits");
+
+	return true;
+}
+
+void HitJournal::close() {
+	lock_guard<mutex> lock(mMutex);
+	closeSegment();
+	mSegments.clear();
+	mRecoveredRecords.clear();
+	mNumPendingHits = 0;
+}
+
+bool HitJournal::isOpen() const {
+	lock_guard<mutex> lock(mMutex);
+	return mFile != nullptr;
+}
+
+std::vector<HitJournal::Record> HitJournal::readPendingRecords() {
+	lock_guard<mutex> lock(mMutex);
+	vector<Record> records;
+	records.swap(mRecoveredRecords);
+	return records;
+}
+
+uint64_t HitJournal::append(const int64_t timestampMs, const std::string & payload) {
+	lock_guard<mutex> lock(mMutex);
+
+	if (!mFile) {
+		return 0;
+	}
+
+	const uint64_t id = mNextId++;
+
+	stringstream line;
+	line << "H " << id << " " << timestampMs << " " << hex << hashPayload(payload) << dec << " " << payload;
+	writeLine(line.str());
+
+	Segment & segment = mSegments.back();
+	if (segment.lastId == 0) {
+		segment.firstId = id;
+	}
+	segment.lastId = id;
+	segment.numPending++;
+	mNumPendingHits++;
+
+	if (segment.size >= mMaxSegmentSize) {
+		closeSegment();
+		openNewSegment();
+	}
+
+	return id;
+}
+
+void HitJournal::acknowledge(const std::vector<uint64_t> & ids) {
+	lock_guard<mutex> lock(mMutex);
+
+	string line = "A";
+
+	for (const auto id : ids) {
+		Segment * segment = findSegment(id);
+		if (!segment || segment->numPending == 0) {
+			continue;
+		}
+		segment->numPending--;
+		mNumPendingHits--;
+		line += " " + to_string(id);
+	}
+
+	if (!mFile || line.size() <= 1) {
+		return;
+	}
+
+	writeLine(line);
+
+	if (mSegments.back().size >= mMaxSegmentSize) {
+		closeSegment();
+		openNewSegment();
+	}
+
+	removeAcknowledgedSegments();
+}
+
+void HitJournal::sync() {
+	lock_guard<mutex> lock(mMutex);
+	if (mFile && mNeedsSync) {
+		syncFile(mFile);
+		mNeedsSync = false;
+	}
+}
+
+size_t HitJournal::getNumPendingHits() const {
+	lock_guard<mutex> lock(mMutex);
+	return mNumPendingHits;
+}
+
+void HitJournal::scanSegment(Segment & segment, std::map<uint64_t, Record> & hits, std::set<uint64_t> & acknowledgedIds, std::vector<uint64_t> & hitIds) {
+	ifstream file(segment.path.string(), ios::binary);
+	string line;
+
+	while (getline(file, line)) {
+		if (file.eof()) {
+			break; // last line is incomplete (e.g. app crashed while writing)
+		}
+
+		stringstream stream(line);
+		char type = 0;
+		stream >> type;
+
+		if (type == 'H') {
+			Record record;
+			uint32_t hash = 0;
+			if (!(stream >> record.id >> record.timestampMs >> hex >> hash >> dec) || stream.get() != ' ') {
+				continue;
+			}
+			getline(stream, record.payload);
+			if (hashPayload(record.payload) != hash) {
+				CI_LOG_W("Skipping corrupt journal record " << to_string(record.id));
+				continue;
+			}
+			if (segment.lastId == 0) {
+				segment.firstId = record.id;
+			}
+			segment.lastId = record.id;
+			hitIds.push_back(record.id);
+			hits[record.id] = std::move(record);
+
+		} else if (type == 'A') {
+			uint64_t id = 0;
+			while (stream >> id) {
+				acknowledgedIds.insert(id);
+			}
+		}
+	}
+}
+
+bool HitJournal::openNewSegment() {
+	Segment segment;
+	segment.index = mSegments.empty() ? 1 : mSegments.back().index + 1;
+	segment.path = mDirectory / getSegmentFilename(segment.index);
+	segment.firstId = mNextId;
+	segment.lastId = 0;
+	segment.numPending = 0;
+	segment.size = 0;
+
+	mFile = fopen(segment.path.string().c_str(), "ab");
+
+	if (!mFile) {
+		CI_LOG_E("Could not open journal segment '" << segment.path << "'");
+		return false;
+	}
+
+	setvbuf(mFile, nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+	mSegments.push_back(segment);
+	return true;
+}
+
+void HitJournal::closeSegment() {
+	if (!mFile) {
+		return;
+	}
+
+	syncFile(mFile);
+	fclose(mFile);
+	mFile = nullptr;
+	mNeedsSync = false;
+
+	// don't leave empty segments behind
+	if (!mSegments.empty() && mSegments.back().size == 0) {
+		removeFile(mSegments.back().path);
+		mSegments.pop_back();
+	}
+}
+
+void HitJournal::writeLine(const std::string & line) {
+	fwrite(line.data(), 1, line.size(), mFile);
+	fputc('\n', mFile);
+	mSegments.back().size += line.size() + 1;
+	mNeedsSync = true;
+}
+
+void HitJournal::removeAcknowledgedSegments() {
+	// only remove from the head so that acknowledgements stored in newer segments are never lost
+	while (mSegments.size() > 1 && mSegments.front().numPending == 0) {
+		removeFile(mSegments.front().path);
+		mSegments.pop_front();
+	}
+}
+
+HitJournal::Segment * HitJournal::findSegment(const uint64_t id) {
+	for (auto it = mSegments.rbegin(); it != mSegments.rend(); ++it) {
+		if (it->lastId != 0 && it->firstId <= id && id <= it->lastId) {
+			return &(*it);
+		}
+	}
+	return nullptr;
+}
+
+uint32_t HitJournal::hashPayload(const std::string & payload) {
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (const char c : payload) {
+		hash ^= (uint8_t)c;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+std::string HitJournal::getSegmentFilename(const uint64_t index) {
+	stringstream filename;
+	filename << SEGMENT_PREFIX << setw(10) << setfill('0') << index << SEGMENT_EXTENSION;
+	return filename.str();
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
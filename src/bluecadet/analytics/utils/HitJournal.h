@@ -0,0 +1,138 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class HitJournal> HitJournalRef;
+
+/*!
+ Append-only write-ahead journal for hit payloads.
+
+ Hits are appended to segment files in a directory as they are accepted and marked as acknowledged once
+ they have been delivered. Writes are buffered and only flushed to disk on sync(), so the cost of an fsync
+ can be amortized over many hits; anything appended since the last sync() can be lost on a crash. Segments are deleted from the head of the journal once all of their hits
+ have been acknowledged. Any hits that were never acknowledged (e.g. because the app quit or crashed) can be
+ read back with readPendingRecords() the next time the journal is opened.
+
+ Record format (one per line):
+ - Hit: 'H <id> <unix time in ms> <payload hash> <payload>'
+ - Acknowledgement: 'A <id> <id> ...'
+
+ All methods are thread-safe.
+ */
+class HitJournal {
+
+public:
+	struct Record {
+		uint64_t	id;
+		int64_t		timestampMs;	//! Unix time in milliseconds
+		std::string	payload;
+	};
+
+	HitJournal();
+	~HitJournal();
+
+	//! Opens the journal in directory and scans existing segments. Creates the directory if it doesn't exist.
+	//! Performs file IO and should not be called on the main thread. Returns false if the journal couldn't be opened.
+	bool					open(const fs::path & directory, const size_t maxSegmentSize = 1024 * 1024);
+
+	//! Syncs and closes the current segment. Unacknowledged hits remain on disk.
+	void					close();
+
+	bool					isOpen() const;
+
+	//! Returns all unacknowledged records found when the journal was opened, oldest first.
+	//! Records stay pending until acknowledged.
+	std::vector<Record>		readPendingRecords();
+
+	//! Appends a hit payload to the journal and returns its id. Returns 0 if the journal isn't open.
+	uint64_t				append(const int64_t timestampMs, const std::string & payload);
+
+	//! Marks the hits with the given ids as delivered. Deletes segments that no longer contain any pending hits.
+	void					acknowledge(const std::vector<uint64_t> & ids);
+
+	//! Flushes buffered writes and forces them to disk.
+	void					sync();
+
+	//! Number of hits that have been appended but not acknowledged yet
+	size_t					getNumPendingHits() const;
+
+protected:
+	struct Segment {
+		uint64_t			index;
+		fs::path		path;
+		uint64_t			firstId;		//! Id of the first hit in this segment
+		uint64_t			lastId;			//! Id of the last hit in this segment or 0 if it has no hits
+		size_t				numPending;		//! Number of unacknowledged hits in this segment
+		size_t				size;			//! Size in bytes
+	};
+
+	void					scanSegment(Segment & segment, std::map<uint64_t, Record> & hits, std::set<uint64_t> & acknowledgedIds, std::vector<uint64_t> & hitIds);
+	bool					openNewSegment();
+	void					closeSegment();
+	void					writeLine(const std::string & line);
+	void					removeAcknowledgedSegments();
+	Segment *				findSegment(const uint64_t id);
+
+	static uint32_t			hashPayload(const std::string & payload);
+	static std::string		getSegmentFilename(const uint64_t index);
+
+	mutable std::mutex		mMutex;
+	fs::path			mDirectory;
+	size_t					mMaxSegmentSize;
+	std::deque<Segment>		mSegments;			//! Oldest first; the last segment is the one being written to
+	std::vector<Record>		mRecoveredRecords;	//! Pending records from previous sessions
+	FILE *					mFile;
+	uint64_t				mNextId;
+	size_t					mNumPendingHits;
+	bool					mNeedsSync;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
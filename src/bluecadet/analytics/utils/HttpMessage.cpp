@@ -0,0 +1,149 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "HttpMessage.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "boost/algorithm/string.hpp"
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+bool httpHeaderNameEquals(const std::string & a, const std::string & b) {
+	return boost::iequals(a, b);
+}
+
+HttpRequestHeader::HttpRequestHeader(const std::string & method, const std::string & host, const std::string & uri, const HttpHeaderList & headers, const bool keepAlive) :
+	mMethod(method),
+	mHost(host),
+	mUri(uri),
+	mHasContentLength(false)
+{
+	HttpHeaderList allHeaders;
+	allHeaders.push_back(make_pair("Host", host));
+
+	if (keepAlive) {
+		allHeaders.push_back(make_pair("Connection", "keep-alive"));
+	}
+
+	// set additional user headers (overwrites any defaults)
+	for (const HttpHeader & userHeader : headers) {
+		auto it = find_if(allHeaders.begin(), allHeaders.end(), [&] (const HttpHeader & header) {
+			return httpHeaderNameEquals(header.first, userHeader.first);
+		});
+
+		if (it != allHeaders.end()) {
+			it->second = userHeader.second;
+		} else {
+			allHeaders.push_back(userHeader);
+		}
+
+		if (httpHeaderNameEquals(userHeader.first, "Content-Length")) {
+			mHasContentLength = true;
+		}
+	}
+
+	mData = method + " " + uri + " HTTP/1.1\r\n";
+
+	for (const HttpHeader & header : allHeaders) {
+		mData += header.first + ": " + header.second + "\r\n";
+	}
+}
+
+bool HttpResponse::parseHeader(const std::string & header) {
+	*this = HttpResponse();
+
+	size_t lineStart = 0;
+	bool isStatusLine = true;
+
+	while (lineStart < header.size()) {
+		size_t lineEnd = header.find('\n', lineStart);
+		if (lineEnd == string::npos) {
+			lineEnd = header.size();
+		}
+
+		string line = header.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+
+		if (isStatusLine) {
+			// e.g. "HTTP/1.1 200 OK"; the reason phrase may be empty or contain spaces
+			isStatusLine = false;
+
+			const size_t versionEnd = line.find(' ');
+			if (versionEnd == string::npos || line.compare(0, 5, "HTTP/") != 0) {
+				return false;
+			}
+
+			char * statusCodeEnd = nullptr;
+			const long statusCode = strtol(line.c_str() + versionEnd + 1, &statusCodeEnd, 10);
+			if (statusCodeEnd == line.c_str() + versionEnd + 1 || statusCode < 100 || statusCode > 999) {
+				return false;
+			}
+
+			mHttpVersion = line.substr(0, versionEnd);
+			mStatusCode = (int)statusCode;
+			mReason = boost::trim_copy(string(statusCodeEnd));
+			continue;
+		}
+
+		const size_t colonPos = line.find(':');
+		if (colonPos == string::npos) {
+			continue; // ignore malformed header lines
+		}
+
+		mHeaders.push_back(make_pair(boost::trim_copy(line.substr(0, colonPos)), boost::trim_copy(line.substr(colonPos + 1))));
+	}
+
+	mHasHeader = !isStatusLine;
+	return mHasHeader;
+}
+
+std::string HttpResponse::getHeader(const std::string & key) const {
+	for (const HttpHeader & header : mHeaders) {
+		if (httpHeaderNameEquals(header.first, key)) {
+			return header.second;
+		}
+	}
+	return "";
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,112 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::pair<std::string, std::string> HttpHeader;
+typedef std::vector<HttpHeader> HttpHeaderList;
+
+//! Compares header names case-insensitively as required by RFC 7230.
+bool httpHeaderNameEquals(const std::string & a, const std::string & b);
+
+typedef std::shared_ptr<const class HttpRequestHeader> HttpRequestHeaderRef;
+
+/*!
+ Request line and headers of an HTTP/1.1 request except for the Content-Length, which is the only header
+ that depends on the body. Rendered once and shared by all requests with the same method, host, uri and
+ headers, e.g. all batch POSTs to the collector, so that sending a request only renders its Content-Length.
+ */
+class HttpRequestHeader {
+
+public:
+	//! Adds a Host header and, if keepAlive is true, a Connection header. Headers with the same names in headers override them.
+	HttpRequestHeader(const std::string & method, const std::string & host, const std::string & uri, const HttpHeaderList & headers, const bool keepAlive);
+
+	const std::string &		getMethod() const { return mMethod; }
+	const std::string &		getHost() const { return mHost; }
+	const std::string &		getUri() const { return mUri; }
+
+	//! True if headers contained a Content-Length, in which case requests don't add their own.
+	bool					hasContentLength() const { return mHasContentLength; }
+
+	//! The request line and header lines, each ending in CRLF, without the empty line that ends the header.
+	const std::string &		getData() const { return mData; }
+
+protected:
+	std::string				mMethod;
+	std::string				mHost;
+	std::string				mUri;
+	bool					mHasContentLength;
+	std::string				mData;
+};
+
+/*!
+ Status line, headers and body of an HTTP/1.x response as received by UrlRequest and UrlRequestPipeline.
+ */
+class HttpResponse {
+
+public:
+	//! Parses the status line and headers (everything before the empty line that ends the header).
+	//! Returns false if the status line is malformed, in which case the response is left without a header.
+	bool					parseHeader(const std::string & header);
+	void					appendBody(const char * data, const size_t size) { mBody.append(data, size); }
+
+	bool					hasHeader() const { return mHasHeader; }
+	const std::string &		getHttpVersion() const { return mHttpVersion; }
+	int						getStatusCode() const { return mStatusCode; }
+	const std::string &		getReason() const { return mReason; }
+	const HttpHeaderList &	getHeaders() const { return mHeaders; }
+	const std::string &		getBody() const { return mBody; }
+
+	//! Value of the first header named key or an empty string.
+	std::string				getHeader(const std::string & key) const;
+
+protected:
+	bool					mHasHeader = false;
+	std::string				mHttpVersion;
+	int						mStatusCode = 0;
+	std::string				mReason;
+	HttpHeaderList			mHeaders;
+	std::string				mBody;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
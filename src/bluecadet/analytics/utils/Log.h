@@ -0,0 +1,104 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+//! Logging macros used throughout the block. Cinder builds use Cinder's logger; standalone builds
+//! (see Platform.h) write the same CI_LOG_* macros to std::clog.
+
+#if defined(BLUECADET_ANALYTICS_STANDALONE)
+
+#include <atomic>
+#include <iostream>
+#include <sstream>
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+enum LogLevel {
+	LOG_VERBOSE,
+	LOG_DEBUG,
+	LOG_INFO,
+	LOG_WARNING,
+	LOG_ERROR,
+	LOG_NONE
+};
+
+inline std::atomic<int> & getMinLogLevelStorage() {
+#if defined(NDEBUG)
+	static std::atomic<int> minLogLevel(LOG_INFO);
+#else
+	static std::atomic<int> minLogLevel(LOG_VERBOSE);
+#endif
+	return minLogLevel;
+}
+
+//! Messages below this level are discarded. Defaults to LOG_INFO in release and LOG_VERBOSE in debug builds.
+inline LogLevel getMinLogLevel() { return (LogLevel)getMinLogLevelStorage().load(std::memory_order_relaxed); }
+inline void setMinLogLevel(const LogLevel level) { getMinLogLevelStorage() = level; }
+
+inline const char * getLogLevelName(const LogLevel level) {
+	switch (level) {
+		case LOG_VERBOSE: return "verbose";
+		case LOG_DEBUG: return "debug";
+		case LOG_INFO: return "info";
+		case LOG_WARNING: return "warning";
+		case LOG_ERROR: return "error";
+		default: return "";
+	}
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
+
+// Messages are formatted into a single string first so that lines from different threads don't interleave
+#define BLUECADET_ANALYTICS_LOG(level, stream) do { \
+	if ((level) >= ::bluecadet::analytics::utils::getMinLogLevel()) { \
+		std::ostringstream bluecadetAnalyticsLogStream; \
+		bluecadetAnalyticsLogStream << "|" << ::bluecadet::analytics::utils::getLogLevelName(level) << "| " << __FUNCTION__ << "[" << __LINE__ << "] " << stream << "\n"; \
+		std::clog << bluecadetAnalyticsLogStream.str() << std::flush; \
+	} \
+} while (false)
+
+#define CI_LOG_V(stream)	BLUECADET_ANALYTICS_LOG(::bluecadet::analytics::utils::LOG_VERBOSE, stream)
+#define CI_LOG_D(stream)	BLUECADET_ANALYTICS_LOG(::bluecadet::analytics::utils::LOG_DEBUG, stream)
+#define CI_LOG_I(stream)	BLUECADET_ANALYTICS_LOG(::bluecadet::analytics::utils::LOG_INFO, stream)
+#define CI_LOG_W(stream)	BLUECADET_ANALYTICS_LOG(::bluecadet::analytics::utils::LOG_WARNING, stream)
+#define CI_LOG_E(stream)	BLUECADET_ANALYTICS_LOG(::bluecadet::analytics::utils::LOG_ERROR, stream)
+#define CI_LOG_EXCEPTION(stream, exc)	CI_LOG_E(stream << ", exception: " << (exc).what())
+
+#else
+
+#include "cinder/Log.h"
+
+#endif
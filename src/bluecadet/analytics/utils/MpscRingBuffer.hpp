@@ -0,0 +1,167 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+/*!
+ Bounded lock-free multi-producer/single-consumer ring buffer.
+
+ Producers on any thread call tryPush(), which costs one CAS on the write index and never
+ blocks or allocates. A single consumer at a time drains items via tryPop() or popBulk().
+ Consumers on different threads are fine as long as they are serialized externally (e.g. by a mutex).
+
+ Based on Dmitry Vyukov's bounded MPMC queue with the consumer side simplified to a single reader.
+ Capacity is rounded up to the next power of two.
+ */
+template <typename T>
+class MpscRingBuffer {
+
+public:
+	explicit MpscRingBuffer(size_t capacity = 4096) :
+		mCapacity(roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity)),
+		mMask(mCapacity - 1),
+		mCells(new Cell[mCapacity])
+	{
+		for (size_t i = 0; i < mCapacity; ++i) {
+			mCells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		mWriteIndex.store(0, std::memory_order_relaxed);
+		mReadIndex = 0;
+	}
+
+	MpscRingBuffer(const MpscRingBuffer &) = delete;
+	MpscRingBuffer & operator=(const MpscRingBuffer &) = delete;
+
+	//! Attempts to move item into the buffer. Safe to call from any thread. Returns false if the buffer is full.
+	bool tryPush(T && item) {
+		Cell * cell = nullptr;
+		size_t pos = mWriteIndex.load(std::memory_order_relaxed);
+
+		while (true) {
+			cell = &mCells[pos & mMask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+			if (diff == 0) {
+				// slot is free; try to claim it
+				if (mWriteIndex.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false; // full
+			} else {
+				pos = mWriteIndex.load(std::memory_order_relaxed); // another producer claimed this slot
+			}
+		}
+
+		cell->data = std::move(item);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPush(const T & item) {
+		T copy(item);
+		return tryPush(std::move(copy));
+	}
+
+	//! Attempts to pop the oldest item. Must only be called by one consumer at a time. Returns false if empty.
+	bool tryPop(T & item) {
+		Cell & cell = mCells[mReadIndex & mMask];
+		const size_t seq = cell.sequence.load(std::memory_order_acquire);
+
+		if (seq != mReadIndex + 1) {
+			return false; // empty or producer hasn't finished writing yet
+		}
+
+		item = std::move(cell.data);
+		cell.data = T(); // release any resources held by the slot
+		cell.sequence.store(mReadIndex + mCapacity, std::memory_order_release);
+		mReadIndex++;
+		return true;
+	}
+
+	//! Pops up to maxItems into out. Must only be called by one consumer at a time. Returns the number of items popped.
+	template <typename OutputIt>
+	size_t popBulk(OutputIt out, size_t maxItems) {
+		size_t numPopped = 0;
+		T item;
+		while (numPopped < maxItems && tryPop(item)) {
+			*out++ = std::move(item);
+			numPopped++;
+		}
+		return numPopped;
+	}
+
+	//! Approximate number of items in the buffer. Only exact if no producers are active.
+	size_t sizeApprox() const {
+		const size_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+		const size_t readIndex = mReadIndex;
+		return writeIndex > readIndex ? writeIndex - readIndex : 0;
+	}
+
+	size_t getCapacity() const { return mCapacity; }
+
+protected:
+	static size_t roundUpToPowerOfTwo(size_t value) {
+		size_t result = 1;
+		while (result < value) result <<= 1;
+		return result;
+	}
+
+	struct Cell {
+		std::atomic<size_t>	sequence;
+		T					data;
+	};
+
+	static const size_t CACHE_LINE_SIZE = 64;
+
+	const size_t				mCapacity;
+	const size_t				mMask;
+	std::unique_ptr<Cell[]>		mCells;
+
+	// keep producer and consumer indices on separate cache lines to avoid false sharing
+	std::atomic<size_t>			mWriteIndex;
+	char						mPadding[CACHE_LINE_SIZE];
+	size_t						mReadIndex;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
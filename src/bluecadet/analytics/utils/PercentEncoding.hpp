@@ -0,0 +1,259 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+/*!
+ Percent-encoding for URL query values according to RFC 3986. Only unreserved characters
+ (ALPHA / DIGIT / '-' / '.' / '_' / '~') are kept as is, so the encoded size of a string
+ can be determined up front without encoding it.
+
+ Values are expected to be UTF-8. Bytes that aren't part of a valid UTF-8 sequence (e.g. Latin-1
+ text or truncated sequences) are replaced with U+FFFD so that GA never receives malformed text.
+ Validation happens in the same pass as encoding.
+
+ Characters are classified with a lookup table. Callers that know the total size up front (see
+ GAHitSchema.hpp) write straight into their output buffer with writePercentEncoded().
+ */
+
+//! 256 entry lookup table; true for unreserved characters.
+struct UnreservedUrlCharTable {
+	UnreservedUrlCharTable() {
+		for (int c = 0; c < 256; ++c) {
+			values[c] = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+		}
+	}
+
+	static const UnreservedUrlCharTable & get() {
+		static const UnreservedUrlCharTable table;
+		return table;
+	}
+
+	bool values[256];
+};
+
+inline bool isUnreservedUrlChar(const unsigned char c) {
+	return UnreservedUrlCharTable::get().values[c];
+}
+
+//! Returns the length of the valid UTF-8 sequence at the start of data or 0 if it's invalid (RFC 3629).
+inline size_t getUtf8SequenceLength(const unsigned char * data, const size_t length) {
+	const unsigned char lead = data[0];
+	size_t sequenceLength = 0;
+	unsigned char minSecond = 0x80;
+	unsigned char maxSecond = 0xBF;
+
+	if (lead < 0x80) {
+		return 1;
+	} else if (lead >= 0xC2 && lead <= 0xDF) {
+		sequenceLength = 2;
+	} else if (lead >= 0xE0 && lead <= 0xEF) {
+		sequenceLength = 3;
+		if (lead == 0xE0) minSecond = 0xA0; // overlong
+		if (lead == 0xED) maxSecond = 0x9F; // surrogates
+	} else if (lead >= 0xF0 && lead <= 0xF4) {
+		sequenceLength = 4;
+		if (lead == 0xF0) minSecond = 0x90; // overlong
+		if (lead == 0xF4) maxSecond = 0x8F; // beyond U+10FFFF
+	} else {
+		return 0;
+	}
+
+	if (length < sequenceLength || data[1] < minSecond || data[1] > maxSecond) {
+		return 0;
+	}
+
+	for (size_t i = 2; i < sequenceLength; ++i) {
+		if (data[i] < 0x80 || data[i] > 0xBF) {
+			return 0;
+		}
+	}
+
+	return sequenceLength;
+}
+
+//! Number of bytes value will occupy once percent-encoded.
+inline size_t getPercentEncodedSize(const std::string & value) {
+	const bool * table = UnreservedUrlCharTable::get().values;
+	const unsigned char * data = (const unsigned char *)value.data();
+	const size_t length = value.size();
+	size_t size = 0;
+	size_t i = 0;
+
+	while (i < length) {
+		const unsigned char c = data[i];
+
+		if (table[c]) {
+			size += 1;
+			i += 1;
+
+		} else if (c < 0x80) {
+			size += 3;
+			i += 1;
+
+		} else {
+			// escaped sequence or replacement char
+			const size_t sequenceLength = getUtf8SequenceLength(data + i, length - i);
+			size += sequenceLength == 0 ? 9 : sequenceLength * 3;
+			i += sequenceLength == 0 ? 1 : sequenceLength;
+		}
+	}
+
+	return size;
+}
+
+//! Writes c as %XX.
+inline char * writeEscapedUrlChar(char * out, const unsigned char c) {
+	static const char hexDigits[] = "0123456789ABCDEF";
+	out[0] = '%';
+	out[1] = hexDigits[c >> 4];
+	out[2] = hexDigits[c & 0xF];
+	return out + 3;
+}
+
+//! Decodes the percent-escaped byte at in (e.g. "%E2") into c. Returns false if in isn't a valid escape.
+inline bool readEscapedUrlChar(const char * in, unsigned char & c) {
+	if (in[0] != '%') {
+		return false;
+	}
+	c = 0;
+	for (size_t i = 1; i < 3; ++i) {
+		const char digit = in[i];
+		c <<= 4;
+		if (digit >= '0' && digit <= '9') c |= (unsigned char)(digit - '0');
+		else if (digit >= 'A' && digit <= 'F') c |= (unsigned char)(digit - 'A' + 10);
+		else if (digit >= 'a' && digit <= 'f') c |= (unsigned char)(digit - 'a' + 10);
+		else return false;
+	}
+	return true;
+}
+
+//! Returns the largest size <= maxSize at which the percent-encoded value can be cut
+//! without splitting an escape or the escapes of a multi-byte UTF-8 character.
+inline size_t getPercentEncodedCutSize(const std::string & value, const size_t maxSize) {
+	if (value.size() <= maxSize) {
+		return value.size();
+	}
+
+	const char * data = value.data();
+	size_t size = maxSize;
+
+	// don't cut through an escape
+	if (size >= 1 && data[size - 1] == '%') size -= 1;
+	else if (size >= 2 && data[size - 2] == '%') size -= 2;
+
+	// skip trailing continuation bytes back to their lead byte
+	unsigned char c = 0;
+	size_t numContinuations = 0;
+	while (size >= 3 && readEscapedUrlChar(data + size - 3, c) && c >= 0x80 && c <= 0xBF) {
+		size -= 3;
+		++numContinuations;
+	}
+
+	if (size >= 3 && readEscapedUrlChar(data + size - 3, c) && c >= 0xC0) {
+		const size_t sequenceLength = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+		if (numContinuations + 1 >= sequenceLength) {
+			// last sequence is complete; keep it along with any stray continuations
+			return size + numContinuations * 3;
+		}
+		// drop the incomplete sequence including its lead byte
+		return size - 3;
+	}
+
+	// no lead byte: drop the orphaned continuations
+	return size;
+}
+
+//! Percent-encodes value into out, which needs to have room for getPercentEncodedSize(value) chars.
+//! Returns the end of the written chars.
+inline char * writePercentEncoded(char * out, const std::string & value) {
+	static const char replacementChar[] = "%EF%BF%BD";
+
+	const bool * table = UnreservedUrlCharTable::get().values;
+	const unsigned char * data = (const unsigned char *)value.data();
+	const size_t length = value.size();
+	size_t i = 0;
+
+	while (i < length) {
+		const unsigned char c = data[i];
+
+		if (table[c]) {
+			*out++ = (char)c;
+			i += 1;
+
+		} else if (c < 0x80) {
+			out = writeEscapedUrlChar(out, c);
+			i += 1;
+
+		} else {
+			const size_t sequenceLength = getUtf8SequenceLength(data + i, length - i);
+
+			if (sequenceLength == 0) {
+				memcpy(out, replacementChar, sizeof(replacementChar) - 1);
+				out += sizeof(replacementChar) - 1;
+				i += 1;
+
+			} else {
+				for (const size_t end = i + sequenceLength; i < end; ++i) {
+					out = writeEscapedUrlChar(out, data[i]);
+				}
+			}
+		}
+	}
+
+	return out;
+}
+
+//! Percent-encodes value and appends it to result.
+inline void appendPercentEncoded(std::string & result, const std::string & value) {
+	const size_t offset = result.size();
+	result.resize(offset + getPercentEncodedSize(value));
+	writePercentEncoded(&result[offset], value);
+}
+
+inline std::string percentEncode(const std::string & value) {
+	std::string result;
+	result.reserve(getPercentEncodedSize(value));
+	appendPercentEncoded(result, value);
+	return result;
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
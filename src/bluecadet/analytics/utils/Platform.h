@@ -0,0 +1,66 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+//! Dependencies that differ between Cinder and standalone builds.
+//! Define BLUECADET_ANALYTICS_STANDALONE to build without Cinder, in which case Boost.Asio and
+//! Boost.Filesystem are used instead of the versions that ship with Cinder.
+
+#if defined(BLUECADET_ANALYTICS_STANDALONE)
+
+#include "boost/asio.hpp"
+#include "boost/filesystem.hpp"
+
+//! Exposes Boost.Asio under the same namespace as the standalone asio that ships with Cinder
+namespace asio {
+	using namespace boost::asio;
+	typedef boost::system::error_code error_code;
+}
+
+namespace bluecadet {
+namespace analytics {
+namespace fs = boost::filesystem;
+} // analytics namespace
+} // bluecadet namespace
+
+#else
+
+#include "asio/asio.hpp"
+#include "cinder/Filesystem.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace fs = ci::fs;
+} // analytics namespace
+} // bluecadet namespace
+
+#endif
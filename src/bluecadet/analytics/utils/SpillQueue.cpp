@@ -0,0 +1,283 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SpillQueue.h"
+
+#include "Log.h"
+
+#include <iomanip>
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+namespace {
+	const string SEGMENT_PREFIX = "spill-";
+	const string SEGMENT_EXTENSION = ".log";
+	const size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+	void removeFile(const fs::path & path) {
+		try {
+			fs::remove(path);
+		} catch (std::exception & e) {
+			CI_LOG_EXCEPTION("Could not remove spill segment '" << path << "'", e);
+		}
+	}
+
+	//! Reads a line without its trailing newline. Returns false at the end of the file.
+	bool readLine(FILE * file, string & line) {
+		line.clear();
+		char buffer[4096];
+		while (fgets(buffer, sizeof(buffer), file)) {
+			line += buffer;
+			if (line.back() == '\n') {
+				line.pop_back();
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+SpillQueue::SpillQueue() :
+	mMaxSegmentSize(1024 * 1024),
+	mWriteFile(nullptr),
+	mReadFile(nullptr),
+	mIsOpen(false),
+	mNumRecords(0),
+	mNumBytes(0)
+{
+}
+
+SpillQueue::~SpillQueue() {
+	close();
+}
+
+bool SpillQueue::open(const fs::path & directory, const size_t maxSegmentSize) {
+	lock_guard<mutex> lock(mMutex);
+
+	removeAllSegments();
+
+	mDirectory = directory;
+	mMaxSegmentSize = maxSegmentSize;
+
+	try {
+		fs::create_directories(mDirectory);
+
+		// spilled hits aren't valid across sessions (journaled hits are replayed from the journal instead)
+		for (fs::directory_iterator it(mDirectory), end; it != end; ++it) {
+			const string filename = it->path().filename().string();
+			if (filename.compare(0, SEGMENT_PREFIX.size(), SEGMENT_PREFIX) == 0 && it->path().extension().string() == SEGMENT_EXTENSION) {
+				removeFile(it->path());
+			}
+		}
+
+	} catch (std::exception & e) {
+		CI_LOG_EXCEPTION("Could not open spill queue at '" << mDirectory << "'", e);
+		return false;
+	}
+
+	mIsOpen = true;
+	return true;
+}
+
+void SpillQueue::close() {
+	lock_guard<mutex> lock(mMutex);
+	removeAllSegments();
+	mIsOpen = false;
+}
+
+bool SpillQueue::isOpen() const {
+	lock_guard<mutex> lock(mMutex);
+	return mIsOpen;
+}
+
+bool SpillQueue::push(const std::vector<Record> & records) {
+	lock_guard<mutex> lock(mMutex);
+
+	if (!mIsOpen) {
+		return false;
+	}
+
+	for (const auto & record : records) {
+		if (!mWriteFile && !openNewSegment()) {
+			return false;
+		}
+
+		const string line = to_string(record.timestampMs) + " " + to_string(record.journalId) + " " + (record.cacheBuster ? "1 " : "0 ") + record.payload + "\n";
+		fwrite(line.data(), 1, line.size(), mWriteFile);
+
+		Segment & segment = mSegments.back();
+		segment.numRecords++;
+		segment.size += line.size();
+		mNumRecords++;
+		mNumBytes += line.size();
+
+		if (segment.size >= mMaxSegmentSize) {
+			// start a new segment on the next push so that this one can be deleted once it's been read
+			fclose(mWriteFile);
+			mWriteFile = nullptr;
+		}
+	}
+
+	return true;
+}
+
+std::vector<SpillQueue::Record> SpillQueue::pop(const size_t maxNumRecords) {
+	lock_guard<mutex> lock(mMutex);
+
+	vector<Record> records;
+	string line;
+
+	while (records.size() < maxNumRecords && !mSegments.empty()) {
+		Segment & segment = mSegments.front();
+		const bool isWriteSegment = mSegments.size() == 1 && mWriteFile;
+
+		if (isWriteSegment) {
+			fflush(mWriteFile); // make buffered records readable
+		}
+
+		if (!mReadFile) {
+			mReadFile = fopen(segment.path.string().c_str(), "rb");
+			if (!mReadFile) {
+				CI_LOG_E("Could not read spill segment '" << segment.path << "'; dropping " << to_string(segment.numRecords) << " hits");
+				removeFrontSegment();
+				continue;
+			}
+		}
+
+		clearerr(mReadFile); // reading may have hit the end before more records were written
+
+		while (records.size() < maxNumRecords && segment.numRecords > 0 && readLine(mReadFile, line)) {
+			const size_t lineSize = line.size() + 1;
+			segment.numRecords--;
+			segment.size -= min(segment.size, lineSize);
+			mNumRecords--;
+			mNumBytes -= min(mNumBytes, lineSize);
+
+			Record record;
+			char * end = nullptr;
+			record.timestampMs = strtoll(line.c_str(), &end, 10);
+			record.journalId = strtoull(end, &end, 10);
+			record.cacheBuster = strtol(end, &end, 10) != 0;
+
+			if (*end != ' ') {
+				CI_LOG_W("Skipping invalid spill record");
+				continue;
+			}
+
+			record.payload.assign(end + 1);
+			records.push_back(std::move(record));
+		}
+
+		if (segment.numRecords == 0 || feof(mReadFile)) {
+			if (segment.numRecords > 0) {
+				CI_LOG_W("Spill segment '" << segment.path << "' ended early; dropping " << to_string(segment.numRecords) << " hits");
+			}
+			if (isWriteSegment) {
+				fclose(mWriteFile);
+				mWriteFile = nullptr;
+			}
+			removeFrontSegment();
+		}
+	}
+
+	return records;
+}
+
+size_t SpillQueue::getNumRecords() const {
+	lock_guard<mutex> lock(mMutex);
+	return mNumRecords;
+}
+
+size_t SpillQueue::getNumBytes() const {
+	lock_guard<mutex> lock(mMutex);
+	return mNumBytes;
+}
+
+bool SpillQueue::openNewSegment() {
+	Segment segment;
+	segment.index = mSegments.empty() ? 1 : mSegments.back().index + 1;
+	segment.path = mDirectory / getSegmentFilename(segment.index);
+	segment.numRecords = 0;
+	segment.size = 0;
+
+	mWriteFile = fopen(segment.path.string().c_str(), "wb");
+
+	if (!mWriteFile) {
+		CI_LOG_E("Could not open spill segment '" << segment.path << "'");
+		return false;
+	}
+
+	setvbuf(mWriteFile, nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+	mSegments.push_back(segment);
+	return true;
+}
+
+void SpillQueue::removeFrontSegment() {
+	if (mReadFile) {
+		fclose(mReadFile);
+		mReadFile = nullptr;
+	}
+
+	mNumRecords -= min(mNumRecords, mSegments.front().numRecords);
+	mNumBytes -= min(mNumBytes, mSegments.front().size);
+
+	removeFile(mSegments.front().path);
+	mSegments.pop_front();
+}
+
+void SpillQueue::removeAllSegments() {
+	if (mWriteFile) {
+		fclose(mWriteFile);
+		mWriteFile = nullptr;
+	}
+
+	while (!mSegments.empty()) {
+		removeFrontSegment();
+	}
+
+	mNumRecords = 0;
+	mNumBytes = 0;
+}
+
+std::string SpillQueue::getSegmentFilename(const uint64_t index) {
+	stringstream filename;
+	filename << SEGMENT_PREFIX << setw(10) << setfill('0') << index << SEGMENT_EXTENSION;
+	return filename.str();
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,121 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class SpillQueue> SpillQueueRef;
+
+/*!
+ Disk-backed FIFO queue of hit payloads.
+
+ Used to move hits out of memory while the batch queue is over budget (e.g. during a long outage) and to
+ read them back in order once there's room again. Records are appended to segment files and each segment
+ is deleted once all of its records have been read. Unlike HitJournal, nothing is synced to disk and spill
+ files don't survive a restart; hits that need to survive crashes should also be journaled.
+
+ Record format (one per line): '<unix time in ms> <journal id> <cache buster 0|1> <payload>'
+
+ All methods are thread-safe.
+ */
+class SpillQueue {
+
+public:
+	struct Record {
+		int64_t		timestampMs;	//! Unix time in milliseconds
+		uint64_t	journalId;		//! Id of this hit in the HitJournal or 0
+		bool		cacheBuster;
+		std::string	payload;
+	};
+
+	SpillQueue();
+	~SpillQueue();
+
+	//! Opens the queue in directory and deletes any spill files left over from previous sessions.
+	//! Creates the directory if it doesn't exist. Returns false if the directory couldn't be used.
+	bool					open(const fs::path & directory, const size_t maxSegmentSize = 1024 * 1024);
+
+	//! Deletes all spilled records.
+	void					close();
+
+	bool					isOpen() const;
+
+	//! Appends records to the end of the queue. Returns false if they couldn't be written.
+	bool					push(const std::vector<Record> & records);
+
+	//! Removes and returns up to maxNumRecords records from the front of the queue, oldest first.
+	std::vector<Record>		pop(const size_t maxNumRecords);
+
+	size_t					getNumRecords() const;
+	size_t					getNumBytes() const;	//! Size of all unread records on disk
+
+protected:
+	struct Segment {
+		uint64_t			index;
+		fs::path		path;
+		size_t				numRecords;		//! Number of unread records
+		size_t				size;			//! Size of unread records in bytes
+	};
+
+	bool					openNewSegment();
+	void					removeFrontSegment();
+	void					removeAllSegments();
+
+	static std::string		getSegmentFilename(const uint64_t index);
+
+	mutable std::mutex		mMutex;
+	fs::path			mDirectory;
+	size_t					mMaxSegmentSize;
+	std::deque<Segment>		mSegments;		//! Oldest first; the last segment is the one being written to
+	FILE *					mWriteFile;		//! Open on the last segment or null if a new segment is needed
+	FILE *					mReadFile;		//! Open on the first segment or null if reading hasn't started
+	bool					mIsOpen;
+	size_t					mNumRecords;
+	size_t					mNumBytes;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
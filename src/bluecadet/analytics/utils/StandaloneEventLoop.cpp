@@ -0,0 +1,181 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "StandaloneEventLoop.h"
+
+#include <chrono>
+#include <vector>
+
+#include "DnsCache.h"
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+StandaloneEventLoop::StandaloneEventLoop(const double updateInterval) :
+	mWork(new asio::io_service::work(mIo)),
+	mUpdateTimer(mIo),
+	mIsRunning(true),
+	mNextCallbackId(INVALID_CALLBACK_ID + 1),
+	mUpdateInterval(updateInterval),
+	mIsUpdateScheduled(false)
+{
+	mThread = thread([this] {
+		mIo.run();
+	});
+}
+
+StandaloneEventLoop::~StandaloneEventLoop() {
+	stop();
+}
+
+EventLoop::CallbackId StandaloneEventLoop::addUpdateCallback(Callback callback) {
+	CallbackId id = INVALID_CALLBACK_ID;
+
+	{
+		lock_guard<mutex> lock(mCallbackMutex);
+		id = mNextCallbackId++;
+		mUpdateCallbacks[id] = callback;
+	}
+
+	mIo.post([this] {
+		scheduleUpdate();
+	});
+
+	return id;
+}
+
+void StandaloneEventLoop::removeUpdateCallback(const CallbackId id) {
+	lock_guard<mutex> lock(mCallbackMutex);
+	mUpdateCallbacks.erase(id);
+}
+
+EventLoop::CallbackId StandaloneEventLoop::addCleanupCallback(Callback callback) {
+	lock_guard<mutex> lock(mCallbackMutex);
+	const CallbackId id = mNextCallbackId++;
+	mCleanupCallbacks[id] = callback;
+	return id;
+}
+
+void StandaloneEventLoop::removeCleanupCallback(const CallbackId id) {
+	lock_guard<mutex> lock(mCallbackMutex);
+	mCleanupCallbacks.erase(id);
+}
+
+void StandaloneEventLoop::stop() {
+	if (!mIsRunning.exchange(false)) {
+		return;
+	}
+
+	// call callbacks outside of the lock since they may remove themselves
+	map<CallbackId, Callback> cleanupCallbacks;
+	{
+		lock_guard<mutex> lock(mCallbackMutex);
+		swap(cleanupCallbacks, mCleanupCallbacks);
+		mUpdateCallbacks.clear();
+	}
+
+	for (auto & kvp : cleanupCallbacks) {
+		kvp.second();
+	}
+
+	// the process-wide DNS cache must not post to mIo once it's gone
+	DnsCache::getInstance()->cancel(mIo);
+
+	mWork = nullptr;
+	mIo.stop();
+
+	if (mThread.joinable()) {
+		if (mThread.get_id() == this_thread::get_id()) {
+			mThread.detach(); // stopped from one of our own handlers
+		} else {
+			mThread.join();
+		}
+	}
+}
+
+void StandaloneEventLoop::scheduleUpdate() {
+	if (mIsUpdateScheduled) {
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(mCallbackMutex);
+		if (mUpdateCallbacks.empty()) {
+			return;
+		}
+	}
+
+	mIsUpdateScheduled = true;
+	mUpdateTimer.expires_from_now(chrono::duration_cast<asio::steady_timer::duration>(chrono::duration<double>(mUpdateInterval)));
+	mUpdateTimer.async_wait([this] (const asio::error_code & ec) {
+		mIsUpdateScheduled = false;
+
+		if (ec) {
+			return;
+		}
+
+		vector<Callback> callbacks;
+		{
+			lock_guard<mutex> lock(mCallbackMutex);
+			for (const auto & kvp : mUpdateCallbacks) {
+				callbacks.push_back(kvp.second);
+			}
+		}
+
+		for (auto & callback : callbacks) {
+			callback();
+		}
+
+		scheduleUpdate();
+	});
+}
+
+#if defined(BLUECADET_ANALYTICS_STANDALONE)
+
+EventLoopRef getDefaultEventLoop() {
+	static mutex defaultLoopMutex;
+	static EventLoopRef defaultLoop;
+
+	lock_guard<mutex> lock(defaultLoopMutex);
+	if (!defaultLoop) {
+		defaultLoop = make_shared<StandaloneEventLoop>();
+	}
+	return defaultLoop;
+}
+
+#endif
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,99 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "EventLoop.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class StandaloneEventLoop> StandaloneEventLoopRef;
+
+/*!
+ Event loop for apps without a Cinder app loop, e.g. command line tools and services.
+
+ Runs its own io_service on a background thread from construction until stop(), so network
+ requests complete and update callbacks are called on that thread. Update callbacks are called
+ every update interval while any are registered; there is no overhead while none are.
+ */
+class StandaloneEventLoop : public EventLoop {
+
+public:
+	StandaloneEventLoop(const double updateInterval = 1.0 / 60.0);
+	~StandaloneEventLoop();
+
+	asio::io_service &	getIoService() override { return mIo; }
+
+	CallbackId			addUpdateCallback(Callback callback) override;
+	void				removeUpdateCallback(const CallbackId id) override;
+
+	CallbackId			addCleanupCallback(Callback callback) override;
+	void				removeCleanupCallback(const CallbackId id) override;
+
+	//! Calls all cleanup callbacks, cancels DNS callbacks for this loop (see DnsCache::cancel()), then stops the background
+	//! thread without waiting for pending requests.
+	//! Can't be restarted. Called automatically on destruction.
+	void				stop();
+	bool				isRunning() const { return mIsRunning; }
+	bool				isRunningOwnThread() const override { return mIsRunning; }
+
+	//! Seconds between update callbacks. Defaults to 1/60.
+	double				getUpdateInterval() const { return mUpdateInterval; }
+
+protected:
+	//! Starts the update timer unless it's already running or there are no update callbacks. Runs on the io thread.
+	void				scheduleUpdate();
+
+	asio::io_service						mIo;
+	std::unique_ptr<asio::io_service::work>	mWork;
+	asio::steady_timer						mUpdateTimer;
+	std::thread								mThread;
+	std::atomic<bool>						mIsRunning;
+
+	std::mutex								mCallbackMutex;
+	std::map<CallbackId, Callback>			mUpdateCallbacks;
+	std::map<CallbackId, Callback>			mCleanupCallbacks;
+	CallbackId								mNextCallbackId;
+
+	const double							mUpdateInterval;
+	bool									mIsUpdateScheduled;	//! Only accessed on the io thread
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
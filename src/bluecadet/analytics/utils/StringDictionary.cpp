@@ -0,0 +1,77 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StringDictionary.h"
+
+#include "PercentEncoding.hpp"
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+InternedString StringDictionary::intern(const std::string & value) {
+	lock_guard<mutex> lock(mMutex);
+
+	auto it = mIds.find(value);
+	if (it != mIds.end()) {
+		return InternedString(&mEntries[it->second]);
+	}
+
+	const uint32_t id = (uint32_t)mEntries.size();
+	mEntries.push_back(InternedString::Entry{ id, value, percentEncode(value) });
+	mIds.emplace(value, id);
+
+	return InternedString(&mEntries.back());
+}
+
+InternedString StringDictionary::find(const std::string & value) const {
+	lock_guard<mutex> lock(mMutex);
+
+	auto it = mIds.find(value);
+	return it != mIds.end() ? InternedString(&mEntries[it->second]) : InternedString();
+}
+
+InternedString StringDictionary::find(const uint32_t id) const {
+	lock_guard<mutex> lock(mMutex);
+	return id < mEntries.size() ? InternedString(&mEntries[id]) : InternedString();
+}
+
+size_t StringDictionary::size() const {
+	lock_guard<mutex> lock(mMutex);
+	return mEntries.size();
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,122 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+class StringDictionary;
+
+//! Handle to a string in the StringDictionary. The size of a pointer and cheap to copy.
+//! Default-constructed handles are unset; handles returned by StringDictionary::intern() stay valid for the lifetime of the app.
+class InternedString {
+public:
+	InternedString() : mEntry(nullptr) {}
+
+	//! Whether this handle refers to an interned string.
+	explicit operator bool() const { return mEntry != nullptr; }
+
+	//! Dense ID in order of interning, starting at 0. Only valid if set.
+	uint32_t			getId() const { return mEntry->id; }
+
+	//! The original and the percent-encoded value. Empty if unset.
+	const std::string &	getValue() const { return mEntry ? mEntry->value : getEmptyString(); }
+	const std::string &	getEncodedValue() const { return mEntry ? mEntry->encodedValue : getEmptyString(); }
+
+	bool operator==(const InternedString & other) const { return mEntry == other.mEntry; }
+	bool operator!=(const InternedString & other) const { return mEntry != other.mEntry; }
+
+protected:
+	friend class StringDictionary;
+
+	struct Entry {
+		uint32_t	id;
+		std::string	value;
+		std::string	encodedValue;
+	};
+
+	explicit InternedString(const Entry * entry) : mEntry(entry) {}
+
+	static const std::string & getEmptyString() {
+		static const std::string empty;
+		return empty;
+	}
+
+	const Entry * mEntry;
+};
+
+/*!
+ Process-wide dictionary of strings that are tracked over and over again, like event categories,
+ actions, labels and screen names.
+
+ Each string is stored and percent-encoded once. Hits that are tracked with InternedString handles
+ copy a pointer instead of the string and serialize the cached encoded form instead of encoding the
+ string again. Entries are never removed, so only intern a bounded vocabulary and not free-form input.
+
+ All methods are thread-safe.
+ */
+class StringDictionary {
+
+public:
+	static StringDictionary & get() {
+		static StringDictionary instance;
+		return instance;
+	}
+
+	//! Returns the handle for value, adding value to the dictionary if it hasn't been interned yet.
+	InternedString	intern(const std::string & value);
+
+	//! Returns the handle of a previously interned value or an unset handle.
+	InternedString	find(const std::string & value) const;
+	InternedString	find(const uint32_t id) const;
+
+	size_t			size() const;
+
+protected:
+	StringDictionary() {}
+
+	mutable std::mutex								mMutex;
+	std::deque<InternedString::Entry>				mEntries;	//! Deque so that handles stay valid while it grows
+	std::unordered_map<std::string, uint32_t>		mIds;
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,112 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Task.h"
+
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+namespace {
+	const size_t MIN_BLOCK_SIZE = 64;
+	const size_t NUM_SIZE_CLASSES = 4;				//! 64, 128, 256 and 512 bytes
+	const size_t MAX_FREE_BLOCKS_PER_CLASS = 1024;	//! Blocks beyond this are returned to the heap
+
+	struct SizeClass {
+		std::mutex			mutex;
+		std::vector<void *>	freeBlocks;
+	};
+
+	SizeClass * getSizeClasses() {
+		// never destroyed so that tasks in static objects can still release their blocks at exit
+		static SizeClass * sizeClasses = new SizeClass[NUM_SIZE_CLASSES];
+		return sizeClasses;
+	}
+
+	size_t getSizeClassIndex(const size_t size) {
+		size_t index = 0;
+		for (size_t blockSize = MIN_BLOCK_SIZE; blockSize < size; blockSize *= 2) {
+			index++;
+		}
+		return index;
+	}
+}
+
+void * TaskPool::allocate(const size_t size) {
+	if (size > MAX_BLOCK_SIZE) {
+		return ::operator new(size);
+	}
+
+	const size_t index = getSizeClassIndex(size);
+	SizeClass & sizeClass = getSizeClasses()[index];
+
+	{
+		lock_guard<mutex> lock(sizeClass.mutex);
+		if (!sizeClass.freeBlocks.empty()) {
+			void * block = sizeClass.freeBlocks.back();
+			sizeClass.freeBlocks.pop_back();
+			return block;
+		}
+	}
+
+	return ::operator new(MIN_BLOCK_SIZE << index);
+}
+
+void TaskPool::release(void * block, const size_t size) {
+	if (!block) {
+		return;
+	}
+
+	if (size <= MAX_BLOCK_SIZE) {
+		SizeClass & sizeClass = getSizeClasses()[getSizeClassIndex(size)];
+		lock_guard<mutex> lock(sizeClass.mutex);
+
+		if (sizeClass.freeBlocks.size() < MAX_FREE_BLOCKS_PER_CLASS) {
+			if (sizeClass.freeBlocks.capacity() == 0) {
+				sizeClass.freeBlocks.reserve(MAX_FREE_BLOCKS_PER_CLASS);
+			}
+			sizeClass.freeBlocks.push_back(block);
+			return;
+		}
+	}
+
+	::operator delete(block);
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,213 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//! Bytes of captured state that tasks store without allocating. Define before including to trade task size for fewer pooled allocations.
+#ifndef BLUECADET_ANALYTICS_TASK_CAPACITY
+#define BLUECADET_ANALYTICS_TASK_CAPACITY 56
+#endif
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+/*!
+ Storage for tasks whose captured state doesn't fit inline. Blocks are handed out in a few size classes
+ and kept for reuse when they are released, so steady task traffic doesn't go back to the heap.
+ Safe to use from any thread; blocks can be released on a different thread than they were allocated on.
+ */
+class TaskPool {
+
+public:
+	static const size_t MAX_BLOCK_SIZE = 512; // larger blocks are allocated and freed with operator new/delete
+
+	static void * allocate(const size_t size);
+	static void release(void * block, const size_t size);
+
+};
+
+/*!
+ Move-only callable for ThreadManager, similar to std::function<void()>. Callables of up to Capacity bytes
+ (e.g. a lambda that captures this and a couple of shared_ptrs) are stored inline; larger ones go to TaskPool.
+ Tasks are moved rather than copied through queues, so captured shared_ptrs aren't reference counted on every hand-off.
+ */
+template <size_t Capacity>
+class BasicTask {
+
+	static_assert(Capacity >= sizeof(void *), "Tasks need room for at least a pointer");
+
+public:
+	static const size_t CAPACITY = Capacity;
+
+	BasicTask() noexcept : mOps(nullptr) {}
+	BasicTask(std::nullptr_t) noexcept : mOps(nullptr) {}
+
+	template <typename Fn, typename = typename std::enable_if<!std::is_same<typename std::decay<Fn>::type, BasicTask>::value>::type>
+	BasicTask(Fn && fn) : mOps(nullptr) {
+		emplace(std::forward<Fn>(fn));
+	}
+
+	BasicTask(BasicTask && other) noexcept : mOps(other.mOps) {
+		if (mOps) {
+			mOps->move(mStorage, other.mStorage);
+			other.mOps = nullptr;
+		}
+	}
+
+	BasicTask & operator=(BasicTask && other) noexcept {
+		if (this != &other) {
+			reset();
+			if (other.mOps) {
+				mOps = other.mOps;
+				mOps->move(mStorage, other.mStorage);
+				other.mOps = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	BasicTask & operator=(std::nullptr_t) noexcept {
+		reset();
+		return *this;
+	}
+
+	BasicTask(const BasicTask &) = delete;
+	BasicTask & operator=(const BasicTask &) = delete;
+
+	~BasicTask() { reset(); }
+
+	//! Runs the callable. Must not be called on an empty task.
+	void operator()() { mOps->invoke(mStorage); }
+
+	explicit operator bool() const noexcept { return mOps != nullptr; }
+
+	//! True if the callable is stored inside the task rather than in a pooled block.
+	bool isInline() const noexcept { return mOps && mOps->isInline; }
+
+	void reset() noexcept {
+		if (mOps) {
+			mOps->destroy(mStorage);
+			mOps = nullptr;
+		}
+	}
+
+private:
+	struct Ops {
+		void (*invoke)(void * storage);
+		void (*move)(void * dst, void * src);
+		void (*destroy)(void * storage);
+		bool isInline;
+	};
+
+	//! Callable lives in mStorage.
+	template <typename Fn>
+	struct InlineOps {
+		static void invoke(void * storage) { (*static_cast<Fn *>(storage))(); }
+		static void move(void * dst, void * src) {
+			Fn * fn = static_cast<Fn *>(src);
+			new (dst) Fn(std::move(*fn));
+			fn->~Fn();
+		}
+		static void destroy(void * storage) { static_cast<Fn *>(storage)->~Fn(); }
+		static const Ops ops;
+	};
+
+	//! mStorage holds a pointer to the callable in a TaskPool block.
+	template <typename Fn>
+	struct PooledOps {
+		static void invoke(void * storage) { (**static_cast<Fn **>(storage))(); }
+		static void move(void * dst, void * src) { *static_cast<Fn **>(dst) = *static_cast<Fn **>(src); }
+		static void destroy(void * storage) {
+			Fn * fn = *static_cast<Fn **>(storage);
+			fn->~Fn();
+			TaskPool::release(fn, sizeof(Fn));
+		}
+		static const Ops ops;
+	};
+
+	template <typename Fn>
+	void emplace(Fn && fn) {
+		typedef typename std::decay<Fn>::type Callable;
+		static_assert(alignof(Callable) <= alignof(std::max_align_t), "Over-aligned callables aren't supported");
+
+		// moves between queues must not throw, so callables that could throw on move are pooled as well
+		typedef std::integral_constant<bool, sizeof(Callable) <= Capacity && std::is_nothrow_move_constructible<Callable>::value> IsInline;
+		emplace<Callable>(std::forward<Fn>(fn), IsInline());
+	}
+
+	template <typename Callable, typename Fn>
+	void emplace(Fn && fn, std::true_type) {
+		new (mStorage) Callable(std::forward<Fn>(fn));
+		mOps = &InlineOps<Callable>::ops;
+	}
+
+	template <typename Callable, typename Fn>
+	void emplace(Fn && fn, std::false_type) {
+		void * block = TaskPool::allocate(sizeof(Callable));
+		try {
+			new (block) Callable(std::forward<Fn>(fn));
+		} catch (...) {
+			TaskPool::release(block, sizeof(Callable));
+			throw;
+		}
+		*reinterpret_cast<Callable **>(mStorage) = static_cast<Callable *>(block);
+		mOps = &PooledOps<Callable>::ops;
+	}
+
+	alignas(std::max_align_t) unsigned char mStorage[Capacity];
+	const Ops * mOps;
+
+};
+
+template <size_t Capacity>
+template <typename Fn>
+const typename BasicTask<Capacity>::Ops BasicTask<Capacity>::InlineOps<Fn>::ops = {
+	&BasicTask<Capacity>::InlineOps<Fn>::invoke, &BasicTask<Capacity>::InlineOps<Fn>::move, &BasicTask<Capacity>::InlineOps<Fn>::destroy, true
+};
+
+template <size_t Capacity>
+template <typename Fn>
+const typename BasicTask<Capacity>::Ops BasicTask<Capacity>::PooledOps<Fn>::ops = {
+	&BasicTask<Capacity>::PooledOps<Fn>::invoke, &BasicTask<Capacity>::PooledOps<Fn>::move, &BasicTask<Capacity>::PooledOps<Fn>::destroy, false
+};
+
+typedef BasicTask<BLUECADET_ANALYTICS_TASK_CAPACITY> Task;
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
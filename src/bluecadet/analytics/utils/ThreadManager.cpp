@@ -32,18 +32,63 @@
 
 #include "ThreadManager.h"
 
-#include "cinder/Log.h"
+#include <functional>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BLUECADET_ANALYTICS_SSE2
+#endif
+
+#include "Log.h"
 
-using namespace ci;
-using namespace ci::app;
 using namespace std;
 
 namespace bluecadet {
 namespace analytics {
 namespace utils {
 
-ThreadManager::ThreadManager() {
-	AppBase::get()->getSignalCleanup().connect(bind(&ThreadManager::destroy, this));
+namespace {
+	const chrono::steady_clock::rep NO_TIMED_TASK = numeric_limits<chrono::steady_clock::rep>::max(); //! Value of mNextTimedTaskTime while there are no timed tasks
+	const size_t MIN_QUEUE_SIZE = 64;
+	const size_t MAX_RETAINED_QUEUE_SIZE = 4096;	//! Queues that grew past this during a burst free their storage once they're empty
+	const size_t DEFAULT_DEQUEUE_BATCH_SIZE = 8;
+	const int DEFAULT_MAX_SPIN_COUNT = 1000;
+	const int SPIN_YIELD_INTERVAL = 64;				//! Spinning workers yield this often so that they don't hold up producers on the same core
+
+	//! Tells the CPU that we're busy-waiting
+	inline void cpuRelax() {
+#if defined(BLUECADET_ANALYTICS_SSE2)
+		_mm_pause();
+#else
+		this_thread::yield();
+#endif
+	}
+}
+
+thread_local ThreadManager::Worker * ThreadManager::sCurrentWorker = nullptr;
+
+ThreadManager::ThreadManager() :
+	mIsCanceled(false),
+	mNextTimedTaskTime(NO_TIMED_TASK),
+	mNextTaskId(INVALID_TASK_ID + 1),
+	mNumLanes(1),
+	mWorkers(nullptr),
+	mNextWorkerIndex(0),
+	mDequeueBatchSize(DEFAULT_DEQUEUE_BATCH_SIZE),
+	mMaxSpinCount(DEFAULT_MAX_SPIN_COUNT),
+	mNumSpinningWorkers(0),
+	mNumSleepingWorkers(0),
+	mNumWakingWorkers(0),
+	mHasTimerWorker(false)
+{
+	mLanes[DEFAULT_LANE].name = "default";
+
+	// tasks added before setup() are queued on a single worker until threads are started
+	WorkerList * workers = new WorkerList();
+	workers->emplace_back(createWorker(0));
+	mWorkerLists.emplace_back(workers);
+	mWorkers = workers;
 }
 
 ThreadManager::~ThreadManager() {
@@ -56,33 +101,63 @@ void ThreadManager::setup(const int numThreads) {
 	lock_guard<mutex> lock(mThreadMutex);
 	mIsCanceled = false;
 
+	WorkerList * workers = mWorkers;
+	const size_t numWorkers = (size_t)max(1, numThreads);
+
+	if (workers->size() != numWorkers) {
+		WorkerList * newWorkers = new WorkerList();
+		for (size_t i = 0; i < numWorkers; ++i) {
+			newWorkers->emplace_back(createWorker(i));
+		}
+
+		// hand over tasks that haven't run yet
+		size_t i = 0;
+		for (auto & worker : *workers) {
+			lock_guard<mutex> workerLock(worker->mutex);
+			for (size_t lane = 0; lane < MAX_NUM_LANES; ++lane) {
+				TaskFn task;
+				while (worker->hasTasks(lane)) {
+					worker->popOldestTask(lane, task);
+					(*newWorkers)[i++ % numWorkers]->sharedTasks[lane].pushBack(std::move(task));
+				}
+				newWorkers->front()->numTasksAdded[lane] += worker->numTasksAdded[lane];
+			}
+		}
+
+		mWorkerLists.emplace_back(newWorkers);
+		mWorkers = newWorkers;
+		workers = newWorkers;
+	}
+
 	for (int i = 0; i < numThreads; ++i) {
 		try {
-			ThreadRef thread = ThreadRef(new std::thread(bind(&ThreadManager::processPendingTasks, this)));
+			ThreadRef thread = ThreadRef(new std::thread(bind(&ThreadManager::processPendingTasks, this, (*workers)[i].get())));
 			mThreads.push_back(thread);
 
-		} catch (Exception e) {
+		} catch (std::exception & e) {
 			CI_LOG_EXCEPTION("Failed to start worker thread", e);
 		}
 	}
 
-	mTaskCondition.notify_all();
-
 	CI_LOG_V("Started " << to_string(mThreads.size()) << " worker thread(s)");
 }
 
 void ThreadManager::destroy() {
 		lock_guard<mutex> lock(mThreadMutex);
 
-		mIsCanceled = true;
-		mTaskCondition.notify_all();
+		{
+			lock_guard<mutex> taskLock(mTaskMutex);
+			mIsCanceled = true;
+			mTaskCondition.notify_all();
+			mTimerCondition.notify_all();
+		}
 
 		for (auto thread : mThreads) {
 			try {
 				if (thread && thread->joinable()) {
 					thread->join();
 				}
-			} catch (Exception e) {
+			} catch (std::exception & e) {
 				CI_LOG_EXCEPTION("Failed to stop worker thread", e);
 			}
 		}
@@ -90,49 +165,714 @@ void ThreadManager::destroy() {
 		mThreads.clear();
 }
 
-void ThreadManager::addTask(TaskFn task) {
+void ThreadManager::addTask(TaskFn task, const LaneId lane) {
 	try {
-		unique_lock<mutex> lock(mTaskMutex);
-		mPendingTasks.push_back(task);
-		mTaskCondition.notify_one();
+		Worker * worker = sCurrentWorker;
 
-	} catch (Exception e) {
+		if (worker && worker->manager == this) {
+			// run follow-up tasks on the same thread first
+			requeueBatch(*worker);
+			pushTask(*worker, std::move(task), lane, true);
+
+		} else {
+			const WorkerList & workers = *mWorkers;
+			worker = workers[mNextWorkerIndex.fetch_add(1, memory_order_relaxed) % workers.size()].get();
+			pushTask(*worker, std::move(task), lane, false);
+		}
+
+		// spinning workers pick up new tasks without being woken up
+		if (mNumSleepingWorkers > 0 && mNumSpinningWorkers == 0) {
+			wakeWorker();
+		}
+
+	} catch (std::exception & e) {
 		CI_LOG_EXCEPTION("Failed to add task", e);
 	}
 }
 
-void ThreadManager::processPendingTasks() {
-	while (true) {
-		TaskFn task = nullptr;
+void ThreadManager::addTasks(TaskFn * begin, TaskFn * end, const LaneId lane) {
+	if (begin >= end) {
+		return;
+	}
+
+	try {
+		Worker * worker = sCurrentWorker;
+
+		if (worker && worker->manager == this) {
+			requeueBatch(*worker);
+			pushTasks(*worker, begin, end, lane, true);
+
+		} else {
+			const WorkerList & workers = *mWorkers;
+			const size_t numTasks = end - begin;
+			const size_t numChunks = min(workers.size(), numTasks);
+			const size_t firstWorkerIndex = mNextWorkerIndex.fetch_add(numChunks, memory_order_relaxed);
+
+			for (size_t i = 0; i < numChunks; ++i) {
+				Worker & chunkWorker = *workers[(firstWorkerIndex + i) % workers.size()];
+				pushTasks(chunkWorker, begin + numTasks * i / numChunks, begin + numTasks * (i + 1) / numChunks, lane, false);
+			}
+		}
+
+		// a woken worker wakes the next one if there's more work than it can take
+		if (mNumSleepingWorkers > 0 && mNumSpinningWorkers == 0) {
+			wakeWorker();
+		}
+
+	} catch (std::exception & e) {
+		CI_LOG_EXCEPTION("Failed to add tasks", e);
+	}
+}
+
+void ThreadManager::pushTask(Worker & worker, TaskFn && task, const LaneId lane, const bool isLocal) {
+	const LaneId laneId = lane < mNumLanes ? lane : DEFAULT_LANE;
+
+	{
+		lock_guard<mutex> lock(worker.mutex);
+		if (isLocal) {
+			worker.localTasks[laneId].pushBack(std::move(task));
+		} else {
+			worker.sharedTasks[laneId].pushBack(std::move(task));
+		}
+		worker.numTasksAdded[laneId]++;
+	}
+
+	updateQueueDepth(laneId, 1);
+}
+
+void ThreadManager::pushTasks(Worker & worker, TaskFn * begin, TaskFn * end, const LaneId lane, const bool isLocal) {
+	const LaneId laneId = lane < mNumLanes ? lane : DEFAULT_LANE;
+
+	{
+		lock_guard<mutex> lock(worker.mutex);
+		TaskQueue & tasks = isLocal ? worker.localTasks[laneId] : worker.sharedTasks[laneId];
+
+		for (TaskFn * task = begin; task != end; ++task) {
+			tasks.pushBack(std::move(*task));
+		}
+		worker.numTasksAdded[laneId] += end - begin;
+	}
+
+	updateQueueDepth(laneId, end - begin);
+}
+
+void ThreadManager::updateQueueDepth(const LaneId lane, const int64_t numTasksAdded) {
+	Lane & laneInfo = mLanes[lane];
+	const int64_t queueDepth = laneInfo.numQueuedTasks += numTasksAdded;
+	int64_t maxQueueDepth = laneInfo.maxNumQueuedTasks.load(memory_order_relaxed);
+	while (queueDepth > maxQueueDepth && !laneInfo.maxNumQueuedTasks.compare_exchange_weak(maxQueueDepth, queueDepth, memory_order_relaxed)) {}
+}
+
+size_t ThreadManager::getNumThreads() {
+	lock_guard<mutex> lock(mThreadMutex);
+	return mThreads.size();
+}
+
+ThreadManager::TaskId ThreadManager::addDelayedTask(TaskFn task, const double delay, const LaneId lane) {
+	return addTimedTask(std::move(task), delay, 0.0, lane);
+}
+
+ThreadManager::TaskId ThreadManager::addPeriodicTask(TaskFn task, const double interval, const LaneId lane) {
+	if (interval <= 0.0) {
+		CI_LOG_W("Periodic tasks require an interval greater than 0");
+		return INVALID_TASK_ID;
+	}
+	return addTimedTask(std::move(task), interval, interval, lane);
+}
+
+bool ThreadManager::cancelTask(const TaskId taskId) {
+	lock_guard<mutex> lock(mTaskMutex);
+
+	for (auto it = mTimedTasks.begin(); it != mTimedTasks.end(); ++it) {
+		if (it->second.id == taskId) {
+			mTimedTasks.erase(it);
+			updateNextTimedTaskTime();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+ThreadManager::LaneId ThreadManager::addLane(const std::string & name, const int weight) {
+	lock_guard<mutex> lock(mLaneMutex);
+
+	const size_t numLanes = mNumLanes;
+
+	for (size_t i = 0; i < numLanes; ++i) {
+		if (mLanes[i].name == name) {
+			return i;
+		}
+	}
+
+	if (numLanes >= MAX_NUM_LANES) {
+		CI_LOG_W("Can't add lane '" << name << "'; tasks will run on the default lane instead");
+		return DEFAULT_LANE;
+	}
+
+	mLanes[numLanes].name = name;
+	mLanes[numLanes].weight = max(1, weight);
+	mNumLanes = numLanes + 1; // publishes the lane to addTask()
+
+	return numLanes;
+}
+
+void ThreadManager::setLaneWeight(const LaneId lane, const int weight) {
+	if (lane < mNumLanes) {
+		mLanes[lane].weight = max(1, weight);
+	}
+}
+
+std::vector<ThreadManager::LaneStats> ThreadManager::getLaneStats() {
+	const size_t numLanes = mNumLanes;
+	vector<LaneStats> stats(numLanes);
+
+	for (size_t i = 0; i < numLanes; ++i) {
+		stats[i].name = mLanes[i].name;
+		stats[i].weight = mLanes[i].weight;
+		stats[i].maxQueueDepth = (size_t)mLanes[i].maxNumQueuedTasks;
+	}
+
+	for (const auto & worker : *mWorkers) {
+		lock_guard<mutex> lock(worker->mutex);
+		for (size_t i = 0; i < numLanes; ++i) {
+			stats[i].queueDepth += worker->getNumTasks(i);
+			stats[i].numTasksAdded += (size_t)worker->numTasksAdded[i];
+		}
+	}
+
+	for (auto & laneStats : stats) {
+		laneStats.numTasksRun = laneStats.numTasksAdded - laneStats.queueDepth;
+	}
+
+	return stats;
+}
+
+ThreadManager::TaskId ThreadManager::addTimedTask(TaskFn task, const double delay, const double interval, const LaneId lane) {
+	const auto toDuration = [](const double seconds) {
+		return chrono::duration_cast<Clock::duration>(chrono::duration<double>(max(seconds, 0.0)));
+	};
+
+	try {
+		unique_lock<mutex> lock(mTaskMutex);
+
+		TimedTask timedTask;
+		timedTask.id = mNextTaskId++;
+		timedTask.task = make_shared<TaskFn>(std::move(task));
+		timedTask.interval = toDuration(interval);
+		timedTask.lane = lane;
+
+		if (timedTask.interval > Clock::duration::zero()) {
+			timedTask.isQueued = make_shared<atomic<bool>>(false);
+		}
+
+		const Clock::time_point dueTime = Clock::now() + toDuration(delay);
+		const bool isNextTask = mTimedTasks.empty() || dueTime < mTimedTasks.begin()->first;
+
+		mTimedTasks.insert(make_pair(dueTime, timedTask));
+		updateNextTimedTaskTime();
+
+		if (mHasTimerWorker) {
+			// the worker that waits for timed tasks only needs to adjust its wait time if this task is due earlier
+			if (isNextTask) {
+				mTimerCondition.notify_one();
+			}
+		} else {
+			mTaskCondition.notify_one();
+		}
+
+		return timedTask.id;
+
+	} catch (std::exception & e) {
+		CI_LOG_EXCEPTION("Failed to add timed task", e);
+	}
+
+	return INVALID_TASK_ID;
+}
+
+ThreadManager::Worker * ThreadManager::createWorker(const size_t index) {
+	Worker * worker = new Worker();
+	worker->index = index;
+	worker->manager = this;
+	worker->credits.fill(0);
+	worker->numTasksAdded.fill(0);
+	worker->spinCount = mMaxSpinCount;
+	worker->batchIndex = 0;
+	worker->batchEnd = 0;
+	return worker;
+}
+
+void ThreadManager::processPendingTasks(Worker * worker) {
+	sCurrentWorker = worker;
+
+	bool isWaking = false; // true after waking up or spinning until tasks were found
+
+	while (!mIsCanceled) {
+		size_t numTasks = 0;
 
 		try {
-			// grab a task from the queue
-			unique_lock<mutex> lock(mTaskMutex);
+			const size_t batchSize = mDequeueBatchSize;
+			if (worker->batch.size() != batchSize) {
+				worker->batch.resize(batchSize);
+				worker->batchLanes.resize(batchSize);
+			}
 
-			while (!mIsCanceled && mPendingTasks.empty()) {
-				mTaskCondition.wait(lock); // wait
+			const Clock::rep nextTimedTaskTime = mNextTimedTaskTime.load(memory_order_relaxed);
+			if (nextTimedTaskTime != NO_TIMED_TASK && Clock::now().time_since_epoch().count() >= nextTimedTaskTime) {
+				queueDueTimedTasks(*worker);
 			}
 
-			if (mIsCanceled) {
-				return; // cancel
+			numTasks = popTasks(*worker);
+			if (numTasks == 0) {
+				numTasks = stealTasks(*worker);
 			}
 
-			task = mPendingTasks.front();
-			mPendingTasks.pop_front();
+			if (numTasks > 0) {
+				if (isWaking) {
+					// pass the wake-up on if there's more work than this worker can take
+					isWaking = false;
+					if (mNumSleepingWorkers > 0 && mNumSpinningWorkers == 0 && getQueuedLanes() != 0) {
+						wakeWorker();
+					}
+				}
+
+			} else if (spinForTasks(*worker)) {
+				isWaking = true;
+				continue;
+
+			} else {
+				isWaking = !waitForTask(worker->batch[0], worker->batchLanes[0]);
+				if (isWaking) {
+					continue;
+				}
+				numTasks = 1;
+				lock_guard<mutex> lock(worker->mutex);
+				worker->numTasksAdded[worker->batchLanes[0]]++;
+			}
 
-		} catch (Exception e) {
+		} catch (std::exception & e) {
 			CI_LOG_EXCEPTION("Failed to process task", e);
 		}
 
-		if (task) {
-			try {
-				// run task
-				task();
-			} catch (Exception e) {
-				CI_LOG_EXCEPTION("Failed to execute task", e);
+		worker->batchIndex = 0;
+		worker->batchEnd = numTasks;
+
+		// tasks that add follow-up tasks shorten the batch (see addTask())
+		while (worker->batchIndex < worker->batchEnd) {
+			if (mIsCanceled) {
+				requeueBatch(*worker);
+				break;
+			}
+
+			// move the task out of the batch so that what it captured is released as soon as it's done
+			TaskFn task = std::move(worker->batch[worker->batchIndex++]);
+
+			if (task) {
+				try {
+					// run task
+					task();
+				} catch (std::exception & e) {
+					CI_LOG_EXCEPTION("Failed to execute task", e);
+				}
+			}
+		}
+	}
+
+	sCurrentWorker = nullptr;
+}
+
+size_t ThreadManager::popTasks(Worker & worker) {
+	const size_t numLanes = mNumLanes;
+	const size_t maxTasks = worker.batch.size();
+	const bool canBeStolen = (*mWorkers).size() > 1;
+
+	array<int64_t, MAX_NUM_LANES> numTasksTaken;
+	numTasksTaken.fill(0);
+	size_t numTasks = 0;
+
+	{
+		lock_guard<mutex> lock(worker.mutex);
+
+		uint32_t laneMask = 0;
+		size_t numQueuedTasks = 0;
+
+		for (size_t i = 0; i < numLanes; ++i) {
+			if (worker.hasTasks(i)) {
+				laneMask |= 1u << i;
+				numQueuedTasks += worker.getNumTasks(i);
+			}
+		}
+
+		// leave half of a short queue for idle workers to steal
+		const size_t numTasksToTake = min(maxTasks, canBeStolen ? (numQueuedTasks + 1) / 2 : numQueuedTasks);
+
+		while (numTasks < numTasksToTake && laneMask != 0) {
+			const LaneId lane = selectLane(worker, laneMask);
+
+			worker.popNextTask(lane, worker.batch[numTasks]);
+			worker.batchLanes[numTasks] = lane;
+			numTasksTaken[lane]++;
+			numTasks++;
+
+			if (!worker.hasTasks(lane)) {
+				laneMask &= ~(1u << lane);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < numLanes; ++i) {
+		if (numTasksTaken[i] > 0) {
+			mLanes[i].numQueuedTasks -= numTasksTaken[i];
+		}
+	}
+
+	return numTasks;
+}
+
+size_t ThreadManager::stealTasks(Worker & worker) {
+	const uint32_t laneMask = getQueuedLanes();
+
+	if (laneMask == 0) {
+		return 0;
+	}
+
+	const WorkerList & workers = *mWorkers;
+	const size_t numLanes = mNumLanes;
+	const size_t maxTasks = worker.batch.size();
+	const LaneId preferredLane = selectLane(worker, laneMask);
+
+	// try the preferred lane of all other workers first, then any lane
+	for (size_t pass = 0; pass < 2; ++pass) {
+		for (size_t i = 1; i < workers.size(); ++i) {
+			Worker & victim = *workers[(worker.index + i) % workers.size()];
+			lock_guard<mutex> lock(victim.mutex);
+
+			for (size_t j = 0; j < numLanes; ++j) {
+				const LaneId lane = (preferredLane + j) % numLanes;
+
+				if (victim.hasTasks(lane)) {
+					// take the oldest half; the victim keeps its newest, warmest tasks
+					const size_t numTasks = min(maxTasks, (victim.getNumTasks(lane) + 1) / 2);
+
+					for (size_t k = 0; k < numTasks; ++k) {
+						victim.popOldestTask(lane, worker.batch[k]);
+						worker.batchLanes[k] = lane;
+					}
+
+					mLanes[lane].numQueuedTasks -= numTasks;
+					return numTasks;
+				}
+
+				if (pass == 0) {
+					break;
+				}
 			}
 		}
 	}
+
+	return 0;
+}
+
+bool ThreadManager::spinForTasks(Worker & worker) {
+	const int maxSpinCount = mMaxSpinCount;
+
+	if (maxSpinCount <= 0) {
+		return false;
+	}
+
+	// spin longer while spinning pays off and shorter while it doesn't
+	const int minSpinCount = max(1, maxSpinCount / 32);
+	worker.spinCount = min(max(worker.spinCount, minSpinCount), maxSpinCount);
+
+	mNumSpinningWorkers++;
+
+	bool hasTasks = false;
+
+	for (int i = 0; i < worker.spinCount && !mIsCanceled; ++i) {
+		const Clock::rep nextTimedTaskTime = mNextTimedTaskTime.load(memory_order_relaxed);
+
+		if (getQueuedLanes() != 0 || (nextTimedTaskTime != NO_TIMED_TASK && Clock::now().time_since_epoch().count() >= nextTimedTaskTime)) {
+			hasTasks = true;
+			break;
+		}
+
+		if ((i + 1) % SPIN_YIELD_INTERVAL == 0) {
+			this_thread::yield();
+		} else {
+			cpuRelax();
+		}
+	}
+
+	// producers that saw us spinning didn't wake anyone, so we'll check for their tasks once more in waitForTask()
+	mNumSpinningWorkers--;
+
+	worker.spinCount = hasTasks ? min(maxSpinCount, worker.spinCount * 2) : max(minSpinCount, worker.spinCount / 2);
+
+	return hasTasks;
+}
+
+void ThreadManager::requeueBatch(Worker & worker) {
+	const size_t begin = worker.batchIndex;
+	const size_t end = worker.batchEnd;
+
+	if (begin >= end) {
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(worker.mutex);
+
+		// in reverse, so that they're taken again in the same order
+		for (size_t i = end; i > begin; --i) {
+			worker.localTasks[worker.batchLanes[i - 1]].pushBack(std::move(worker.batch[i - 1]));
+		}
+	}
+
+	for (size_t i = begin; i < end; ++i) {
+		mLanes[worker.batchLanes[i]].numQueuedTasks++;
+	}
+
+	worker.batchEnd = begin;
+}
+
+uint32_t ThreadManager::getQueuedLanes() {
+	const size_t numLanes = mNumLanes;
+	uint32_t laneMask = 0;
+
+	for (size_t i = 0; i < numLanes; ++i) {
+		if (mLanes[i].numQueuedTasks > 0) {
+			laneMask |= 1u << i;
+		}
+	}
+
+	return laneMask;
+}
+
+ThreadManager::LaneId ThreadManager::selectLane(Worker & worker, const uint32_t laneMask) {
+	if ((laneMask & (laneMask - 1)) == 0) {
+		// only one lane has tasks, so nobody is waiting for a turn
+		worker.credits.fill(0);
+		LaneId lane = DEFAULT_LANE;
+		while ((laneMask & (1u << lane)) == 0) {
+			++lane;
+		}
+		return lane;
+	}
+
+	// smooth weighted round-robin: every waiting lane earns its weight, the richest lane runs and pays the total
+	const size_t numLanes = mNumLanes;
+	LaneId lane = DEFAULT_LANE;
+	int totalWeight = 0;
+	bool hasLane = false;
+
+	for (size_t i = 0; i < numLanes; ++i) {
+		if ((laneMask & (1u << i)) == 0) {
+			worker.credits[i] = 0;
+			continue;
+		}
+
+		const int weight = mLanes[i].weight;
+		worker.credits[i] += weight;
+		totalWeight += weight;
+
+		if (!hasLane || worker.credits[i] > worker.credits[lane]) {
+			lane = i;
+			hasLane = true;
+		}
+	}
+
+	worker.credits[lane] -= totalWeight;
+	return lane;
+}
+
+bool ThreadManager::waitForTask(TaskFn & task, LaneId & lane) {
+	unique_lock<mutex> lock(mTaskMutex);
+
+	// addTask() increments its lane's numQueuedTasks before it checks mNumSleepingWorkers and we check in the opposite order,
+	// so either we see the new task or it sees us and wakes us up
+	mNumSleepingWorkers++;
+
+	bool isTimerWorker = false;
+	bool hasTask = false;
+
+	while (!mIsCanceled && getQueuedLanes() == 0) {
+		if (!mTimedTasks.empty()) {
+			const Clock::time_point dueTime = mTimedTasks.begin()->first;
+			const Clock::time_point now = Clock::now();
+
+			if (dueTime <= now) {
+				if (takeDueTimedTask(now, task, lane)) {
+					hasTask = true;
+					break;
+				}
+				continue; // skipped a periodic run that's still queued
+			}
+
+			// only one sleeping worker waits for the next timed task so that the others aren't all woken up when it's due
+			if (!mHasTimerWorker || isTimerWorker) {
+				mHasTimerWorker = isTimerWorker = true;
+				mTimerCondition.wait_until(lock, dueTime);
+				mNumWakingWorkers = max(0, mNumWakingWorkers - 1);
+				continue;
+			}
+		}
+
+		mTaskCondition.wait(lock); // wait for new tasks
+		mNumWakingWorkers = max(0, mNumWakingWorkers - 1);
+	}
+
+	if (isTimerWorker) {
+		mHasTimerWorker = false;
+
+		// let another sleeping worker take over waiting for timed tasks
+		if (!mTimedTasks.empty() && mNumSleepingWorkers > 1) {
+			mTaskCondition.notify_one();
+		}
+	}
+
+	mNumSleepingWorkers--;
+
+	return hasTask;
+}
+
+void ThreadManager::queueDueTimedTasks(Worker & worker) {
+	vector<pair<LaneId, TaskFn>> dueTasks;
+
+	{
+		lock_guard<mutex> lock(mTaskMutex);
+		const Clock::time_point now = Clock::now();
+
+		while (!mTimedTasks.empty() && mTimedTasks.begin()->first <= now) {
+			TaskFn task;
+			LaneId lane = DEFAULT_LANE;
+			if (takeDueTimedTask(now, task, lane)) {
+				dueTasks.push_back(make_pair(lane, std::move(task)));
+			}
+		}
+	}
+
+	// due tasks queue up behind what's already waiting in their lane
+	for (auto & dueTask : dueTasks) {
+		pushTask(worker, std::move(dueTask.second), dueTask.first, false);
+	}
+
+	if (!dueTasks.empty() && mNumSleepingWorkers > 0 && mNumSpinningWorkers == 0) {
+		wakeWorker();
+	}
+}
+
+bool ThreadManager::takeDueTimedTask(const Clock::time_point now, TaskFn & task, LaneId & lane) {
+	const auto it = mTimedTasks.begin();
+	const Clock::time_point dueTime = it->first;
+	TimedTask timedTask = std::move(it->second);
+	mTimedTasks.erase(it);
+
+	if (timedTask.interval > Clock::duration::zero()) {
+		// reschedule periodic task; skip any runs we've fallen behind on
+		Clock::time_point nextDueTime = dueTime + timedTask.interval;
+		if (nextDueTime <= now) {
+			nextDueTime = now + timedTask.interval;
+		}
+		mTimedTasks.insert(make_pair(nextDueTime, timedTask));
+	}
+
+	updateNextTimedTaskTime();
+
+	if (timedTask.isQueued) {
+		if (timedTask.isQueued->exchange(true)) {
+			return false; // the previous run is still waiting in its lane
+		}
+
+		const shared_ptr<atomic<bool>> isQueued = timedTask.isQueued;
+		const shared_ptr<TaskFn> periodicTask = timedTask.task;
+		task = [isQueued, periodicTask] {
+			*isQueued = false;
+			(*periodicTask)();
+		};
+
+	} else {
+		task = std::move(*timedTask.task);
+	}
+
+	lane = timedTask.lane;
+	return true;
+}
+
+void ThreadManager::updateNextTimedTaskTime() {
+	mNextTimedTaskTime.store(mTimedTasks.empty() ? NO_TIMED_TASK : mTimedTasks.begin()->first.time_since_epoch().count(), memory_order_relaxed);
+}
+
+void ThreadManager::wakeWorker() {
+	lock_guard<mutex> lock(mTaskMutex);
+
+	if (mNumWakingWorkers > 0) {
+		return; // the worker that's waking up will either take the new task or wake another worker
+	}
+
+	if (mNumSleepingWorkers > (mHasTimerWorker ? 1 : 0)) {
+		mNumWakingWorkers++;
+		mTaskCondition.notify_one();
+	} else if (mHasTimerWorker) {
+		mNumWakingWorkers++;
+		mTimerCondition.notify_one();
+	}
+}
+
+void ThreadManager::Worker::popNextTask(const size_t lane, TaskFn & task) {
+	if (!localTasks[lane].empty()) {
+		localTasks[lane].popBack(task);
+	} else {
+		sharedTasks[lane].popFront(task);
+	}
+}
+
+void ThreadManager::Worker::popOldestTask(const size_t lane, TaskFn & task) {
+	if (!sharedTasks[lane].empty()) {
+		sharedTasks[lane].popFront(task);
+	} else {
+		localTasks[lane].popFront(task);
+	}
+}
+
+void ThreadManager::TaskQueue::pushBack(TaskFn && task) {
+	if (mSize == mTasks.size()) {
+		grow();
+	}
+	mTasks[(mHead + mSize) & (mTasks.size() - 1)] = std::move(task);
+	mSize++;
+}
+
+void ThreadManager::TaskQueue::popBack(TaskFn & task) {
+	mSize--;
+	task = std::move(mTasks[(mHead + mSize) & (mTasks.size() - 1)]);
+
+	if (mSize == 0 && mTasks.size() > MAX_RETAINED_QUEUE_SIZE) {
+		// let go of storage after a burst
+		vector<TaskFn>().swap(mTasks);
+		mHead = 0;
+	}
+}
+
+void ThreadManager::TaskQueue::popFront(TaskFn & task) {
+	task = std::move(mTasks[mHead]);
+	mHead = (mHead + 1) & (mTasks.size() - 1);
+	mSize--;
+
+	if (mSize == 0 && mTasks.size() > MAX_RETAINED_QUEUE_SIZE) {
+		vector<TaskFn>().swap(mTasks);
+		mHead = 0;
+	}
+}
+
+void ThreadManager::TaskQueue::grow() {
+	vector<TaskFn> tasks(max(MIN_QUEUE_SIZE, mTasks.size() * 2));
+
+	for (size_t i = 0; i < mSize; ++i) {
+		tasks[i] = std::move(mTasks[(mHead + i) & (mTasks.size() - 1)]);
+	}
+
+	mTasks.swap(tasks);
+	mHead = 0;
 }
 
 } // utils namespace
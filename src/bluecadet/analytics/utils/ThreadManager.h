@@ -31,9 +31,20 @@
  */
 
 #pragma once
-#include "cinder/app/App.h"
-#include "cinder/app/RendererGl.h"
-#include "cinder/gl/gl.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Task.h"
 
 namespace bluecadet {
 namespace analytics {
@@ -41,29 +52,194 @@ namespace utils {
 
 typedef std::shared_ptr<class ThreadManager> ThreadManagerRef;
 typedef std::shared_ptr<std::thread> ThreadRef;
-typedef std::function<void(void)> TaskFn;
+typedef Task TaskFn; // move-only; see Task.h
+
+/*!
+ Pool of worker threads that runs tasks right away, after a delay or periodically.
+
+ Each worker has its own task queue. Tasks added from a worker thread go to that worker's queue and run
+ last in, first out, which keeps follow-up work (e.g. sending the batches that a task just assembled)
+ on the same, warm thread. Tasks added from other threads are spread across workers round-robin and run
+ in the order they were added. Workers that run out of tasks steal the oldest tasks of other workers
+ before going to sleep, and sleeping workers are only woken when there is work that nobody else picks up.
 
+ Workers take up to getDequeueBatchSize() tasks per lock, leaving at least half of a short queue for others
+ to steal, and steal up to half of another worker's lane at once. A task that adds follow-up tasks hands the
+ rest of its batch back first, so that its follow-ups still run next. Before going to sleep, a worker spins for
+ a while in case more tasks arrive; the spin time adapts to how often that pays off, up to getMaxSpinCount().
+
+ Tasks can be added to named lanes so that a burst of one kind of work doesn't hold up the others. When
+ several lanes have tasks, workers pick from them by weighted round-robin, e.g. a lane with weight 4 gets
+ four turns for every turn of a lane with weight 1. Weights apply to each worker's own queue and to the
+ tasks that idle workers steal. Delayed and periodic tasks join their lane's queue once they are due.
+
+ All methods are virtual so that a custom executor can be passed to AnalyticsClient::setThreadManager(),
+ e.g. one that runs tasks inline for deterministic tests or one that shares threads with the rest of an app.
+ */
 class ThreadManager {
 
 public:
+	typedef uint64_t TaskId;
+	static const TaskId INVALID_TASK_ID = 0;
+
+	typedef size_t LaneId;
+	static const LaneId DEFAULT_LANE = 0;
+	static const size_t MAX_NUM_LANES = 8;
+
+	struct LaneStats {
+		std::string	name;
+		int			weight = 0;
+		size_t		queueDepth = 0;			//! Tasks waiting to run
+		size_t		maxQueueDepth = 0;		//! Most tasks that were waiting at once
+		size_t		numTasksAdded = 0;		//! Including delayed and periodic runs once they're due
+		size_t		numTasksRun = 0;			//! Tasks that have started, including the ones that are still running
+	};
+
 	ThreadManager();
-	~ThreadManager();
+	virtual ~ThreadManager();
+
+	virtual void setup(const int numThreads = 1);
+	//! Stops all worker threads once their current tasks are done. Tasks that haven't started stay queued and
+	//! run after the next setup(). AnalyticsClient calls this on app cleanup before exit.
+	virtual void destroy();
+	virtual void addTask(TaskFn task, const LaneId lane = DEFAULT_LANE);
+	virtual size_t getNumThreads(); // number of running worker threads
+
+	//! Adds all tasks in [begin, end), moving them out of the range, and wakes workers at most once.
+	//! Tasks from outside the pool are split into one contiguous chunk per worker.
+	virtual void addTasks(TaskFn * begin, TaskFn * end, const LaneId lane = DEFAULT_LANE);
+	void addTasks(std::vector<TaskFn> & tasks, const LaneId lane = DEFAULT_LANE) { addTasks(tasks.data(), tasks.data() + tasks.size(), lane); tasks.clear(); }
+
+	//! Runs task once on a worker thread after delay seconds. Returns an id that can be used to cancel the task.
+	virtual TaskId addDelayedTask(TaskFn task, const double delay, const LaneId lane = DEFAULT_LANE);
+
+	//! Runs task on a worker thread every interval seconds, starting after the first interval. Runs are skipped
+	//! rather than queued up if the workers fall behind. Returns an id that can be used to cancel the task.
+	virtual TaskId addPeriodicTask(TaskFn task, const double interval, const LaneId lane = DEFAULT_LANE);
 
-	void setup(const int numThreads = 1);
-	void destroy(); // called automatically on app cleanup before exit
-	void addTask(TaskFn task);
+	//! Removes a delayed or periodic task. Has no effect on runs that have already started. Returns false if the task wasn't found.
+	virtual bool cancelTask(const TaskId taskId);
+
+	//! Returns the lane with this name, adding it with weight if it doesn't exist yet. Falls back to
+	//! DEFAULT_LANE once MAX_NUM_LANES lanes exist. The default lane is named "default" and has weight 1.
+	virtual LaneId addLane(const std::string & name, const int weight = 1);
+	virtual void setLaneWeight(const LaneId lane, const int weight); // relative share of turns while other lanes have tasks; at least 1
+	virtual std::vector<LaneStats> getLaneStats(); // one entry per lane, in the order they were added
+
+	//! Most tasks a worker takes from a queue per lock. Defaults to 8. 1 takes one task at a time.
+	size_t getDequeueBatchSize() const { return mDequeueBatchSize; }
+	void setDequeueBatchSize(const size_t value) { mDequeueBatchSize = std::max<size_t>(1, value); }
+
+	//! Most iterations an idle worker spins while checking for new tasks before it goes to sleep. Defaults to 1000
+	//! (a few microseconds). Workers spin less while spinning doesn't find tasks. 0 disables spinning.
+	int getMaxSpinCount() const { return mMaxSpinCount; }
+	void setMaxSpinCount(const int value) { mMaxSpinCount = std::max(0, value); }
 
 protected:
-	void processPendingTasks(); // Runs on worker thread
+	typedef std::chrono::steady_clock Clock;
+
+	struct TimedTask {
+		TaskId				id;
+		std::shared_ptr<TaskFn>	task; // shared by the reruns of periodic tasks
+		Clock::duration		interval; // zero for one-off tasks
+		LaneId				lane;
+		std::shared_ptr<std::atomic<bool>>	isQueued; // periodic tasks only; true while a run waits in its lane
+	};
+
+	struct Lane {
+		std::string				name;
+		std::atomic<int>		weight{1};
+		std::atomic<int64_t>	numQueuedTasks{0};
+		std::atomic<int64_t>	maxNumQueuedTasks{0};
+	};
+
+	//! Double-ended ring buffer of tasks. Unlike std::deque it keeps its storage while tasks pass through,
+	//! so queueing doesn't allocate once it has grown to fit the usual backlog.
+	class TaskQueue {
+	public:
+		bool empty() const { return mSize == 0; }
+		size_t size() const { return mSize; }
+		void pushBack(TaskFn && task);
+		void popBack(TaskFn & task); // must not be empty
+		void popFront(TaskFn & task); // must not be empty
+	protected:
+		void grow();
+		std::vector<TaskFn>	mTasks; // size is zero or a power of two
+		size_t				mHead = 0; // index of the front task
+		size_t				mSize = 0;
+	};
+
+	//! Tasks of one worker, per lane. Tasks added by the owning thread go to localTasks and run last in, first out;
+	//! tasks added by other threads go to sharedTasks and run first in, first out. The owner runs its local tasks
+	//! first. Thieves take the oldest tasks: shared tasks first, then local tasks from the front.
+	struct Worker {
+		size_t				index;
+		ThreadManager *		manager;
+		std::mutex			mutex;
+		std::array<TaskQueue, MAX_NUM_LANES>			localTasks;
+		std::array<TaskQueue, MAX_NUM_LANES>			sharedTasks;
+		std::array<int, MAX_NUM_LANES>					credits; // round-robin state; only used by the owning thread
+		std::array<uint64_t, MAX_NUM_LANES>				numTasksAdded; // guarded by mutex
+		std::vector<TaskFn>								batch; // tasks taken in one go; only used by the owning thread
+		std::vector<LaneId>								batchLanes;
+		size_t											batchIndex; // next task in batch to run
+		size_t											batchEnd; // end of the tasks in batch
+		int												spinCount; // current spin limit; only used by the owning thread
+
+		// all expect mutex to be locked
+		bool hasTasks(const size_t lane) const { return !localTasks[lane].empty() || !sharedTasks[lane].empty(); }
+		size_t getNumTasks(const size_t lane) const { return localTasks[lane].size() + sharedTasks[lane].size(); }
+		void popNextTask(const size_t lane, TaskFn & task); // next task for the owner to run; lane must have tasks
+		void popOldestTask(const size_t lane, TaskFn & task); // oldest task for a thief; lane must have tasks
+	};
+
+	typedef std::vector<std::unique_ptr<Worker>> WorkerList;
+
+	Worker * createWorker(const size_t index);
+	void processPendingTasks(Worker * worker); // Runs on worker thread
+	void pushTask(Worker & worker, TaskFn && task, const LaneId lane, const bool isLocal);
+	void pushTasks(Worker & worker, TaskFn * begin, TaskFn * end, const LaneId lane, const bool isLocal);
+	void updateQueueDepth(const LaneId lane, const int64_t numTasksAdded);
+	size_t popTasks(Worker & worker); // moves up to mDequeueBatchSize tasks into worker.batch and returns how many
+	size_t stealTasks(Worker & worker); // same for tasks of other workers
+	bool spinForTasks(Worker & worker); // returns true if tasks were queued while spinning
+	void requeueBatch(Worker & worker); // puts the tasks of the batch that haven't run yet back into the worker's queue
+	LaneId selectLane(Worker & worker, const uint32_t laneMask); // picks one of the lanes in laneMask by weighted round-robin
+	uint32_t getQueuedLanes(); // bit mask of lanes with queued tasks; may briefly be off by the tasks that are being added or removed
+	bool waitForTask(TaskFn & task, LaneId & lane); // Sleeps until tasks are queued or a timed task is due. Returns true if task was set to a due timed task.
+	void wakeWorker();
+	TaskId addTimedTask(TaskFn task, const double delay, const double interval, const LaneId lane);
+	void queueDueTimedTasks(Worker & worker); // moves timed tasks that are due into their lanes while workers are busy
+	bool takeDueTimedTask(const Clock::time_point now, TaskFn & task, LaneId & lane); // mTaskMutex must be locked. Returns false if the first timed task isn't due or is still queued.
+	void updateNextTimedTaskTime(); // mTaskMutex must be locked.
+
+	static thread_local Worker * sCurrentWorker; // worker of the calling thread, if it's a worker thread
 	
-	bool mIsCanceled;
+	std::atomic<bool> mIsCanceled;
 
 	std::mutex mThreadMutex; // for thread management (starting, stopping, etc)
-	std::mutex mTaskMutex; // for task processing and management
-	std::condition_variable mTaskCondition;
-	std::deque<TaskFn> mPendingTasks;
+	std::mutex mTaskMutex; // for timed tasks and sleeping workers
+	std::condition_variable mTaskCondition; // signals sleeping workers that there are new tasks
+	std::condition_variable mTimerCondition; // signals the worker that waits for the next timed task
+	std::multimap<Clock::time_point, TimedTask> mTimedTasks; // ordered by due time
+	std::atomic<Clock::rep> mNextTimedTaskTime; // due time of the first timed task, so busy workers can check it without locking
+	TaskId mNextTaskId;
 	std::vector<ThreadRef> mThreads;
 
+	std::mutex mLaneMutex; // for adding lanes
+	std::array<Lane, MAX_NUM_LANES> mLanes;
+	std::atomic<size_t> mNumLanes;
+
+	std::atomic<WorkerList *> mWorkers;
+	std::vector<std::unique_ptr<WorkerList>> mWorkerLists; // lists are never freed while running, so addTask() can use mWorkers without locking
+	std::atomic<size_t> mNextWorkerIndex; // round-robin target for tasks from other threads
+	std::atomic<size_t> mDequeueBatchSize;
+	std::atomic<int> mMaxSpinCount;
+	std::atomic<int> mNumSpinningWorkers;
+	std::atomic<int> mNumSleepingWorkers;
+	int mNumWakingWorkers; // workers that have been signaled but haven't looked for tasks yet; guarded by mTaskMutex
+	bool mHasTimerWorker; // true while a sleeping worker waits for the next timed task
+
 };
 
 } // utils namespace
@@ -29,43 +29,38 @@
  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-
 #include "UrlRequest.h"
 
-using namespace ci;
-using namespace ci::app;
+#include <algorithm>
+#include <iostream>
+
+#include "boost/algorithm/string.hpp"
+
 using namespace std;
 
 namespace bluecadet {
 namespace analytics {
 namespace utils {
 
-UrlRequest::UrlRequest(const std::string& host, const std::string& uri, Options options) :
-	// params
-	mHost(host),
+UrlRequest::UrlRequest(asio::io_service & io, const std::string& host, const std::string& uri) :
+	UrlRequest(io, host, uri, Options())
+{
+}
 
-	// defaults
+UrlRequest::UrlRequest(asio::io_service & io, const std::string& host, const std::string& uri, Options options) :
+	mIo(io),
 	mCallback(nullptr),
-	mBytesRead(0),
-	mContentLength(0)
+	mHost(host),
+	mPort(80),
+	mConnectionPool(options.connectionPool),
+	mDnsCache(options.dnsCache ? options.dnsCache : DnsCache::getInstance()),
+	mIsSocketReused(false),
+	mHasRetried(false),
+	mBytesRead(0)
 {
 
-	// create request and set header
-	mHttpRequest = HttpRequest(methodToString(options.method), uri, options.version);
-	mHttpRequest.setHeader("Host", mHost);
-
-	// set body and automatically set content length
-	if (options.body) {
-		mHttpRequest.setHeader("Content-Length", toString<size_t>(options.body->getSize()));
-		mHttpRequest.setBody(options.body);
-	}
-
-	// set additional user headers (overwrites any defaults)
-	for (const KeyValuePair& kvp : options.headers) {
-		mHttpRequest.setHeader(kvp.first, kvp.second);
-	}
-
-	mClient = TcpClient::create(AppBase::get()->io_service());
+	// serialize request once; it's sent again as is on retries
+	mRequestData = createRequestData(mHost, uri, std::move(options), mConnectionPool != nullptr);
 }
 
 UrlRequest::~UrlRequest() {
@@ -84,17 +79,25 @@ void UrlRequest::connect(Callback callback, int port) {
 	//cout << "UrlRequest: connecting" << endl;
 
 	mCallback = callback;
+	mPort = port;
 
 	mHttpResponse = HttpResponse();
-
+	mHeaderData.clear();
 	mBytesRead = 0;
-	mContentLength = 0;
-
-	mClient->connectConnectEventHandler(&UrlRequest::onConnect, this);
-	mClient->connectErrorEventHandler(&UrlRequest::onError, this);
-	mClient->connectResolveEventHandler(&UrlRequest::onResolve, this);
+	mFraming = ResponseFraming();
+	mError.clear();
+	mHasRetried = false;
+
+	if (mConnectionPool) {
+		if (SocketRef socket = mConnectionPool->acquire(mHost, mPort)) {
+			mIsSocketReused = true;
+			mSocket = socket;
+			write();
+			return;
+		}
+	}
 
-	mClient->connect(mHost, port);
+	connectNewSocket();
 }
 
 void UrlRequest::close() {
@@ -103,147 +106,238 @@ void UrlRequest::close() {
 	//cout << "UrlRequest: closing" << endl;
 
 	try {
-		if (mSession) {
-			mSession->connectCloseEventHandler(nullptr);
-			mSession->connectErrorEventHandler(nullptr);
-			mSession->connectReadEventHandler(nullptr);
-			mSession->connectWriteEventHandler(nullptr);
-			mSession->close();
-			mSession = nullptr;
-		}
-
-		if (mClient) {
-			mClient->connectConnectEventHandler(nullptr);
-			mClient->connectErrorEventHandler(nullptr);
-			mClient->connectResolveEventHandler(nullptr);
-			mClient->getResolver()->cancel();
-			mClient = nullptr;
-		}
+		disconnectSocket(true);
 
 		if (mCallback) {
-			mCallback(shared_from_this());
+			Callback callback = mCallback;
 			mCallback = nullptr;
+			callback(shared_from_this());
 		}
 
-	} catch (Exception e) {
+	} catch (std::exception & e) {
 		cout << "UrlRequest: Error on close: " << e.what() << endl;
 	}
 
 }
 
+void UrlRequest::cancel() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	mCallback = nullptr;
+	disconnectSocket(true);
+}
+
 //==================================================
 // Accessors
 // 
 
 bool UrlRequest::isConnected() {
 	std::lock_guard<std::recursive_mutex> lock(mMutex);
-	return mSession && mSession->getSocket()->is_open();
+	return mSocket && mSocket->is_open();
 }
 
 bool UrlRequest::isCompleted() {
-	if (isConnected()) return false;
 	std::lock_guard<std::recursive_mutex> lock(mMutex);
-	return mBytesRead >= mContentLength;
+	if (mSocket || !mHttpResponse.hasHeader()) return false;
+	return !mFraming.hasContentLength || mBytesRead >= mFraming.contentLength;
 }
 
 bool UrlRequest::wasSuccessful() {
 	if (!isCompleted()) return false;
-	switch (mHttpResponse.getStatusCode()) {
-		case 200:
-		case 201:
-			return true;
-		default:
-			return false;
-	}
+	return isSuccessStatusCode(mHttpResponse.getStatusCode());
 }
 
-ci::BufferRef UrlRequest::getBody() {
-	if (!isCompleted()) return nullptr;
+std::string UrlRequest::getBodyText() {
+	if (!isCompleted()) return "";
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
 	return mHttpResponse.getBody();
 }
 
-std::string UrlRequest::getBodyText() {
-	try {
-		if (auto body = getBody()) {
-			return HttpResponse::bufferToString(body);
-		}
-	} catch (Exception e) {
-		cout << "UrlRequest: Could not get body text: " << e.what() << endl;
-	}
-
-	return "";
+std::string UrlRequest::getError() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	return mError;
 }
 
 //==================================================
 // Callbacks
 // 
 
-void UrlRequest::onConnect(TcpSessionRef session) {
+void UrlRequest::onResolve(SocketRef socket, const asio::error_code & ec, DnsCache::EndpointListRef endpoints) {
 	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (socket != mSocket) return;
 
-	//cout << "UrlRequest: connected" << endl;
+	if (ec) {
+		fail("Could not resolve " + mHost + ": " + ec.message());
+		return;
+	}
+
+	// endpoints are immutable and shared with the cache; the handler keeps them alive while connecting
+	auto self = shared_from_this();
+	asio::async_connect(*socket, endpoints->begin(), endpoints->end(), [this, self, socket, endpoints] (const asio::error_code & ec, DnsCache::EndpointList::const_iterator) {
+		onConnect(socket, ec);
+	});
+}
 
-	mSession = session;
+void UrlRequest::onConnect(SocketRef socket, const asio::error_code & ec) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (socket != mSocket) return;
 
-	mSession->connectCloseEventHandler(&UrlRequest::onClose, this);
-	mSession->connectErrorEventHandler(&UrlRequest::onError, this);
-	mSession->connectReadEventHandler(&UrlRequest::onRead, this);
-	mSession->connectWriteEventHandler(&UrlRequest::onWrite, this);
+	if (ec) {
+		fail("Could not connect to " + mHost + ": " + ec.message());
+		return;
+	}
 
-	mSession->write(mHttpRequest.toBuffer());
+	write();
 }
 
-void UrlRequest::onError(string err, size_t bytesTransferred) {
+void UrlRequest::onWrite(SocketRef socket, const asio::error_code & ec) {
 	std::lock_guard<std::recursive_mutex> lock(mMutex);
-	//cout << "UrlRequest: error : '" << err << "'" << endl;
-	close();
-}
+	if (socket != mSocket) return;
 
-void UrlRequest::onResolve() {
-	//cout << "UrlRequest: resolved" << endl;
-}
+	if (ec) {
+		fail(ec.message());
+		return;
+	}
 
-void UrlRequest::onWrite(size_t bytesTransferred) {
-	//cout << "UrlRequest: writing " << to_string(bytesTransferred) << " bytes to buffer" << endl;
-	mSession->read();
+	read();
 }
 
-void UrlRequest::onRead(ci::BufferRef buffer) {
+void UrlRequest::onRead(SocketRef socket, const asio::error_code & ec, const size_t numBytes) {
 	std::lock_guard<std::recursive_mutex> lock(mMutex);
-	//cout << "UrlRequest: reading from buffer" << endl;
+	if (socket != mSocket) return;
+
+	if (ec) {
+		if (ec == asio::error::eof && mHttpResponse.hasHeader() && !mFraming.hasContentLength) {
+			// body was delimited by closing the connection
+			disconnectSocket(true);
+			close();
+			return;
+		}
+		fail(ec.message());
+		return;
+	}
+
+	const char * data = mReadBuffer.data();
+	size_t numBodyBytes = numBytes;
 
 	if (!mHttpResponse.hasHeader()) {
-		// Parse header
-		mHttpResponse.parseHeader(HttpResponse::bufferToString(buffer));
-		buffer = HttpResponse::removeHeader(buffer);
-
-		// Get content-length
-		for (const KeyValuePair& kvp : mHttpResponse.getHeaders()) {
-			if (kvp.first == "Content-Length") {
-				mContentLength = fromString<size_t>(kvp.second);
-				break;
-			}
+		mHeaderData.append(data, numBytes);
+
+		const size_t bodyOffset = findBodyOffset(mHeaderData);
+		if (bodyOffset == string::npos) {
+			read(); // wait for the rest of the header
+			return;
+		}
+
+		if (!mHttpResponse.parseHeader(mHeaderData.substr(0, bodyOffset))) {
+			mError = "Invalid response";
+			close();
+			return;
 		}
+
+		// Get content-length and whether we can keep using this connection
+		mFraming = getResponseFraming(mHttpResponse);
+
+		data = mHeaderData.data() + bodyOffset;
+		numBodyBytes = mHeaderData.size() - bodyOffset;
 	}
 
-	// Append buffer to body
-	mBytesRead += buffer->getSize();
-	mHttpResponse.append(buffer);
+	// Append to body
+	mBytesRead += numBodyBytes;
+	mHttpResponse.appendBody(data, numBodyBytes);
+	mHeaderData.clear();
+
+	const bool isBodyIncomplete = mFraming.hasContentLength ? mBytesRead < mFraming.contentLength : !mFraming.isChunked;
 
-	if (mBytesRead < mContentLength) {
-		// Keep reading until we hit the content length
-		mSession->read();
+	if (isBodyIncomplete) {
+		// Keep reading until we hit the content length or the connection is closed
+		read();
 
 	} else {
-		// Close session when done
-		close();
+		// Return connection to pool or close it when done
+		complete();
 	}
 }
 
-void UrlRequest::onClose() {
-	std::lock_guard<std::recursive_mutex> lock(mMutex);
-	//cout << "UrlRequest: closed" << endl;
-	mSession = nullptr;
+//==================================================
+// Connection Management
+// 
+
+void UrlRequest::write() {
+	auto self = shared_from_this();
+	SocketRef socket = mSocket;
+
+	asio::async_write(*socket, mRequestData.getBuffers(), [this, self, socket] (const asio::error_code & ec, size_t) {
+		onWrite(socket, ec);
+	});
+}
+
+void UrlRequest::read() {
+	auto self = shared_from_this();
+	SocketRef socket = mSocket;
+
+	socket->async_read_some(asio::buffer(mReadBuffer), [this, self, socket] (const asio::error_code & ec, size_t numBytes) {
+		onRead(socket, ec, numBytes);
+	});
+}
+
+void UrlRequest::connectNewSocket() {
+	mIsSocketReused = false;
+
+	if (mConnectionPool) {
+		mConnectionPool->addNewConnection();
+	}
+
+	auto self = shared_from_this();
+	SocketRef socket = make_shared<asio::ip::tcp::socket>(mIo);
+	mSocket = socket;
+
+	mDnsCache->resolve(mIo, mHost, mPort, [this, self, socket] (const asio::error_code & ec, DnsCache::EndpointListRef endpoints) {
+		onResolve(socket, ec, endpoints);
+	});
+}
+
+void UrlRequest::disconnectSocket(bool closeSocket) {
+	if (mSocket) {
+		if (closeSocket) {
+			asio::error_code ec;
+			mSocket->close(ec);
+		}
+		mSocket = nullptr;
+	}
+}
+
+bool UrlRequest::retryWithNewSocket() {
+	// Servers may close idle connections at any point, so a pooled connection can fail on first use.
+	// Only retry if nothing was received yet; otherwise we can't know if the server processed the request.
+	if (!mIsSocketReused || mHasRetried || mHttpResponse.hasHeader() || !mHeaderData.empty()) {
+		return false;
+	}
+
+	mHasRetried = true;
+	disconnectSocket(true);
+	connectNewSocket();
+	return true;
+}
+
+void UrlRequest::fail(const std::string & error) {
+	if (retryWithNewSocket()) {
+		return;
+	}
+	mError = error;
+	close();
+}
+
+void UrlRequest::complete() {
+	// Only reuse connections if we know that the full response has been consumed
+	const bool canReuse = mConnectionPool && mSocket && mFraming.isKeepAlive && mFraming.hasContentLength && mBytesRead == mFraming.contentLength;
+
+	if (canReuse) {
+		SocketRef socket = mSocket;
+		disconnectSocket(false);
+		mConnectionPool->release(mHost, mPort, socket);
+	}
+
+	close();
 }
 
 //==================================================
@@ -261,6 +355,110 @@ std::string UrlRequest::methodToString(Method method) {
 	return "";
 }
 
+HttpRequestHeaderRef UrlRequest::createRequestHeader(const std::string & host, const std::string & uri, const Options & options, const bool keepAlive) {
+	return make_shared<HttpRequestHeader>(methodToString(options.method), host, uri, options.headers, keepAlive);
+}
+
+UrlRequest::RequestData UrlRequest::createRequestData(const std::string & host, const std::string & uri, Options options, const bool keepAlive) {
+	RequestData data;
+	data.header = options.header ? options.header : createRequestHeader(host, uri, options, keepAlive);
+
+	if (options.sharedBody) {
+		data.body = options.sharedBody;
+	} else if (!options.body.empty()) {
+		data.body = make_shared<const string>(std::move(options.body));
+	}
+
+	const size_t bodySize = data.body ? data.body->size() : 0;
+	char * headerEnd = data.headerEnd.data();
+
+	// automatically set content length; methods with a body always need one so the server knows where the request ends
+	if (!data.header->hasContentLength() && (bodySize > 0 || options.method == POST || options.method == PUT || options.method == PATCH)) {
+		static const string contentLengthKey = "Content-Length: ";
+		const string contentLength = to_string(bodySize); // short enough to not allocate
+		headerEnd = copy(contentLengthKey.begin(), contentLengthKey.end(), headerEnd);
+		headerEnd = copy(contentLength.begin(), contentLength.end(), headerEnd);
+		*headerEnd++ = '\r';
+		*headerEnd++ = '\n';
+	}
+
+	*headerEnd++ = '\r';
+	*headerEnd++ = '\n';
+	data.headerEndSize = headerEnd - data.headerEnd.data();
+
+	return data;
+}
+
+std::array<asio::const_buffer, 3> UrlRequest::RequestData::getBuffers() const {
+	std::array<asio::const_buffer, 3> buffers = {{
+		asio::const_buffer(header->getData().data(), header->getData().size()),
+		asio::const_buffer(headerEnd.data(), headerEndSize),
+		body ? asio::const_buffer(body->data(), body->size()) : asio::const_buffer()
+	}};
+	return buffers;
+}
+
+std::string UrlRequest::RequestData::toString() const {
+	string data = header ? header->getData() : "";
+	data.append(headerEnd.data(), headerEndSize);
+	if (body) {
+		data += *body;
+	}
+	return data;
+}
+
+UrlRequest::ResponseFraming UrlRequest::getResponseFraming(const HttpResponse & response) {
+	ResponseFraming framing;
+
+	// HTTP/1.1 connections are persistent unless the server says otherwise
+	framing.isKeepAlive = response.getHttpVersion() == "HTTP/1.1";
+
+	for (const HttpHeader & header : response.getHeaders()) {
+		if (httpHeaderNameEquals(header.first, "Content-Length")) {
+			framing.contentLength = (size_t)strtoull(header.second.c_str(), nullptr, 10);
+			framing.hasContentLength = true;
+
+		} else if (httpHeaderNameEquals(header.first, "Connection")) {
+			framing.isKeepAlive = boost::iequals(header.second, "keep-alive");
+
+		} else if (httpHeaderNameEquals(header.first, "Transfer-Encoding")) {
+			// we can't tell where a chunked body ends, so the connection can't be reused
+			framing.isChunked = true;
+		}
+	}
+
+	if (framing.isChunked) {
+		framing.isKeepAlive = false;
+		framing.hasContentLength = false;
+	}
+
+	// these never have a body (RFC 7230 section 3.3.3)
+	const int statusCode = response.getStatusCode();
+	if ((statusCode >= 100 && statusCode < 200) || statusCode == 204 || statusCode == 304) {
+		framing.contentLength = 0;
+		framing.hasContentLength = true;
+		framing.isChunked = false;
+	}
+
+	return framing;
+}
+
+bool UrlRequest::isSuccessStatusCode(const int statusCode) {
+	switch (statusCode) {
+		case 200:
+		case 201:
+			return true;
+		default:
+			return false;
+	}
+}
+
+size_t UrlRequest::findBodyOffset(const std::string & data, const size_t offset) {
+	static const string headerDelimiter = "\r\n\r\n";
+	const size_t headerEnd = data.find(headerDelimiter, offset);
+	return headerEnd == string::npos ? string::npos : headerEnd + headerDelimiter.size();
+}
+
 } // utils namespace
 } // analytics namespace
 } // bluecadet namespace
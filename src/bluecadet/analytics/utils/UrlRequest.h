@@ -31,16 +31,17 @@
  */
 
 #pragma once
-#include "cinder/app/App.h"
-#include "cinder/app/RendererGl.h"
-#include "cinder/gl/gl.h"
-#include "cinder/Utilities.h"
-#include "cinder/Json.h"
 
-#include "CinderAsio.h"
-#include "TcpClient.h"
-#include "bantherewind/protocol/HttpRequest.h"
-#include "bantherewind/protocol/HttpResponse.h"
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "ConnectionPool.h"
+#include "DnsCache.h"
+#include "HttpMessage.h"
+#include "Platform.h"
 
 namespace bluecadet {
 namespace analytics {
@@ -48,6 +49,11 @@ namespace utils {
 
 typedef std::shared_ptr<class UrlRequest> UrlRequestRef;
 
+/*!
+ Sends a single HTTP/1.1 request and reads its response on an asio io_service.
+
+ Completion handlers and the callback passed to connect() run on whichever thread runs the io_service.
+ */
 class UrlRequest : public std::enable_shared_from_this<UrlRequest> {
 
 public:
@@ -60,69 +66,133 @@ public:
 
 	struct Options {
 		Method			method = GET;		//! HTTP method
-		ci::BufferRef	body = nullptr;		//! Optional body to send with the request; Automatically sets CONTENT-LENGTH header.
-		HeaderMap		headers;			//! Overrides all default header values
-		HttpVersion		version = HttpVersion::HTTP_1_1;
+		std::string		body;				//! Optional body to send with the request; Automatically sets CONTENT-LENGTH header.
+		std::shared_ptr<const std::string>	sharedBody = nullptr;	//! Sent instead of body without being copied, e.g. a payload owned by another object. Must not change until the request completes.
+		HttpHeaderList	headers;			//! Overrides all default header values
+		HttpRequestHeaderRef	header = nullptr;	//! Optional request line and headers from createRequestHeader() to reuse instead of rendering them from method and headers.
+		ConnectionPoolRef	connectionPool = nullptr;	//! Optional pool to reuse persistent connections from. Connections are returned to the pool after a complete response instead of being closed.
+		DnsCacheRef		dnsCache = nullptr;	//! Cache for host lookups. Defaults to DnsCache::getInstance().
 
 		//! Convenience method to set body from string
-		void setBodyText(const std::string & bodyStr) { body = HttpRequest::stringToBuffer(bodyStr); }
+		void setBodyText(const std::string & bodyStr) { body = bodyStr; }
+		void setBodyText(std::string && bodyStr) { body = std::move(bodyStr); }
+	};
+
+	//! A serialized request. The shared header, the end of the header and the body are written to the socket
+	//! as a list of buffers, so neither the header nor the body is copied once it has been rendered.
+	struct RequestData {
+		HttpRequestHeaderRef	header;
+		std::array<char, 48>	headerEnd;			//! Content-Length line (if any) and the empty line that ends the header
+		size_t					headerEndSize = 0;
+		std::shared_ptr<const std::string>	body;	//! nullptr if there's no body
+
+		std::array<asio::const_buffer, 3>	getBuffers() const;
+		//! Copies all buffers into a single string, e.g. for logging.
+		std::string				toString() const;
+	};
+
+	//! Describes how the body of a response is delimited and whether its connection can be reused.
+	struct ResponseFraming {
+		size_t		contentLength = 0;
+		bool		hasContentLength = false;	//! False if the body length is unknown (e.g. chunked encoding)
+		bool		isChunked = false;			//! Chunked bodies aren't decoded; the response completes with the first chunk that's received
+		bool		isKeepAlive = false;		//! False if the server will close the connection after this response
 	};
 
 public:
 	//==================================================
 	// Public
 	// 
-	static UrlRequestRef create(const std::string & host, const std::string & uri = "/", Options options = Options()) {
-		return UrlRequestRef(new UrlRequest(host, uri, options));
+	// Overloads instead of 'Options options = Options()' since GCC can't use Options' default member initializers before the end of this class
+	static UrlRequestRef create(asio::io_service & io, const std::string & host, const std::string & uri = "/") {
+		return create(io, host, uri, Options());
+	}
+	static UrlRequestRef create(asio::io_service & io, const std::string & host, const std::string & uri, Options options) {
+		return UrlRequestRef(new UrlRequest(io, host, uri, std::move(options)));
 	}
 
-	UrlRequest(const std::string & host, const std::string & uri = "/", Options options = Options());
+	UrlRequest(asio::io_service & io, const std::string & host, const std::string & uri = "/");
+	UrlRequest(asio::io_service & io, const std::string & host, const std::string & uri, Options options);
 	~UrlRequest();
 
 	void						connect(Callback callback = nullptr, int port = 80);
 	void						close();
+	//! Closes the connection without calling the callback, e.g. when its owner is going away.
+	void						cancel();
 
 	bool						isConnected();
 	bool						isCompleted();
 	bool						wasSuccessful();
 
-	ci::BufferRef				getBody();
 	std::string					getBodyText();
 
-	const HttpRequest&			getHttpRequest() { return mHttpRequest; };
-	const HttpResponse&			getHttpResponse() { return mHttpResponse; };
+	//! The serialized request, including request line and headers.
+	const RequestData &			getRequestData() { return mRequestData; };
+	const HttpResponse &		getHttpResponse() { return mHttpResponse; };
+
+	//! Description of the network error that ended the request, if any.
+	std::string					getError();
+
+	//! Renders the request line and headers for uri and options, including default headers, e.g. to share them between requests via Options::header.
+	static HttpRequestHeaderRef	createRequestHeader(const std::string & host, const std::string & uri, const Options & options, const bool keepAlive);
+	//! Serializes the request sent for uri and options. Renders a new header unless options.header is set and takes over options.body.
+	static RequestData			createRequestData(const std::string & host, const std::string & uri, Options options, const bool keepAlive);
+	static ResponseFraming		getResponseFraming(const HttpResponse & response);
+	static bool					isSuccessStatusCode(const int statusCode);
+
+	//! Finds the end of the header in data, starting at offset. Returns the offset of the body or std::string::npos if the header is incomplete.
+	static size_t				findBodyOffset(const std::string & data, const size_t offset = 0);
 
 private:
 	//==================================================
 	// Private
 	// 
 
+	asio::io_service &			mIo;
 	std::recursive_mutex		mMutex;
 	Callback					mCallback;
 
-	TcpClientRef				mClient;
-	TcpSessionRef				mSession;
+	SocketRef					mSocket;
 	std::string					mHost;
-
-	size_t						mBytesRead;
-	size_t						mContentLength;
-	HttpRequest					mHttpRequest;
+	int							mPort;
+
+	ConnectionPoolRef			mConnectionPool;
+	DnsCacheRef					mDnsCache;
+	bool						mIsSocketReused;	// true if mSocket was acquired from mConnectionPool
+	bool						mHasRetried;		// true if a failed reused connection has been replaced with a new one
+
+	RequestData					mRequestData;
+	std::array<char, 4096>		mReadBuffer;
+	std::string					mHeaderData;		// response bytes received before the end of the header
+	size_t						mBytesRead;			// body bytes received
+	ResponseFraming				mFraming;
 	HttpResponse				mHttpResponse;
+	std::string					mError;
 
 	//==================================================
 	// Callbacks
+	// All ignore results for sockets other than the current one, e.g. after close()
+	// 
+	void						onResolve(SocketRef socket, const asio::error_code & ec, DnsCache::EndpointListRef endpoints);
+	void						onConnect(SocketRef socket, const asio::error_code & ec);
+	void						onWrite(SocketRef socket, const asio::error_code & ec);
+	void						onRead(SocketRef socket, const asio::error_code & ec, const size_t numBytes);
+
+	//==================================================
+	// Connection Management
 	// 
-	void						onClose();
-	void						onConnect(TcpSessionRef session);
-	void						onError(std::string err, size_t bytesTransferred);
-	void						onRead(ci::BufferRef buffer);
-	void						onResolve();
-	void						onWrite(size_t bytesTransferred);
+	void						write();
+	void						read();
+	void						connectNewSocket();
+	void						disconnectSocket(bool closeSocket);
+	bool						retryWithNewSocket(); // returns true if a failed reused connection was replaced
+	void						fail(const std::string & error);
+	void						complete();
 
 	//==================================================
 	// Helpers
 	// 
-	std::string					methodToString(Method method);
+	static std::string			methodToString(Method method);
 };
 
 } // utils namespace
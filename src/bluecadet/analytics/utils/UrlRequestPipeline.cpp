@@ -0,0 +1,382 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "UrlRequestPipeline.h"
+
+#include <iostream>
+
+using namespace std;
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+UrlRequestPipeline::UrlRequestPipeline(asio::io_service & io, const std::string & host, ConnectionPoolRef connectionPool, DnsCacheRef dnsCache) :
+	mIo(io),
+	mCallback(nullptr),
+	mHost(host),
+	mPort(80),
+	mConnectionPool(connectionPool),
+	mDnsCache(dnsCache ? dnsCache : DnsCache::getInstance()),
+	mIsSocketReused(false),
+	mHasRetried(false),
+	mIsKeepAlive(true)
+{
+}
+
+UrlRequestPipeline::~UrlRequestPipeline() {
+	mCallback = nullptr; // can't refer to `this` anymore
+	close();
+}
+
+void UrlRequestPipeline::addRequest(const std::string & uri, UrlRequest::Options options) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+	if (mSocket) {
+		cout << "UrlRequestPipeline: Warning: Can't add requests after connecting; Ignoring" << endl;
+		return;
+	}
+
+	// every request needs to keep the connection alive for the next one
+	mRequestData.push_back(UrlRequest::createRequestData(mHost, uri, std::move(options), true));
+}
+
+void UrlRequestPipeline::connect(Callback callback, int port) {
+	if (isConnected()) {
+		cout << "UrlRequestPipeline: Warning: Session already open; Aborting" << endl;
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+	mCallback = callback;
+	mPort = port;
+
+	mHttpResponses.clear();
+	mHttpResponses.reserve(mRequestData.size());
+	mReceivedData.clear();
+	mCurrentResponse = HttpResponse();
+	mCurrentFraming = UrlRequest::ResponseFraming();
+	mIsKeepAlive = true;
+	mHasRetried = false;
+	mError.clear();
+
+	if (mRequestData.empty()) {
+		close();
+		return;
+	}
+
+	if (mConnectionPool) {
+		if (SocketRef socket = mConnectionPool->acquire(mHost, mPort)) {
+			mIsSocketReused = true;
+			mSocket = socket;
+			write();
+			return;
+		}
+	}
+
+	connectNewSocket();
+}
+
+void UrlRequestPipeline::close() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+	try {
+		disconnectSocket(true);
+
+		if (mCallback) {
+			Callback callback = mCallback;
+			mCallback = nullptr;
+			callback(shared_from_this());
+		}
+
+	} catch (std::exception & e) {
+		cout << "UrlRequestPipeline: Error on close: " << e.what() << endl;
+	}
+}
+
+void UrlRequestPipeline::cancel() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	mCallback = nullptr;
+	disconnectSocket(true);
+}
+
+//==================================================
+// Accessors
+// 
+
+bool UrlRequestPipeline::isConnected() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	return mSocket && mSocket->is_open();
+}
+
+bool UrlRequestPipeline::isCompleted() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	return !mSocket;
+}
+
+size_t UrlRequestPipeline::getNumRequests() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	return mRequestData.size();
+}
+
+size_t UrlRequestPipeline::getNumResponses() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	return mHttpResponses.size();
+}
+
+bool UrlRequestPipeline::wasSuccessful(const size_t index) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (index >= mHttpResponses.size()) return false;
+	return UrlRequest::isSuccessStatusCode(mHttpResponses[index].getStatusCode());
+}
+
+const HttpResponse & UrlRequestPipeline::getHttpResponse(const size_t index) {
+	static const HttpResponse emptyResponse;
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (index >= mHttpResponses.size()) return emptyResponse;
+	return mHttpResponses[index];
+}
+
+std::string UrlRequestPipeline::getError() {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	return mError;
+}
+
+//==================================================
+// Callbacks
+// 
+
+void UrlRequestPipeline::onResolve(SocketRef socket, const asio::error_code & ec, DnsCache::EndpointListRef endpoints) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (socket != mSocket) return;
+
+	if (ec) {
+		fail("Could not resolve " + mHost + ": " + ec.message());
+		return;
+	}
+
+	// endpoints are immutable and shared with the cache; the handler keeps them alive while connecting
+	auto self = shared_from_this();
+	asio::async_connect(*socket, endpoints->begin(), endpoints->end(), [this, self, socket, endpoints] (const asio::error_code & ec, DnsCache::EndpointList::const_iterator) {
+		onConnect(socket, ec);
+	});
+}
+
+void UrlRequestPipeline::onConnect(SocketRef socket, const asio::error_code & ec) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (socket != mSocket) return;
+
+	if (ec) {
+		fail("Could not connect to " + mHost + ": " + ec.message());
+		return;
+	}
+
+	write();
+}
+
+void UrlRequestPipeline::onWrite(SocketRef socket, const asio::error_code & ec) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (socket != mSocket) return;
+
+	if (ec) {
+		fail(ec.message());
+		return;
+	}
+
+	read();
+}
+
+void UrlRequestPipeline::onRead(SocketRef socket, const asio::error_code & ec, const size_t numBytes) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (socket != mSocket) return;
+
+	if (ec) {
+		fail(ec.message());
+		return;
+	}
+
+	mReceivedData.append(mReadBuffer.data(), numBytes);
+
+	if (!parseResponses()) {
+		// can't tell where the next response starts, so the remaining requests are unanswered
+		close();
+		return;
+	}
+
+	if (mHttpResponses.size() >= mRequestData.size()) {
+		complete();
+
+	} else if (!mIsKeepAlive) {
+		// server is closing the connection; remaining requests won't be answered
+		close();
+
+	} else {
+		read();
+	}
+}
+
+//==================================================
+// Connection Management
+// 
+
+void UrlRequestPipeline::write() {
+	auto self = shared_from_this();
+	SocketRef socket = mSocket;
+
+	// write all requests in one go so they leave in as few packets as possible
+	vector<asio::const_buffer> buffers;
+	buffers.reserve(mRequestData.size() * 3);
+
+	for (const auto & requestData : mRequestData) {
+		for (const asio::const_buffer & buffer : requestData.getBuffers()) {
+			buffers.push_back(buffer);
+		}
+	}
+
+	asio::async_write(*socket, buffers, [this, self, socket] (const asio::error_code & ec, size_t) {
+		onWrite(socket, ec);
+	});
+}
+
+void UrlRequestPipeline::read() {
+	auto self = shared_from_this();
+	SocketRef socket = mSocket;
+
+	socket->async_read_some(asio::buffer(mReadBuffer), [this, self, socket] (const asio::error_code & ec, size_t numBytes) {
+		onRead(socket, ec, numBytes);
+	});
+}
+
+void UrlRequestPipeline::connectNewSocket() {
+	mIsSocketReused = false;
+
+	if (mConnectionPool) {
+		mConnectionPool->addNewConnection();
+	}
+
+	auto self = shared_from_this();
+	SocketRef socket = make_shared<asio::ip::tcp::socket>(mIo);
+	mSocket = socket;
+
+	mDnsCache->resolve(mIo, mHost, mPort, [this, self, socket] (const asio::error_code & ec, DnsCache::EndpointListRef endpoints) {
+		onResolve(socket, ec, endpoints);
+	});
+}
+
+void UrlRequestPipeline::disconnectSocket(bool closeSocket) {
+	if (mSocket) {
+		if (closeSocket) {
+			asio::error_code ec;
+			mSocket->close(ec);
+		}
+		mSocket = nullptr;
+	}
+}
+
+bool UrlRequestPipeline::retryWithNewSocket() {
+	// pooled connections may have been closed by the server while idle; retry once if nothing was received yet
+	if (!mIsSocketReused || mHasRetried || !mHttpResponses.empty() || !mReceivedData.empty() || mCurrentResponse.hasHeader()) {
+		return false;
+	}
+
+	mHasRetried = true;
+	disconnectSocket(true);
+	connectNewSocket();
+	return true;
+}
+
+void UrlRequestPipeline::fail(const std::string & error) {
+	if (retryWithNewSocket()) {
+		return;
+	}
+	mError = error;
+	close();
+}
+
+void UrlRequestPipeline::complete() {
+	const bool canReuse = mConnectionPool && mSocket && mIsKeepAlive && mReceivedData.empty();
+
+	if (canReuse) {
+		SocketRef socket = mSocket;
+		disconnectSocket(false);
+		mConnectionPool->release(mHost, mPort, socket);
+	}
+
+	close();
+}
+
+bool UrlRequestPipeline::parseResponses() {
+	size_t offset = 0;
+
+	while (mHttpResponses.size() < mRequestData.size()) {
+		if (!mCurrentResponse.hasHeader()) {
+			const size_t bodyOffset = UrlRequest::findBodyOffset(mReceivedData, offset);
+			if (bodyOffset == string::npos) {
+				break; // wait for the rest of the header
+			}
+
+			if (!mCurrentResponse.parseHeader(mReceivedData.substr(offset, bodyOffset - offset))) {
+				cout << "UrlRequestPipeline: Could not parse response" << endl;
+				return false;
+			}
+
+			mCurrentFraming = UrlRequest::getResponseFraming(mCurrentResponse);
+			offset = bodyOffset;
+
+			if (!mCurrentFraming.hasContentLength) {
+				return false;
+			}
+		}
+
+		if (mReceivedData.size() - offset < mCurrentFraming.contentLength) {
+			break; // wait for the rest of the body
+		}
+
+		mCurrentResponse.appendBody(&mReceivedData[offset], mCurrentFraming.contentLength);
+		offset += mCurrentFraming.contentLength;
+
+		mHttpResponses.push_back(mCurrentResponse);
+		mCurrentResponse = HttpResponse();
+
+		if (!mCurrentFraming.isKeepAlive) {
+			mIsKeepAlive = false;
+			break;
+		}
+	}
+
+	mReceivedData.erase(0, offset);
+	return true;
+}
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
@@ -0,0 +1,142 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <vector>
+
+#include "UrlRequest.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace utils {
+
+typedef std::shared_ptr<class UrlRequestPipeline> UrlRequestPipelineRef;
+
+/*!
+ Sends multiple HTTP/1.1 requests to the same host back-to-back on one persistent connection
+ and matches the responses to the requests in order.
+
+ All requests are written at once right after connecting, so the whole pipeline completes in
+ roughly one round trip instead of one round trip per request. If the connection fails or the
+ server closes it before all responses have been received, the pipeline completes early and
+ getNumResponses() indicates which requests were answered; requests at indices >= getNumResponses()
+ may or may not have been processed by the server.
+
+ Responses must be delimited with a Content-Length header. A response without one ends the pipeline.
+ */
+class UrlRequestPipeline : public std::enable_shared_from_this<UrlRequestPipeline> {
+
+public:
+	typedef std::function<void(UrlRequestPipelineRef pipeline)> Callback;
+
+	//! Host lookups go through dnsCache or DnsCache::getInstance() if it's nullptr.
+	static UrlRequestPipelineRef create(asio::io_service & io, const std::string & host, ConnectionPoolRef connectionPool = nullptr, DnsCacheRef dnsCache = nullptr) {
+		return UrlRequestPipelineRef(new UrlRequestPipeline(io, host, connectionPool, dnsCache));
+	}
+
+	UrlRequestPipeline(asio::io_service & io, const std::string & host, ConnectionPoolRef connectionPool = nullptr, DnsCacheRef dnsCache = nullptr);
+	~UrlRequestPipeline();
+
+	//! Appends a request to the pipeline. Has no effect once connected.
+	void						addRequest(const std::string & uri, UrlRequest::Options options = UrlRequest::Options());
+
+	void						connect(Callback callback = nullptr, int port = 80);
+	void						close();
+	//! Closes the connection without calling the callback, e.g. when its owner is going away.
+	void						cancel();
+
+	bool						isConnected();
+	bool						isCompleted();
+
+	size_t						getNumRequests();
+	//! Number of requests that have received a response so far. Responses arrive in request order.
+	size_t						getNumResponses();
+
+	//! True if the request at index received a successful response.
+	bool						wasSuccessful(const size_t index);
+	const HttpResponse&			getHttpResponse(const size_t index);
+
+	//! Description of the network error that ended the pipeline early, if any.
+	std::string					getError();
+
+private:
+	asio::io_service &			mIo;
+	std::recursive_mutex		mMutex;
+	Callback					mCallback;
+
+	SocketRef					mSocket;
+	std::string					mHost;
+	int							mPort;
+
+	ConnectionPoolRef			mConnectionPool;
+	DnsCacheRef					mDnsCache;
+	bool						mIsSocketReused;
+	bool						mHasRetried;
+
+	std::vector<UrlRequest::RequestData>	mRequestData;	// serialized requests
+	std::vector<HttpResponse>	mHttpResponses;
+	std::string					mError;
+
+	// Parser state for the response currently being read
+	std::array<char, 4096>		mReadBuffer;
+	std::string					mReceivedData;		// unparsed bytes received so far
+	HttpResponse				mCurrentResponse;
+	UrlRequest::ResponseFraming	mCurrentFraming;
+	bool						mIsKeepAlive;		// false once a response asked to close the connection
+
+	//==================================================
+	// Callbacks
+	// All ignore results for sockets other than the current one, e.g. after close()
+	// 
+	void						onResolve(SocketRef socket, const asio::error_code & ec, DnsCache::EndpointListRef endpoints);
+	void						onConnect(SocketRef socket, const asio::error_code & ec);
+	void						onWrite(SocketRef socket, const asio::error_code & ec);
+	void						onRead(SocketRef socket, const asio::error_code & ec, const size_t numBytes);
+
+	//==================================================
+	// Connection Management
+	// 
+	void						write();
+	void						read();
+	void						connectNewSocket();
+	void						disconnectSocket(bool closeSocket);
+	bool						retryWithNewSocket();
+	void						fail(const std::string & error);
+	void						complete();
+
+	//! Parses as many complete responses from mReadBuffer as possible. Returns false if the stream can't be parsed.
+	bool						parseResponses();
+};
+
+} // utils namespace
+} // analytics namespace
+} // bluecadet namespace
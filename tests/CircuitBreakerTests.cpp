@@ -0,0 +1,185 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/utils/CircuitBreaker.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+typedef utils::CircuitBreaker CB;
+
+//! Opens a circuit breaker with a threshold of 2 and fixed probe intervals starting at 1s.
+CB::State openCircuit(CB & breaker, const double time) {
+	breaker.setFailureThreshold(2);
+	breaker.setMinProbeInterval(1.0);
+	breaker.setMaxProbeInterval(8.0);
+	breaker.recordFailure(time);
+	return breaker.recordFailure(time);
+}
+
+void testClosedToOpen() {
+	CB breaker;
+	breaker.setFailureThreshold(3);
+
+	TEST_CHECK(breaker.requestPermission(0.0) == CB::ALLOW_ALL);
+	TEST_CHECK(breaker.recordFailure(0.0) == CB::CLOSED);
+	TEST_CHECK(breaker.recordFailure(0.0) == CB::CLOSED);
+	TEST_CHECK(breaker.isClosed());
+
+	// a success in between starts counting from scratch
+	breaker.recordSuccess();
+	TEST_CHECK(breaker.getNumConsecutiveFailures() == 0);
+	breaker.recordFailure(0.0);
+	breaker.recordFailure(0.0);
+	TEST_CHECK(breaker.isClosed());
+
+	TEST_CHECK(breaker.recordFailure(0.0) == CB::CLOSED);
+	TEST_CHECK(breaker.getState() == CB::OPEN);
+	TEST_CHECK(breaker.requestPermission(0.0) == CB::DENY);
+
+	// jittered between 50% and 100% of the min interval
+	TEST_CHECK(breaker.getTimeOfNextProbe() >= 0.5 && breaker.getTimeOfNextProbe() <= 1.0);
+}
+
+void testDisabled() {
+	CB breaker;
+	breaker.setFailureThreshold(0);
+
+	for (int i = 0; i < 100; ++i) {
+		breaker.recordFailure(0.0);
+	}
+	TEST_CHECK(breaker.isClosed());
+	TEST_CHECK(breaker.requestPermission(0.0) == CB::ALLOW_ALL);
+}
+
+void testOpenToHalfOpen() {
+	CB breaker;
+	openCircuit(breaker, 0.0);
+	const double timeOfProbe = breaker.getTimeOfNextProbe();
+
+	uint64_t probeId = 0;
+	TEST_CHECK(breaker.requestPermission(timeOfProbe - 0.01, &probeId) == CB::DENY);
+	TEST_CHECK(probeId == 0);
+
+	TEST_CHECK(breaker.requestPermission(timeOfProbe, &probeId) == CB::ALLOW_PROBE);
+	TEST_CHECK(probeId != 0);
+	TEST_CHECK(breaker.getState() == CB::HALF_OPEN);
+
+	// only one probe at a time
+	TEST_CHECK(breaker.requestPermission(timeOfProbe + 100.0) == CB::DENY);
+}
+
+void testHalfOpenToClosed() {
+	CB breaker;
+	openCircuit(breaker, 0.0);
+	breaker.requestPermission(breaker.getTimeOfNextProbe());
+
+	TEST_CHECK(breaker.recordSuccess() == CB::HALF_OPEN);
+	TEST_CHECK(breaker.isClosed());
+	TEST_CHECK(breaker.getNumConsecutiveFailures() == 0);
+	TEST_CHECK(breaker.requestPermission(0.0) == CB::ALLOW_ALL);
+
+	// the backoff starts over after the next outage
+	openCircuit(breaker, 10.0);
+	TEST_CHECK(breaker.getTimeOfNextProbe() <= 11.0);
+}
+
+void testHalfOpenToOpen() {
+	CB breaker;
+	openCircuit(breaker, 0.0);
+
+	uint64_t probeId = 0;
+	double time = breaker.getTimeOfNextProbe();
+	breaker.requestPermission(time, &probeId);
+
+	// probe intervals double with every failed probe up to the max interval
+	const double maxIntervals[] = {2.0, 4.0, 8.0, 8.0};
+	for (const double maxInterval : maxIntervals) {
+		TEST_CHECK(breaker.recordFailure(time, probeId) == CB::HALF_OPEN);
+		TEST_CHECK(breaker.getState() == CB::OPEN);
+
+		const double interval = breaker.getTimeOfNextProbe() - time;
+		TEST_CHECK(interval >= 0.5 * maxInterval && interval <= maxInterval);
+
+		time = breaker.getTimeOfNextProbe();
+		const uint64_t previousProbeId = probeId;
+		TEST_CHECK(breaker.requestPermission(time, &probeId) == CB::ALLOW_PROBE);
+		TEST_CHECK(probeId != previousProbeId);
+	}
+}
+
+void testStaleFailureWhileHalfOpen() {
+	CB breaker;
+	openCircuit(breaker, 0.0);
+
+	uint64_t probeId = 0;
+	const double time = breaker.getTimeOfNextProbe();
+	breaker.requestPermission(time, &probeId);
+
+	// requests from before the circuit opened don't count as the probe and don't back off further
+	TEST_CHECK(breaker.recordFailure(time) == CB::OPEN);
+	TEST_CHECK(breaker.recordFailure(time, probeId - 1) == CB::OPEN);
+	TEST_CHECK(breaker.getState() == CB::HALF_OPEN);
+
+	// the probe's own failure reopens the circuit with the doubled interval only
+	TEST_CHECK(breaker.recordFailure(time, probeId) == CB::HALF_OPEN);
+	TEST_CHECK(breaker.getState() == CB::OPEN);
+	TEST_CHECK(breaker.getTimeOfNextProbe() - time <= 2.0);
+}
+
+void testReset() {
+	CB breaker;
+	openCircuit(breaker, 0.0);
+	breaker.reset();
+
+	TEST_CHECK(breaker.isClosed());
+	TEST_CHECK(breaker.getNumConsecutiveFailures() == 0);
+	TEST_CHECK(breaker.requestPermission(0.0) == CB::ALLOW_ALL);
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	tests::run("closed to open", testClosedToOpen);
+	tests::run("disabled", testDisabled);
+	tests::run("open to half-open", testOpenToHalfOpen);
+	tests::run("half-open to closed", testHalfOpenToClosed);
+	tests::run("half-open to open", testHalfOpenToOpen);
+	tests::run("stale failure while half-open", testStaleFailureWhileHalfOpen);
+	tests::run("reset", testReset);
+
+	return tests::getExitCode();
+}
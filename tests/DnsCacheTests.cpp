@@ -0,0 +1,158 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/utils/DnsCache.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+const string HOST = "localhost";
+const int PORT = 80;
+
+struct Result {
+	bool isCalled = false;
+	asio::error_code ec;
+	utils::DnsCache::EndpointListRef endpoints;
+};
+
+utils::DnsCache::Callback getCallback(Result & result) {
+	return [&result] (const asio::error_code & ec, utils::DnsCache::EndpointListRef endpoints) {
+		result.isCalled = true;
+		result.ec = ec;
+		result.endpoints = endpoints;
+	};
+}
+
+//! Runs io until result's callback was called or timeout seconds have passed.
+void runUntilCalled(asio::io_service & io, const Result & result, const double timeout = 10.0) {
+	const auto deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(timeout));
+	io.restart();
+	while (!result.isCalled && chrono::steady_clock::now() < deadline) {
+		io.run_one_for(chrono::milliseconds(10));
+	}
+}
+
+//! Runs io for duration seconds.
+void runFor(asio::io_service & io, const double duration) {
+	io.restart();
+	io.run_for(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(duration)));
+}
+
+void testCancelWaitingIoService() {
+	auto cache = make_shared<utils::DnsCache>();
+	asio::io_service lookupIo;
+	unique_ptr<asio::io_service> waitingIo(new asio::io_service());
+	Result lookupResult, waitingResult;
+
+	// the first caller's io_service runs the query; the second one waits for it
+	cache->resolve(lookupIo, HOST, PORT, getCallback(lookupResult));
+	cache->resolve(*waitingIo, HOST, PORT, getCallback(waitingResult));
+
+	cache->cancel(*waitingIo);
+	waitingIo = nullptr;
+
+	runUntilCalled(lookupIo, lookupResult);
+	TEST_CHECK(lookupResult.isCalled && !lookupResult.ec);
+	TEST_CHECK(lookupResult.endpoints && !lookupResult.endpoints->empty());
+	TEST_CHECK(!waitingResult.isCalled);
+
+	cache->cancel(lookupIo);
+}
+
+void testCancelLookupIoService() {
+	auto cache = make_shared<utils::DnsCache>();
+	unique_ptr<asio::io_service> lookupIo(new asio::io_service());
+	asio::io_service waitingIo;
+	Result lookupResult, waitingResult;
+
+	cache->resolve(*lookupIo, HOST, PORT, getCallback(lookupResult));
+	cache->resolve(waitingIo, HOST, PORT, getCallback(waitingResult));
+
+	// the query moves to the io_service that is still waiting for it
+	cache->cancel(*lookupIo);
+	lookupIo = nullptr;
+
+	runUntilCalled(waitingIo, waitingResult);
+	TEST_CHECK(waitingResult.isCalled && !waitingResult.ec);
+	TEST_CHECK(waitingResult.endpoints && !waitingResult.endpoints->empty());
+	TEST_CHECK(!lookupResult.isCalled);
+
+	cache->cancel(waitingIo);
+}
+
+void testBackgroundRefresh() {
+	// refresh timers fire 0.2s after each lookup
+	auto cache = make_shared<utils::DnsCache>(0.6, 0.4);
+	asio::io_service io;
+	Result result;
+
+	cache->resolve(io, HOST, PORT, getCallback(result));
+	runUntilCalled(io, result);
+	TEST_CHECK(result.isCalled && !result.ec);
+
+	// renewed without being used again, so the next use doesn't wait
+	runFor(io, 0.5);
+	TEST_CHECK(cache->getStats().numRefreshes >= 1);
+
+	Result cachedResult;
+	cache->resolve(io, HOST, PORT, getCallback(cachedResult));
+	runUntilCalled(io, cachedResult);
+	TEST_CHECK(cachedResult.isCalled && !cachedResult.ec);
+	TEST_CHECK(cache->getStats().numMisses == 1);
+	TEST_CHECK(cache->getStats().numHits == 1);
+
+	// hosts that aren't used anymore stop being refreshed once their TTL has passed since their last use
+	runFor(io, 1.5);
+	const size_t numRefreshes = cache->getStats().numRefreshes;
+	runFor(io, 0.5);
+	TEST_CHECK(cache->getStats().numRefreshes == numRefreshes);
+
+	cache->cancel(io);
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	tests::run("cancel waiting io_service", testCancelWaitingIoService);
+	tests::run("cancel lookup io_service", testCancelLookupIoService);
+	tests::run("background refresh", testBackgroundRefresh);
+
+	return tests::getExitCode();
+}
@@ -0,0 +1,227 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/AnalyticsClient.h"
+#include "bluecadet/analytics/utils/StandaloneEventLoop.h"
+
+#include "MockCollector.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+const int NUM_HITS = 50;
+const double MAX_BATCH_AGE = 60.0;	// long enough that only flushes send anything
+
+typedef shared_ptr<class LocalClient> LocalClientRef;
+
+//! Sends to a MockCollector on the loopback interface on its own event loop, like OfflineClient
+//! in OverflowPolicyTests but with networking. Nothing is sent before the max batch age unless flushed.
+class LocalClient : public AnalyticsClient {
+public:
+	LocalClient(const int port) :
+		mLoop(make_shared<utils::StandaloneEventLoop>())
+	{
+		setEventLoop(mLoop);
+		setGaBaseUrl("127.0.0.1");
+		setGaPort(port);
+	}
+
+	~LocalClient() {
+		destroy();
+		mLoop->stop();
+	}
+
+	//! Sets up the client. Can't be done in the constructor, since the client needs to be owned by a shared_ptr by then.
+	void start() {
+		setup("01234567-89ab-cdef-0123-456789abcdef", "UA-00000000-1", "Test App", "1.0.0", 1, MAX_BATCH_AGE);
+	}
+
+	//! Tracks events with values 0 to numHits - 1.
+	void trackEvents(const int numHits) {
+		for (int value = 0; value < numHits; ++value) {
+			trackEvent("Test Category", "Tap", "", value);
+		}
+	}
+
+protected:
+	utils::StandaloneEventLoopRef mLoop;
+};
+
+//! Returns a port that refuses connections, as if the network was down.
+int getClosedPort() {
+	auto collector = benchmarks::MockCollector::create();
+	if (!collector->start()) {
+		return 0;
+	}
+	const int port = collector->getPort();
+	collector->stop();
+	return port;
+}
+
+double getSecondsSince(const chrono::steady_clock::time_point & time) {
+	return chrono::duration<double>(chrono::steady_clock::now() - time).count();
+}
+
+void testFlushResolvesWhenDrained() {
+	auto collector = benchmarks::MockCollector::create();
+	if (!TEST_CHECK(collector->start())) {
+		return;
+	}
+
+	auto client = make_shared<LocalClient>(collector->getPort());
+	client->start();
+	client->trackEvents(NUM_HITS);
+
+	const auto startTime = chrono::steady_clock::now();
+	future<AnalyticsClient::FlushResult> flushResult = client->flush(10.0);
+
+	if (!TEST_CHECK(flushResult.wait_for(chrono::seconds(20)) == future_status::ready)) {
+		return;
+	}
+
+	// fulfilled as soon as everything was acknowledged, well before the timeout
+	const AnalyticsClient::FlushResult result = flushResult.get();
+	TEST_CHECK(getSecondsSince(startTime) < 5.0);
+	TEST_CHECK(result.numHitsDelivered == (size_t)NUM_HITS);
+	TEST_CHECK(result.numHitsAbandoned == 0);
+	TEST_CHECK(collector->getNumHits() == (size_t)NUM_HITS);
+	TEST_CHECK(client->getStats().numQueuedHits == 0);
+}
+
+void testFlushTimesOutWhileNetworkIsDown() {
+	const int port = getClosedPort();
+	if (!TEST_CHECK(port != 0)) {
+		return;
+	}
+
+	auto client = make_shared<LocalClient>(port);
+	client->start();
+	client->trackEvents(NUM_HITS);
+
+	const double timeout = 1.0;
+	const auto startTime = chrono::steady_clock::now();
+	future<AnalyticsClient::FlushResult> flushResult = client->flush(timeout);
+
+	if (!TEST_CHECK(flushResult.wait_for(chrono::seconds(20)) == future_status::ready)) {
+		return;
+	}
+
+	// everything is still queued for retries after the flush gave up
+	const AnalyticsClient::FlushResult result = flushResult.get();
+	const double elapsed = getSecondsSince(startTime);
+	TEST_CHECK(elapsed >= timeout * 0.9 && elapsed < timeout + 2.0);
+	TEST_CHECK(result.numHitsDelivered == 0);
+	TEST_CHECK(result.numHitsAbandoned == (size_t)NUM_HITS);
+	TEST_CHECK(client->getStats().numHitsSent == 0);
+}
+
+void testDestroyDrains() {
+	auto collector = benchmarks::MockCollector::create();
+	if (!TEST_CHECK(collector->start())) {
+		return;
+	}
+
+	auto client = make_shared<LocalClient>(collector->getPort());
+	client->start();
+	client->trackEvents(NUM_HITS);
+
+	const AnalyticsClient::FlushResult result = client->destroy(10.0);
+	TEST_CHECK(result.numHitsDelivered == (size_t)NUM_HITS);
+	TEST_CHECK(result.numHitsAbandoned == 0);
+	TEST_CHECK(collector->getNumHits() == (size_t)NUM_HITS);
+}
+
+void testDestroyReturnsWithinBudget() {
+	const int port = getClosedPort();
+	if (!TEST_CHECK(port != 0)) {
+		return;
+	}
+
+	auto client = make_shared<LocalClient>(port);
+	client->start();
+	client->trackEvents(NUM_HITS);
+
+	const double drainTimeout = 1.0;
+	const auto startTime = chrono::steady_clock::now();
+	const AnalyticsClient::FlushResult result = client->destroy(drainTimeout);
+	const double elapsed = getSecondsSince(startTime);
+
+	TEST_CHECK(elapsed >= drainTimeout * 0.9 && elapsed < drainTimeout + 0.5);
+	TEST_CHECK(result.numHitsDelivered == 0);
+	TEST_CHECK(result.numHitsAbandoned == (size_t)NUM_HITS);
+
+	// without a journal, whatever couldn't be delivered is gone
+	TEST_CHECK(client->getStats().numQueuedHits == 0);
+	TEST_CHECK(client->getStats().numHitsDropped == (uint64_t)NUM_HITS);
+}
+
+void testUnsharedClientDoesNotSetUp() {
+	const int port = getClosedPort();
+	if (!TEST_CHECK(port != 0)) {
+		return;
+	}
+
+	// requests need a weak reference to their client, which a client on the stack can't hand out
+	LocalClient client(port);
+	client.start();
+	client.trackEvents(NUM_HITS);
+
+	future<AnalyticsClient::FlushResult> flushResult = client.flush(10.0);
+	TEST_CHECK(flushResult.wait_for(chrono::seconds(0)) == future_status::ready);
+
+	const auto startTime = chrono::steady_clock::now();
+	const AnalyticsClient::FlushResult result = client.destroy(10.0);
+	TEST_CHECK(getSecondsSince(startTime) < 1.0);
+	TEST_CHECK(result.numHitsDelivered == 0);
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	utils::setMinLogLevel(utils::LOG_NONE);
+
+	tests::run("flush() resolves once the queue is drained", testFlushResolvesWhenDrained);
+	tests::run("flush() times out while the network is down", testFlushTimesOutWhileNetworkIsDown);
+	tests::run("destroy(drainTimeout) delivers everything", testDestroyDrains);
+	tests::run("destroy(drainTimeout) returns within its budget", testDestroyReturnsWithinBudget);
+	tests::run("clients that aren't owned by a shared_ptr don't set up", testUnsharedClientDoesNotSetUp);
+
+	return tests::getExitCode();
+}
@@ -0,0 +1,192 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/GABatch.hpp"
+#include "bluecadet/analytics/utils/Clock.hpp"
+#include "bluecadet/analytics/utils/PercentEncoding.hpp"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+double sTime = 1000.0;
+
+double getSimulatedTime() {
+	return sTime;
+}
+
+//! Returns the value of the fixed-width parameter key (e.g. "&qt=") that follows offset in payload or -1 if there is none.
+int64_t readParameter(const string & payload, const string & key, const size_t offset = 0) {
+	const size_t start = payload.find(key, offset);
+	if (start == string::npos) {
+		return -1;
+	}
+	const string digits = payload.substr(start + key.size(), 10);
+	if (digits.size() != 10 || digits.find_first_not_of("0123456789") != string::npos) {
+		return -1;
+	}
+	return strtoll(digits.c_str(), nullptr, 10);
+}
+
+void testHitLimit() {
+	GABatch batch;
+	const GAEncodedHit hit(sTime, "v=1&t=event&ec=Video&ea=Play", true);
+
+	for (size_t i = 0; i < GABatch::MAX_NUM_HITS; ++i) {
+		TEST_CHECK(batch.canAddHit(hit));
+		TEST_CHECK(!batch.isFull());
+		batch.addHit(hit);
+	}
+
+	TEST_CHECK(batch.numHits() == GABatch::MAX_NUM_HITS);
+	TEST_CHECK(batch.isFull());
+	TEST_CHECK(!batch.canAddHit(hit));
+}
+
+void testSizeLimit() {
+	GABatch batch;
+	const GAEncodedHit largeHit(sTime, "v=1&t=event&el=" + string(5300, 'x'), true);
+	const GAEncodedHit smallHit(sTime, "v=1&t=event&ea=Play", false);
+
+	while (batch.canAddHit(largeHit)) {
+		batch.addHit(largeHit);
+	}
+	TEST_CHECK(batch.numHits() == 3);
+
+	while (batch.canAddHit(smallHit)) {
+		batch.addHit(smallHit);
+	}
+	TEST_CHECK(batch.numHits() < GABatch::MAX_NUM_HITS);
+	TEST_CHECK(batch.getPayloadSize() <= GABatch::MAX_BATCH_SIZE);
+	TEST_CHECK(batch.getPayloadSize() + 1 + smallHit.parameters.size() + 4 + 10 > GABatch::MAX_BATCH_SIZE);
+
+	// the exact size is known up front, so patching doesn't change it
+	const size_t payloadSize = batch.getPayloadSize();
+	TEST_CHECK(batch.updatePayload().size() == payloadSize);
+}
+
+void testQueueTimeAndCacheBuster() {
+	GABatch batch;
+	batch.addHit(GAEncodedHit(sTime - 1.5, "v=1&t=event&ec=First", true));
+	batch.addHit(GAEncodedHit(sTime - 0.25, "v=1&t=event&ec=Second", false, 42));
+
+	const string payload = batch.updatePayload();
+	const size_t separator = payload.find('\n');
+
+	if (!TEST_CHECK(separator != string::npos)) {
+		return;
+	}
+
+	// each hit gets its own queue time in ms; only hits that ask for it get a cache buster
+	TEST_CHECK(payload.compare(0, 20, "v=1&t=event&ec=First") == 0);
+	TEST_CHECK(readParameter(payload, "&qt=") == 1500);
+	TEST_CHECK(readParameter(payload, "&z=") >= 0);
+	TEST_CHECK(payload.find("&z=") < separator);
+	TEST_CHECK(payload.compare(separator + 1, 21, "v=1&t=event&ec=Second") == 0);
+	TEST_CHECK(readParameter(payload, "&qt=", separator) == 250);
+	TEST_CHECK(payload.find("&z=", separator) == string::npos);
+
+	// queue time is patched in place on every send attempt
+	sTime += 2.0;
+	const string & retryPayload = batch.updatePayload();
+	TEST_CHECK(retryPayload.size() == payload.size());
+	TEST_CHECK(readParameter(retryPayload, "&qt=") == 3500);
+	TEST_CHECK(readParameter(retryPayload, "&qt=", separator) == 2250);
+
+	// encoded hits can be extracted again without the variable parameters
+	const vector<GAEncodedHit> hits = batch.getEncodedHits();
+	if (TEST_CHECK(hits.size() == 2)) {
+		TEST_CHECK(hits[0].parameters == "v=1&t=event&ec=First");
+		TEST_CHECK(hits[0].cacheBuster);
+		TEST_CHECK(hits[1].parameters == "v=1&t=event&ec=Second");
+		TEST_CHECK(!hits[1].cacheBuster);
+		TEST_CHECK(hits[1].journalId == 42);
+	}
+	TEST_CHECK(batch.getJournalIds() == vector<uint64_t>({ 42 }));
+}
+
+void testTruncation() {
+	const size_t maxParametersSize = GABatch::MAX_HIT_SIZE - 4 - 10 - 3 - 10;
+
+	// hits that fit aren't touched
+	const GAEncodedHit smallHit = GABatch::truncateHit(GAEncodedHit(sTime, "v=1&t=event&ea=Play", true));
+	TEST_CHECK(smallHit.parameters == "v=1&t=event&ea=Play");
+
+	// cuts never end in a partial escape or a partial UTF-8 sequence, whatever the offset
+	const vector<string> chars = { "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+
+	for (const string & c : chars) {
+		const string encodedChar = utils::percentEncode(c);
+		string label;
+		while (label.size() < GABatch::MAX_HIT_SIZE) {
+			label += c;
+		}
+
+		for (size_t prefixSize = 0; prefixSize < encodedChar.size(); ++prefixSize) {
+			const string prefix = "v=1&t=event&el=" + string(prefixSize, 'x');
+			const GAEncodedHit hit = GABatch::truncateHit(GAEncodedHit(sTime, prefix + utils::percentEncode(label), true));
+			const string & parameters = hit.parameters;
+
+			TEST_CHECK(parameters.size() <= maxParametersSize);
+			TEST_CHECK(parameters.size() > maxParametersSize - encodedChar.size());
+			TEST_CHECK(parameters.compare(0, prefix.size(), prefix) == 0);
+			TEST_CHECK((parameters.size() - prefix.size()) % encodedChar.size() == 0);
+			TEST_CHECK(parameters.compare(parameters.size() - encodedChar.size(), encodedChar.size(), encodedChar) == 0);
+		}
+	}
+
+	// hits without cache buster have more room
+	const GAEncodedHit hit = GABatch::truncateHit(GAEncodedHit(sTime, "v=1&t=event&el=" + string(GABatch::MAX_HIT_SIZE, 'x'), false));
+	TEST_CHECK(hit.parameters.size() == GABatch::MAX_HIT_SIZE - 4 - 10);
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	utils::setMinLogLevel(utils::LOG_NONE);
+	utils::setClock(&getSimulatedTime);
+
+	tests::run("hit limit", testHitLimit);
+	tests::run("size limit", testSizeLimit);
+	tests::run("queue time and cache buster", testQueueTimeAndCacheBuster);
+	tests::run("truncation", testTruncation);
+
+	utils::setClock(nullptr);
+	return tests::getExitCode();
+}
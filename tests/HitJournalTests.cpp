@@ -0,0 +1,223 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/AnalyticsClient.h"
+#include "bluecadet/analytics/utils/HitJournal.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+//! Client with a journal but without workers, so tracked hits stay in memory until a test assembles them.
+class JournaledClient : public AnalyticsClient {
+public:
+	JournaledClient() {
+		setAppName("Test App");
+		setGaId("UA-00000000-1");
+		setClientId("01234567-89ab-cdef-0123-456789abcdef");
+	}
+
+	//! Opens a journal without calling setup() (which would start sending).
+	bool enableJournal(const fs::path & directory) {
+		utils::HitJournalRef journal = make_shared<utils::HitJournal>();
+		if (!journal->open(directory)) {
+			return false;
+		}
+		atomic_store(&mJournal, journal);
+		return true;
+	}
+
+	using AnalyticsClient::getJournal;
+};
+
+size_t getNumFiles(const fs::path & directory) {
+	size_t numFiles = 0;
+	for (fs::directory_iterator it(directory), end; it != end; ++it) {
+		++numFiles;
+	}
+	return numFiles;
+}
+
+fs::path getOnlyFile(const fs::path & directory) {
+	fs::directory_iterator it(directory);
+	return it != fs::directory_iterator() ? it->path() : fs::path();
+}
+
+void testRoundTrip() {
+	tests::TempDirectory directory("journal");
+	const vector<string> payloads = {
+		"v=1&t=event&ec=Video&ea=Play",
+		"v=1&t=screenview&cd=Caf%C3%A9%20%E2%80%93%20Main",
+		"v=1&t=event&ec=Gallery&ea=Swipe&el=Room%202"
+	};
+	vector<uint64_t> ids;
+
+	{
+		utils::HitJournal journal;
+		TEST_CHECK(journal.open(directory.getPath()));
+		TEST_CHECK(journal.readPendingRecords().empty());
+
+		for (size_t i = 0; i < payloads.size(); ++i) {
+			ids.push_back(journal.append(1500000000000 + (int64_t)i, payloads[i]));
+		}
+		TEST_CHECK(ids[0] != 0 && ids[0] < ids[1] && ids[1] < ids[2]);
+		TEST_CHECK(journal.getNumPendingHits() == 3);
+
+		journal.acknowledge({ ids[1] });
+		TEST_CHECK(journal.getNumPendingHits() == 2);
+		journal.sync();
+		journal.close();
+	}
+
+	// a new session replays everything that wasn't acknowledged, oldest first
+	utils::HitJournal journal;
+	TEST_CHECK(journal.open(directory.getPath()));
+
+	const vector<utils::HitJournal::Record> records = journal.readPendingRecords();
+	TEST_CHECK(journal.getNumPendingHits() == 2);
+
+	if (TEST_CHECK(records.size() == 2)) {
+		TEST_CHECK(records[0].id == ids[0]);
+		TEST_CHECK(records[0].timestampMs == 1500000000000);
+		TEST_CHECK(records[0].payload == payloads[0]);
+		TEST_CHECK(records[1].id == ids[2]);
+		TEST_CHECK(records[1].timestampMs == 1500000000002);
+		TEST_CHECK(records[1].payload == payloads[2]);
+	}
+
+	// new hits don't reuse ids of replayed ones
+	TEST_CHECK(journal.append(1500000000003, payloads[0]) > ids[2]);
+
+	// replayed hits are acknowledged like any other
+	journal.acknowledge({ ids[0], ids[2] });
+	TEST_CHECK(journal.getNumPendingHits() == 1);
+	journal.close();
+}
+
+void testIncompleteRecordIsSkipped() {
+	tests::TempDirectory directory("journal");
+
+	{
+		utils::HitJournal journal;
+		TEST_CHECK(journal.open(directory.getPath()));
+		journal.append(1500000000000, "v=1&t=event&ec=Complete");
+		journal.close();
+	}
+
+	// simulate a crash in the middle of writing a record
+	const fs::path segmentPath = getOnlyFile(directory.getPath());
+	FILE * file = fopen(segmentPath.string().c_str(), "ab");
+	if (TEST_CHECK(file != nullptr)) {
+		fputs("H 2 1500000000001 1234abcd v=1&t=ev", file);
+		fclose(file);
+	}
+
+	utils::HitJournal journal;
+	TEST_CHECK(journal.open(directory.getPath()));
+
+	const vector<utils::HitJournal::Record> records = journal.readPendingRecords();
+	if (TEST_CHECK(records.size() == 1)) {
+		TEST_CHECK(records[0].payload == "v=1&t=event&ec=Complete");
+	}
+	journal.close();
+}
+
+void testAcknowledgedSegmentsAreDeleted() {
+	tests::TempDirectory directory("journal");
+	const string payload(200, 'x');
+
+	utils::HitJournal journal;
+	TEST_CHECK(journal.open(directory.getPath(), 1024));
+
+	vector<uint64_t> ids;
+	for (int i = 0; i < 50; ++i) {
+		ids.push_back(journal.append(1500000000000 + i, payload));
+	}
+	journal.sync();
+	TEST_CHECK(getNumFiles(directory.getPath()) > 1);
+
+	journal.acknowledge(ids);
+	journal.sync();
+	TEST_CHECK(journal.getNumPendingHits() == 0);
+	TEST_CHECK(getNumFiles(directory.getPath()) <= 1);
+	journal.close();
+
+	utils::HitJournal reopenedJournal;
+	TEST_CHECK(reopenedJournal.open(directory.getPath(), 1024));
+	TEST_CHECK(reopenedJournal.readPendingRecords().empty());
+	reopenedJournal.close();
+}
+
+void testHitsAreJournaledWhenTracked() {
+	tests::TempDirectory directory("journal");
+
+	{
+		JournaledClient client;
+		if (!TEST_CHECK(client.enableJournal(directory.getPath()))) {
+			return;
+		}
+
+		// no processing cycle runs, as if the app crashed right after tracking
+		client.trackEvent("Test Category", "Tap", "Journaled");
+		TEST_CHECK(client.getJournal()->getNumPendingHits() == 1);
+		client.getJournal()->sync();
+	}
+
+	utils::HitJournal journal;
+	TEST_CHECK(journal.open(directory.getPath()));
+
+	const vector<utils::HitJournal::Record> records = journal.readPendingRecords();
+	if (TEST_CHECK(records.size() == 1)) {
+		TEST_CHECK(records[0].payload.find("&el=Journaled") != string::npos);
+	}
+	journal.close();
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	utils::setMinLogLevel(utils::LOG_NONE);
+
+	tests::run("round trip", testRoundTrip);
+	tests::run("incomplete record is skipped", testIncompleteRecordIsSkipped);
+	tests::run("acknowledged segments are deleted", testAcknowledgedSegmentsAreDeleted);
+	tests::run("hits are journaled when tracked", testHitsAreJournaledWhenTracked);
+
+	return tests::getExitCode();
+}
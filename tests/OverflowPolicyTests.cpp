@@ -0,0 +1,202 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/AnalyticsClient.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+const int NUM_HITS = 20000;
+const size_t QUEUE_BUDGET = 2000;	// hits, i.e. 100 full batches
+const int NUM_HITS_PER_CHUNK = 1000;
+
+//! Drives batch assembly without setting up workers or sending anything, as if the network was down.
+class OfflineClient : public AnalyticsClient {
+public:
+	OfflineClient(const OverflowPolicy policy) {
+		setAppName("Test App");
+		setGaId("UA-00000000-1");
+		setClientId("01234567-89ab-cdef-0123-456789abcdef");
+		setMaxQueuedHits(QUEUE_BUDGET);
+		setOverflowPolicy(policy);
+	}
+
+	//! Tracks events with values 0 to numHits - 1 and assembles them into queued batches after each chunk.
+	void trackOffline(const int numHits) {
+		for (int i = 0; i < numHits; i += NUM_HITS_PER_CHUNK) {
+			for (int value = i; value < min(i + NUM_HITS_PER_CHUNK, numHits); ++value) {
+				trackEvent("Test Category", "Tap", "", value);
+			}
+
+			lock_guard<mutex> lock(mBatchMutex);
+			assembleBatches();
+			if (mCurrentBatch && !mCurrentBatch->isEmpty()) {
+				queueCurrentBatch();
+			}
+		}
+	}
+
+	//! Returns the event values of all queued hits in queue order and removes them, as if they had been delivered.
+	vector<int> deliverQueuedHits() {
+		lock_guard<mutex> lock(mBatchMutex);
+		vector<int> values;
+
+		for (const auto & batch : mBatchQueue) {
+			for (const auto & hit : batch->getEncodedHits()) {
+				const size_t offset = hit.parameters.find("&ev=");
+				values.push_back(offset != string::npos ? atoi(hit.parameters.c_str() + offset + 4) : -1);
+			}
+		}
+
+		clearBatchQueue();
+		reloadSpilledBatches();
+
+		return values;
+	}
+
+	//! Opens a spill queue without calling setup() (which would start sending).
+	bool enableSpilling(const fs::path & directory) {
+		mSpillQueue = make_shared<utils::SpillQueue>();
+		return mSpillQueue->open(directory);
+	}
+};
+
+bool isConsecutive(const vector<int> & values) {
+	for (size_t i = 1; i < values.size(); ++i) {
+		if (values[i] != values[i - 1] + 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void checkAccounting(const AnalyticsClient::Stats & stats) {
+	TEST_CHECK(stats.numHitsTracked == (uint64_t)NUM_HITS);
+	TEST_CHECK(stats.numQueuedHits <= QUEUE_BUDGET);
+	TEST_CHECK(stats.numQueuedHits + stats.numSpilledHits + stats.numHitsDropped == stats.numHitsTracked);
+}
+
+void testDropOldest() {
+	OfflineClient client(AnalyticsClient::DROP_OLDEST);
+	client.trackOffline(NUM_HITS);
+	checkAccounting(client.getStats());
+
+	const vector<int> values = client.deliverQueuedHits();
+	TEST_CHECK(values.size() == QUEUE_BUDGET);
+	TEST_CHECK(isConsecutive(values));
+	TEST_CHECK(!values.empty() && values.back() == NUM_HITS - 1);
+}
+
+void testDropNewest() {
+	OfflineClient client(AnalyticsClient::DROP_NEWEST);
+	client.trackOffline(NUM_HITS);
+	checkAccounting(client.getStats());
+
+	const vector<int> values = client.deliverQueuedHits();
+	TEST_CHECK(values.size() == QUEUE_BUDGET);
+	TEST_CHECK(isConsecutive(values));
+	TEST_CHECK(!values.empty() && values.front() == 0);
+}
+
+void testSample() {
+	OfflineClient client(AnalyticsClient::SAMPLE);
+	client.trackOffline(NUM_HITS);
+	checkAccounting(client.getStats());
+
+	vector<int> values = client.deliverQueuedHits();
+	TEST_CHECK(values.size() == QUEUE_BUDGET);
+	sort(values.begin(), values.end());
+	TEST_CHECK(adjacent_find(values.begin(), values.end()) == values.end());
+
+	// each quarter of the outage should hold about a quarter of the sample, not just the oldest or newest hits
+	const int numQuarters = 4;
+	vector<size_t> numValuesPerQuarter(numQuarters, 0);
+	for (const int value : values) {
+		numValuesPerQuarter[min(numQuarters - 1, value * numQuarters / NUM_HITS)]++;
+	}
+	for (const size_t numValues : numValuesPerQuarter) {
+		TEST_CHECK(numValues >= QUEUE_BUDGET / numQuarters / 2);
+	}
+}
+
+void testSpillToDisk() {
+	tests::TempDirectory directory("spill");
+	OfflineClient client(AnalyticsClient::SPILL_TO_DISK);
+
+	if (!TEST_CHECK(client.enableSpilling(directory.getPath()))) {
+		return;
+	}
+
+	client.trackOffline(NUM_HITS);
+	checkAccounting(client.getStats());
+	TEST_CHECK(client.getStats().numHitsDropped == 0);
+	TEST_CHECK(client.getStats().numSpilledHits == NUM_HITS - QUEUE_BUDGET);
+
+	// every hit comes back in the order it was tracked, one budget at a time
+	vector<int> values;
+	for (int i = 0; i < NUM_HITS; ++i) {
+		const vector<int> deliveredValues = client.deliverQueuedHits();
+		if (deliveredValues.empty()) {
+			break;
+		}
+		TEST_CHECK(deliveredValues.size() <= QUEUE_BUDGET);
+		values.insert(values.end(), deliveredValues.begin(), deliveredValues.end());
+	}
+
+	TEST_CHECK(values.size() == (size_t)NUM_HITS);
+	TEST_CHECK(isConsecutive(values));
+	TEST_CHECK(!values.empty() && values.front() == 0);
+	TEST_CHECK(client.getStats().numSpilledHits == 0);
+	TEST_CHECK(client.getStats().numHitsDropped == 0);
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	utils::setMinLogLevel(utils::LOG_NONE);
+
+	tests::run("DROP_OLDEST keeps the newest hits", testDropOldest);
+	tests::run("DROP_NEWEST keeps the oldest hits", testDropNewest);
+	tests::run("SAMPLE keeps hits from across the outage", testSample);
+	tests::run("SPILL_TO_DISK reads back every hit in order", testSpillToDisk);
+
+	return tests::getExitCode();
+}
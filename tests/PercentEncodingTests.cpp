@@ -0,0 +1,178 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/utils/PercentEncoding.hpp"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+//! Byte-at-a-time reference for utils::percentEncode that decodes code points to validate UTF-8
+//! instead of checking byte ranges, so it doesn't share any logic with the encoder.
+string referencePercentEncode(const string & value) {
+	static const char hexDigits[] = "0123456789ABCDEF";
+	const auto appendEscaped = [](string & result, const unsigned char c) {
+		result += '%';
+		result += hexDigits[c >> 4];
+		result += hexDigits[c & 0xF];
+	};
+
+	const unsigned char * data = (const unsigned char *)value.data();
+	const size_t length = value.size();
+	string result;
+
+	for (size_t i = 0; i < length;) {
+		const unsigned char c = data[i];
+
+		if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~') {
+			result += (char)c;
+			i += 1;
+			continue;
+		}
+
+		if (c < 0x80) {
+			appendEscaped(result, c);
+			i += 1;
+			continue;
+		}
+
+		size_t sequenceLength = 0;
+		uint32_t codePoint = 0;
+		if ((c & 0xE0) == 0xC0) { sequenceLength = 2; codePoint = c & 0x1F; }
+		else if ((c & 0xF0) == 0xE0) { sequenceLength = 3; codePoint = c & 0x0F; }
+		else if ((c & 0xF8) == 0xF0) { sequenceLength = 4; codePoint = c & 0x07; }
+
+		bool isValid = sequenceLength > 0 && i + sequenceLength <= length;
+		for (size_t j = 1; isValid && j < sequenceLength; ++j) {
+			isValid = (data[i + j] & 0xC0) == 0x80;
+			codePoint = (codePoint << 6) | (data[i + j] & 0x3F);
+		}
+
+		const uint32_t minCodePoint = sequenceLength == 2 ? 0x80 : sequenceLength == 3 ? 0x800 : 0x10000;
+		isValid = isValid && codePoint >= minCodePoint && codePoint <= 0x10FFFF && (codePoint < 0xD800 || codePoint > 0xDFFF);
+
+		if (isValid) {
+			for (size_t j = 0; j < sequenceLength; ++j) {
+				appendEscaped(result, data[i + j]);
+			}
+			i += sequenceLength;
+		} else {
+			result += "%EF%BF%BD";
+			i += 1;
+		}
+	}
+
+	return result;
+}
+
+bool checkEncoding(const string & value) {
+	const string expected = referencePercentEncode(value);
+	const string encoded = utils::percentEncode(value);
+
+	string appended = "prefix&";
+	utils::appendPercentEncoded(appended, value);
+
+	return TEST_CHECK(encoded == expected) &&
+		TEST_CHECK(utils::getPercentEncodedSize(value) == expected.size()) &&
+		TEST_CHECK(appended == "prefix&" + expected);
+}
+
+void testKnownValues() {
+	TEST_CHECK(utils::percentEncode("") == "");
+	TEST_CHECK(utils::percentEncode("Video-3_v2.1~") == "Video-3_v2.1~");
+	TEST_CHECK(utils::percentEncode("Room 2 & Co/Map?") == "Room%202%20%26%20Co%2FMap%3F");
+	TEST_CHECK(utils::percentEncode("Caf\xC3\xA9") == "Caf%C3%A9");
+	TEST_CHECK(utils::percentEncode("\xF0\x9F\x98\x80") == "%F0%9F%98%80");
+
+	// invalid bytes: Latin-1, overlong, surrogate, beyond U+10FFFF and truncated sequences
+	TEST_CHECK(utils::percentEncode("Caf\xE9") == "Caf%EF%BF%BD");
+	TEST_CHECK(utils::percentEncode("\xC0\xAF") == "%EF%BF%BD%EF%BF%BD");
+	TEST_CHECK(utils::percentEncode("\xED\xA0\x80") == "%EF%BF%BD%EF%BF%BD%EF%BF%BD");
+	TEST_CHECK(utils::percentEncode("\xF4\x90\x80\x80") == "%EF%BF%BD%EF%BF%BD%EF%BF%BD%EF%BF%BD");
+	TEST_CHECK(utils::percentEncode("\xE2\x82") == "%EF%BF%BD%EF%BF%BD");
+}
+
+void testAgainstReference() {
+	// realistic labels, shifted through all offsets within a 16 byte block
+	const vector<string> labels = {
+		"Gallery/Room 2 \xE2\x80\x93 Interactive Map",
+		"\xC3\x96lgem\xC3\xA4lde: Blick auf Hamburg (1890)",
+		"\xE5\xB1\x95\xE7\xA4\xBA 3 \xE2\x80\x93 \xE6\x9D\xB1\xE4\xBA\xAC",
+		"Bluecadet Interactive Timeline v2.4.1 (Windows 10)"
+	};
+
+	for (const string & label : labels) {
+		for (size_t offset = 0; offset < 16; ++offset) {
+			checkEncoding(string(offset, 'x') + label);
+			checkEncoding(label + string(offset, ' '));
+		}
+	}
+
+	// random mixes of unreserved, reserved, valid multi-byte and invalid bytes
+	const vector<string> pieces = {
+		"a", "Z", "7", "-", "~", " ", "&", "=", "/", "%", "\n", string(1, '\0'),
+		"\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xEF\xBF\xBD",
+		"\x80", "\xBF", "\xC0", "\xC1\xBF", "\xE0\x80\x80", "\xED\xBF\xBF", "\xF4\x90\x80\x80", "\xF8", "\xFF",
+		"\xE2\x82", "\xF0\x9F\x98"
+	};
+
+	mt19937 random(1234);
+	uniform_int_distribution<size_t> pieceIndex(0, pieces.size() - 1);
+	uniform_int_distribution<size_t> numPieces(0, 64);
+
+	for (int i = 0; i < 10000; ++i) {
+		string value;
+		for (size_t n = numPieces(random); n > 0; --n) {
+			value += pieces[pieceIndex(random)];
+		}
+		if (!checkEncoding(value)) {
+			break; // one failing input is enough to diagnose
+		}
+	}
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	tests::run("known values", testKnownValues);
+	tests::run("against reference", testAgainstReference);
+
+	return tests::getExitCode();
+}
@@ -0,0 +1,196 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/utils/Task.h"
+#include "bluecadet/analytics/utils/ThreadManager.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+atomic<int> sNumCopies(0);
+atomic<int> sNumRuns(0);
+
+//! Callable of exactly Size bytes that counts how often it's copied and run.
+template <size_t Size>
+struct CountingCallable {
+	CountingCallable() noexcept {}
+	CountingCallable(const CountingCallable &) noexcept { ++sNumCopies; }
+	CountingCallable(CountingCallable &&) noexcept {}
+
+	void operator()() { ++sNumRuns; }
+
+	char data[Size];
+};
+
+//! Callable that is small enough to be stored inline but whose move constructor may throw.
+struct ThrowingMoveCallable {
+	ThrowingMoveCallable() {}
+	ThrowingMoveCallable(ThrowingMoveCallable &&) noexcept(false) {}
+
+	void operator()() { ++sNumRuns; }
+};
+
+typedef CountingCallable<utils::Task::CAPACITY> InlineCallable;
+typedef CountingCallable<utils::Task::CAPACITY + 8> PooledCallable;
+typedef CountingCallable<utils::TaskPool::MAX_BLOCK_SIZE + 8> LargeCallable;
+
+//! Number of heap allocations made while running fn.
+template <class Fn>
+size_t countAllocations(Fn fn) {
+	const size_t numAllocations = benchmarks::getNumAllocations();
+	fn();
+	return benchmarks::getNumAllocations() - numAllocations;
+}
+
+//! Constructs a task from a new Callable, moves it through a few tasks like a queue would, runs and destroys it.
+template <class Callable>
+void moveAndRun() {
+	utils::Task task((Callable()));
+	utils::Task movedTask(std::move(task));
+	utils::Task assignedTask;
+	assignedTask = std::move(movedTask);
+	assignedTask();
+}
+
+void testInlineStorage() {
+	// a typical client task: this plus two shared_ptrs
+	shared_ptr<int> a = make_shared<int>(1);
+	shared_ptr<int> b = make_shared<int>(2);
+	int * self = nullptr;
+	int result = 0;
+	const auto lambda = [self, a, b, &result] { result = *a + *b + (self ? 1 : 0); };
+
+	TEST_CHECK(countAllocations([&] {
+		utils::Task task(lambda);
+		TEST_CHECK(task.isInline());
+		utils::Task movedTask(std::move(task));
+		TEST_CHECK(!task);
+		movedTask();
+	}) == 0);
+	TEST_CHECK(result == 3);
+	TEST_CHECK(a.use_count() == 2 && b.use_count() == 2); // only lambda's captures are left
+
+	// callables of exactly the inline capacity
+	sNumRuns = 0;
+	TEST_CHECK(utils::Task(InlineCallable()).isInline());
+	TEST_CHECK(countAllocations([] { moveAndRun<InlineCallable>(); }) == 0);
+	TEST_CHECK(sNumRuns == 1);
+}
+
+void testPooledStorage() {
+	TEST_CHECK(!utils::Task(PooledCallable()).isInline());
+	TEST_CHECK(!utils::Task(ThrowingMoveCallable()).isInline());
+
+	// the first pooled task may need a new block; released blocks are reused from then on
+	sNumRuns = 0;
+	TEST_CHECK(countAllocations([] { moveAndRun<PooledCallable>(); }) <= 1);
+	TEST_CHECK(countAllocations([] { moveAndRun<PooledCallable>(); }) == 0);
+	TEST_CHECK(countAllocations([] {
+		vector<utils::Task> tasks(16);
+		for (auto & task : tasks) {
+			task = PooledCallable();
+		}
+	}) <= 16 + 1);
+	TEST_CHECK(countAllocations([] { moveAndRun<PooledCallable>(); }) == 0);
+	TEST_CHECK(sNumRuns == 3);
+
+	// blocks beyond the largest size class come from the heap every time
+	TEST_CHECK(!utils::Task(LargeCallable()).isInline());
+	TEST_CHECK(countAllocations([] { moveAndRun<LargeCallable>(); }) == 1);
+	TEST_CHECK(sNumRuns == 4);
+}
+
+template <class Callable>
+void checkThreadManagerDoesntCopy() {
+	const int numTasks = 1000;
+
+	utils::ThreadManager manager;
+	manager.setup(2);
+
+	sNumCopies = 0;
+	sNumRuns = 0;
+
+	for (int i = 0; i < numTasks / 2; ++i) {
+		manager.addTask(Callable());
+	}
+
+	vector<utils::TaskFn> tasks;
+	for (int i = 0; i < numTasks / 2; ++i) {
+		tasks.emplace_back(Callable());
+	}
+	manager.addTasks(tasks);
+
+	manager.addDelayedTask(Callable(), 0.01);
+
+	const auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+	while (sNumRuns < numTasks + 1 && chrono::steady_clock::now() < deadline) {
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+
+	manager.destroy();
+
+	TEST_CHECK(sNumRuns == numTasks + 1);
+	TEST_CHECK(sNumCopies == 0);
+}
+
+void testNoCopies() {
+	// moving a task around never copies its callable
+	sNumCopies = 0;
+	moveAndRun<InlineCallable>();
+	moveAndRun<PooledCallable>();
+	TEST_CHECK(sNumCopies == 0);
+
+	// neither does queueing, dequeueing, stealing or running it on a worker
+	checkThreadManagerDoesntCopy<InlineCallable>();
+	checkThreadManagerDoesntCopy<PooledCallable>();
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	tests::run("inline storage", testInlineStorage);
+	tests::run("pooled storage", testPooledStorage);
+	tests::run("no copies", testNoCopies);
+
+	return tests::getExitCode();
+}
@@ -0,0 +1,105 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+#include "bluecadet/analytics/utils/Log.h"
+#include "bluecadet/analytics/utils/Platform.h"
+
+namespace bluecadet {
+namespace analytics {
+namespace tests {
+
+/*!
+ Minimal test harness for the ctest executables in this directory. Each executable runs its tests
+ from main(), records failed checks and returns getExitCode(), so ctest reports any failure.
+ */
+
+inline int & getNumFailures() {
+	static int numFailures = 0;
+	return numFailures;
+}
+
+inline bool check(const bool condition, const char * expression, const char * file, const int line) {
+	if (!condition) {
+		fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		++getNumFailures();
+	}
+	return condition;
+}
+
+//! Runs test and reports its name if any of its checks failed.
+template <class TestFn>
+void run(const char * name, TestFn test) {
+	const int numFailuresBefore = getNumFailures();
+	test();
+	fprintf(stderr, "%s %s\n", getNumFailures() == numFailuresBefore ? "[passed]" : "[FAILED]", name);
+}
+
+inline int getExitCode() {
+	if (getNumFailures() > 0) {
+		fprintf(stderr, "%d check(s) failed\n", getNumFailures());
+		return 1;
+	}
+	return 0;
+}
+
+//! Creates an empty directory under the system's temp directory that is removed again on destruction.
+class TempDirectory {
+public:
+	TempDirectory(const std::string & name) :
+		mPath(fs::temp_directory_path() / fs::unique_path("bluecadet-analytics-" + name + "-%%%%-%%%%"))
+	{
+		fs::create_directories(mPath);
+	}
+
+	~TempDirectory() {
+		try {
+			fs::remove_all(mPath);
+		} catch (const std::exception &) {}
+	}
+
+	const fs::path & getPath() const { return mPath; }
+
+protected:
+	fs::path mPath;
+};
+
+} // tests namespace
+} // analytics namespace
+} // bluecadet namespace
+
+#define TEST_CHECK(condition) bluecadet::analytics::tests::check((condition), #condition, __FILE__, __LINE__)
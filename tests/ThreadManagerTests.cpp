@@ -0,0 +1,280 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2016, Bluecadet
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ 
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+
+#include "bluecadet/analytics/utils/ThreadManager.h"
+
+using namespace std;
+using namespace bluecadet::analytics;
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+//! Polls condition until it's true or timeout seconds have passed. Returns the last result.
+template <class Condition>
+bool waitUntil(Condition condition, const double timeout = 10.0) {
+	const auto deadline = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double>(timeout));
+	while (!condition()) {
+		if (Clock::now() >= deadline) {
+			return false;
+		}
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	return true;
+}
+
+//! Exposes whether destroy() has started stopping the workers.
+class TestThreadManager : public utils::ThreadManager {
+public:
+	bool isStopping() const { return mIsCanceled; }
+};
+
+double getSecondsBetween(const Clock::time_point & start, const Clock::time_point & end) {
+	return chrono::duration<double>(end - start).count();
+}
+
+void testStolenTasksRunOnce() {
+	const int numTasks = 200;
+	utils::ThreadManager manager;
+	manager.setup(4);
+
+	vector<atomic<int>> numRuns(numTasks);
+	for (auto & n : numRuns) {
+		n = 0;
+	}
+	atomic<int> numTasksDone(0);
+	mutex threadIdMutex;
+	set<thread::id> threadIds;
+
+	// tasks added from a worker go to its own queue, so the other workers only get to them by stealing
+	manager.addTask([&] {
+		for (int i = 0; i < numTasks; ++i) {
+			manager.addTask([&, i] {
+				numRuns[i]++;
+				{
+					lock_guard<mutex> lock(threadIdMutex);
+					threadIds.insert(this_thread::get_id());
+				}
+				this_thread::sleep_for(chrono::microseconds(200));
+				numTasksDone++;
+			});
+		}
+	});
+
+	TEST_CHECK(waitUntil([&] { return numTasksDone == numTasks; }));
+	manager.destroy();
+
+	for (int i = 0; i < numTasks; ++i) {
+		TEST_CHECK(numRuns[i] == 1);
+	}
+	TEST_CHECK(threadIds.size() > 1);
+	TEST_CHECK(manager.getLaneStats().front().numTasksRun == (size_t)numTasks + 1);
+}
+
+void testDelayedTasksRunOnTime() {
+	const vector<double> delays = {0.05, 0.1, 0.2, 0.3};
+	const double tolerance = 0.1;
+	utils::ThreadManager manager;
+	manager.setup(2);
+
+	vector<Clock::time_point> runTimes(delays.size());
+	atomic<int> numTasksDone(0);
+	atomic<bool> isCanceledTaskRun(false);
+
+	const Clock::time_point startTime = Clock::now();
+
+	// added out of order; each runs once after its own delay
+	for (size_t i = delays.size(); i-- > 0;) {
+		manager.addDelayedTask([&, i] {
+			runTimes[i] = Clock::now();
+			numTasksDone++;
+		}, delays[i]);
+	}
+
+	const utils::ThreadManager::TaskId canceledTaskId = manager.addDelayedTask([&] {
+		isCanceledTaskRun = true;
+	}, 0.1);
+	TEST_CHECK(manager.cancelTask(canceledTaskId));
+
+	TEST_CHECK(waitUntil([&] { return numTasksDone == (int)delays.size(); }));
+	this_thread::sleep_for(chrono::milliseconds(100));
+	manager.destroy();
+
+	for (size_t i = 0; i < delays.size(); ++i) {
+		const double actualDelay = getSecondsBetween(startTime, runTimes[i]);
+		TEST_CHECK(actualDelay >= delays[i]);
+		TEST_CHECK(actualDelay < delays[i] + tolerance);
+	}
+	TEST_CHECK(numTasksDone == (int)delays.size());
+	TEST_CHECK(!isCanceledTaskRun);
+}
+
+void testLaneWeightsHoldUnderContention() {
+	const int numTasksPerLane = 800;
+	const int heavyWeight = 4;
+	utils::ThreadManager manager;
+	const utils::ThreadManager::LaneId heavyLane = manager.addLane("heavy", heavyWeight);
+	const utils::ThreadManager::LaneId lightLane = manager.addLane("light", 1);
+
+	// both lanes are backlogged before any worker starts; setup() spreads the backlog across workers, and
+	// tasks take long enough that both workers keep taking turns even on a single core
+	vector<utils::ThreadManager::LaneId> order(2 * numTasksPerLane);
+	atomic<size_t> numTasksDone(0);
+
+	for (const auto lane : {heavyLane, lightLane}) {
+		for (int i = 0; i < numTasksPerLane; ++i) {
+			manager.addTask([&, lane] {
+				order[numTasksDone++] = lane;
+				this_thread::sleep_for(chrono::microseconds(100));
+			}, lane);
+		}
+	}
+
+	manager.setup(2);
+	TEST_CHECK(waitUntil([&] { return numTasksDone == order.size(); }));
+	manager.destroy();
+
+	// while both lanes have tasks, the heavy lane gets about 4 turns for every turn of the light lane
+	const size_t numTasksWhileBacklogged = numTasksPerLane;
+	size_t numHeavyTasks = 0;
+	for (size_t i = 0; i < numTasksWhileBacklogged; ++i) {
+		numHeavyTasks += order[i] == heavyLane ? 1 : 0;
+	}
+
+	const double heavyShare = (double)numHeavyTasks / (double)numTasksWhileBacklogged;
+	const double expectedShare = (double)heavyWeight / (double)(heavyWeight + 1);
+	TEST_CHECK(heavyShare > expectedShare - 0.1 && heavyShare < expectedShare + 0.1);
+
+	const vector<utils::ThreadManager::LaneStats> stats = manager.getLaneStats();
+	TEST_CHECK(stats[heavyLane].numTasksRun == (size_t)numTasksPerLane);
+	TEST_CHECK(stats[lightLane].numTasksRun == (size_t)numTasksPerLane);
+	TEST_CHECK(stats[heavyLane].queueDepth == 0 && stats[lightLane].queueDepth == 0);
+}
+
+void testBulkTasksRunOnce() {
+	const int numTasks = 1000;
+	utils::ThreadManager manager;
+	manager.setup(3);
+
+	vector<atomic<int>> numRuns(numTasks);
+	for (auto & n : numRuns) {
+		n = 0;
+	}
+	atomic<int> numTasksDone(0);
+
+	// split into one chunk per worker and taken in batches of up to getDequeueBatchSize()
+	vector<utils::TaskFn> tasks;
+	for (int i = 0; i < numTasks; ++i) {
+		tasks.emplace_back([&, i] {
+			numRuns[i]++;
+			numTasksDone++;
+		});
+	}
+	manager.addTasks(tasks);
+	TEST_CHECK(tasks.empty());
+
+	TEST_CHECK(waitUntil([&] { return numTasksDone == numTasks; }));
+	manager.destroy();
+
+	for (int i = 0; i < numTasks; ++i) {
+		TEST_CHECK(numRuns[i] == 1);
+	}
+}
+
+void testShutdownKeepsQueuedTasks() {
+	const int numTasks = 10;
+	TestThreadManager manager;
+	atomic<bool> isGateEntered(false);
+	atomic<bool> isGateOpen(false);
+	atomic<int> numTasksRun(0);
+
+	// queued before setup() so that the worker takes the gate and the first tasks after it in one batch
+	manager.addTask([&] {
+		isGateEntered = true;
+		while (!isGateOpen) {
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+	});
+	for (int i = 0; i < numTasks; ++i) {
+		manager.addTask([&] {
+			numTasksRun++;
+		});
+	}
+
+	manager.setup(1);
+	TEST_CHECK(waitUntil([&] { return isGateEntered.load(); }));
+
+	// destroy() lets the running task finish, then stops before the rest of its batch
+	thread stoppingThread([&] {
+		manager.destroy();
+	});
+	TEST_CHECK(waitUntil([&] { return manager.isStopping(); }));
+	isGateOpen = true;
+	stoppingThread.join();
+
+	TEST_CHECK(numTasksRun == 0);
+	TEST_CHECK(manager.getNumThreads() == 0);
+	TEST_CHECK(manager.getLaneStats().front().queueDepth == (size_t)numTasks);
+
+	// nothing is dropped; queued tasks run once the workers are started again
+	manager.setup(1);
+	TEST_CHECK(waitUntil([&] { return numTasksRun == numTasks; }));
+	this_thread::sleep_for(chrono::milliseconds(50));
+	manager.destroy();
+
+	TEST_CHECK(numTasksRun == numTasks);
+	TEST_CHECK(manager.getLaneStats().front().queueDepth == 0);
+}
+
+} // anonymous namespace
+
+int main(int, char **) {
+	utils::setMinLogLevel(utils::LOG_NONE);
+
+	tests::run("stolen tasks run exactly once", testStolenTasksRunOnce);
+	tests::run("delayed tasks run on time", testDelayedTasksRunOnTime);
+	tests::run("lane weights hold under contention", testLaneWeightsHoldUnderContention);
+	tests::run("bulk-added tasks run exactly once", testBulkTasksRunOnce);
+	tests::run("shutdown keeps queued tasks for the next setup()", testShutdownKeepsQueuedTasks);
+
+	return tests::getExitCode();
+}